@@ -1,6 +1,36 @@
 #!/bin/bash
 mkdir -p build
 
-files="./src/main.c ./src/input.c ./src/cTooling.c"
+files="./src/main.c ./src/input.c ./src/find.c ./src/highlight.c ./src/autocomplete.c ./src/textarea.c ./src/wrap.c ./src/list.c ./src/fuzzy.c ./src/finder.c ./src/logview.c ./src/console.c ./src/input_source.c ./src/font.c ./src/render.c ./src/latency.c ./src/cTooling.c"
+flags=""
 
-gcc -Wall -Wextra -Werror -W -o ./build/main $files -I./raylib-5.5/include -L./raylib-5.5/lib/ -l:libraylib.a -lm -lcurl
+# BAKED_FONT=path/to/font.ttf ./build.sh embeds a pre-rasterized atlas of the font
+# into the executable. BAKED_FONT_SIZE and BAKED_FONT_RANGES (e.g. "32-126 0x4E00-0x9FFF")
+# select the size and codepoints
+if [ -n "$BAKED_FONT" ]; then
+    gcc -Wall -Wextra -Werror -W -o ./build/bake_font ./tools/bake_font.c ./src/cTooling.c -I./src -I./raylib-5.5/include -L./raylib-5.5/lib/ -l:libraylib.a -lm || exit 1
+    ./build/bake_font "$BAKED_FONT" "${BAKED_FONT_SIZE:-32}" ./build/baked_font.c $BAKED_FONT_RANGES || exit 1
+
+    files="$files ./build/baked_font.c"
+    flags="-DBAKED_FONT -I./src"
+fi
+
+gcc -Wall -Wextra -Werror -W $flags -o ./build/main $files -I./raylib-5.5/include -L./raylib-5.5/lib/ -l:libraylib.a -lm -lcurl -lpthread
+
+# the headless tools share the widgets and the raylib stub
+widget_files="./tools/raylib_stub.c ./src/input.c ./src/find.c ./src/highlight.c ./src/autocomplete.c ./src/textarea.c ./src/wrap.c ./src/list.c ./src/fuzzy.c ./src/finder.c ./src/logview.c ./src/console.c ./src/input_source.c ./src/font.c ./src/render.c ./src/latency.c ./src/cTooling.c"
+
+if [ "$1" == "bench" ]; then
+    bench_files="./tools/bench.c ./src/autocomplete.c ./src/fuzzy.c ./src/find.c ./src/highlight.c ./src/input.c ./src/input_source.c ./src/latency.c ./src/font.c ./src/render.c ./src/cTooling.c"
+
+    gcc -Wall -Wextra -Werror -W -O2 -o ./build/bench $bench_files -I./src -I./raylib-5.5/include -L./raylib-5.5/lib/ -l:libraylib.a -lm -lpthread
+
+    gcc -Wall -Wextra -Werror -W -O2 -o ./build/latency_bench ./tools/latency_bench.c $widget_files -I./src -I./raylib-5.5/include -lm -lpthread -Wl,--wrap=string_insert_chr,--wrap=string_insert_text
+    gcc -Wall -Wextra -Werror -W -O2 -g -o ./build/replay ./tools/replay.c $widget_files -I./src -I./raylib-5.5/include -lm -lpthread
+fi
+
+if [ "$1" == "test" ]; then
+    gcc -Wall -Wextra -Werror -W -g -fsanitize=address,undefined -o ./build/widget_test ./tools/widget_test.c $widget_files -I./src -I./raylib-5.5/include -lm -lpthread || exit 1
+    # the widgets have no destructors, they live until exit
+    ASAN_OPTIONS=detect_leaks=0 ./build/widget_test
+fi
@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "autocomplete.h"
+
+// qsort has no user pointer, the build is not reentrant
+static const char **sorted_entries;
+
+static int compare_entries(const void *a, const void *b)
+{
+    return strcmp(sorted_entries[*(const uint32_t *)a], sorted_entries[*(const uint32_t *)b]);
+}
+
+// the searches trust the offsets and the entries of "best", a corrupt or truncated
+// file would make them read out of the block
+static bool are_tables_valid(AutocompleteIndex *index, size_t data_size)
+{
+    for(size_t i = 0; i < index->count; i++) {
+        if(index->offsets[i] > index->offsets[i + 1]) return false;
+    }
+    if(index->offsets[index->count] > data_size) return false;
+
+    for(size_t i = 0; i < 2*index->count; i++) {
+        if(index->best[i] >= index->count && index->best[i] != AUTOCOMPLETE_NONE) return false;
+    }
+
+    return true;
+}
+
+// sets the pointers of the index to the sections of its block, false when the block
+// doesn't match its header. The tables of a mapped block are checked too
+static bool set_sections(AutocompleteIndex *index)
+{
+    if(index->block_size < sizeof(AutocompleteHeader)) return false;
+
+    AutocompleteHeader *header = (AutocompleteHeader *)index->block;
+    if(memcmp(header->magic, AUTOCOMPLETE_MAGIC, 4) != 0) return false;
+    if(header->version != AUTOCOMPLETE_VERSION) return false;
+
+    // the sizes are checked one at a time so a huge count or data size can't overflow
+    size_t size = index->block_size - sizeof(AutocompleteHeader);
+    if(header->count >= AUTOCOMPLETE_NONE || header->data_size > size) return false;
+    size_t count = header->count;
+    size_t tables_size = (count + 1 + count + 2*count)*sizeof(uint32_t);
+    if(size != tables_size + header->data_size) return false;
+
+    const uint32_t *tables = (const uint32_t *)(index->block + sizeof(AutocompleteHeader));
+    index->count = count;
+    index->offsets = tables;
+    index->weights = index->offsets + count + 1;
+    index->best = index->weights + count;
+    index->data = (const char *)(index->best + 2*count);
+
+    return !index->mapped || are_tables_valid(index, header->data_size);
+}
+
+// entry of biggest weight, the first one on ties so equal weights keep the order
+static uint32_t get_better(AutocompleteIndex *index, uint32_t a, uint32_t b)
+{
+    if(a == AUTOCOMPLETE_NONE) return b;
+    if(b == AUTOCOMPLETE_NONE) return a;
+    if(index->weights[a] == index->weights[b]) return a < b ? a : b;
+    return index->weights[a] > index->weights[b] ? a : b;
+}
+
+AutocompleteIndex *autocomplete_index_build(
+    const char **entries, const uint32_t *weights, size_t count
+)
+{
+    uint32_t *order = malloc(count*sizeof(uint32_t));
+    assert((order != NULL || count == 0) && "No enough ram");
+    for(size_t i = 0; i < count; i++) order[i] = i;
+
+    sorted_entries = entries;
+    qsort(order, count, sizeof(uint32_t), compare_entries);
+
+    // merges the duplicates, the first one of every run keeps the biggest weight
+    size_t unique = 0;
+    size_t data_size = 0;
+    for(size_t i = 0; i < count; i++) {
+        uint32_t entry = order[i];
+        if(unique > 0 && strcmp(entries[order[unique - 1]], entries[entry]) == 0) {
+            uint32_t *kept = &order[unique - 1];
+            if(weights != NULL && weights[entry] > weights[*kept]) *kept = entry;
+            continue;
+        }
+
+        order[unique++] = entry;
+        data_size += strlen(entries[entry]);
+    }
+    assert(data_size <= UINT32_MAX && "Too many suggestions");
+
+    AutocompleteIndex *index = malloc(sizeof(AutocompleteIndex));
+    assert(index != NULL && "No enough ram");
+    bzero(index, sizeof(AutocompleteIndex));
+
+    size_t tables_size = (unique + 1 + unique + 2*unique)*sizeof(uint32_t);
+    index->block_size = sizeof(AutocompleteHeader) + tables_size + data_size;
+    index->block = malloc(index->block_size);
+    assert(index->block != NULL && "No enough ram");
+
+    AutocompleteHeader *header = (AutocompleteHeader *)index->block;
+    bzero(header, sizeof(AutocompleteHeader));
+    memcpy(header->magic, AUTOCOMPLETE_MAGIC, 4);
+    header->version = AUTOCOMPLETE_VERSION;
+    header->count = unique;
+    header->data_size = data_size;
+    set_sections(index);
+
+    // the sections are const for the users of the index
+    uint32_t *offsets = (uint32_t *)index->offsets;
+    uint32_t *entry_weights = (uint32_t *)index->weights;
+    uint32_t *best = (uint32_t *)index->best;
+    char *data = (char *)index->data;
+
+    size_t offset = 0;
+    for(size_t i = 0; i < unique; i++) {
+        const char *entry = entries[order[i]];
+        size_t size = strlen(entry);
+        memcpy(data + offset, entry, size);
+        offsets[i] = offset;
+        entry_weights[i] = weights == NULL ? 0 : weights[order[i]];
+        offset += size;
+    }
+    offsets[unique] = offset;
+
+    // the leaves are the entries, every parent keeps the better of its children
+    for(size_t i = 0; i < unique; i++) best[unique + i] = i;
+    for(size_t i = unique; i-- > 1;) {
+        best[i] = get_better(index, best[2*i], best[2*i + 1]);
+    }
+    if(unique > 0) best[0] = AUTOCOMPLETE_NONE;
+
+    free(order);
+    return index;
+}
+
+bool autocomplete_index_write(AutocompleteIndex *index, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if(file == NULL) return false;
+
+    size_t written = fwrite(index->block, 1, index->block_size, file);
+    fclose(file);
+
+    return written == index->block_size;
+}
+
+AutocompleteIndex *autocomplete_index_map(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // the pages of the entries are only read when the searches touch them
+    void *block = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(block == MAP_FAILED) return NULL;
+
+    AutocompleteIndex *index = malloc(sizeof(AutocompleteIndex));
+    assert(index != NULL && "No enough ram");
+    bzero(index, sizeof(AutocompleteIndex));
+    index->block = block;
+    index->block_size = st.st_size;
+    index->mapped = true;
+
+    if(!set_sections(index)) {
+        autocomplete_index_free(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+void autocomplete_index_free(AutocompleteIndex *index)
+{
+    if(index->mapped) {
+        munmap(index->block, index->block_size);
+    } else {
+        free(index->block);
+    }
+
+    free(index);
+}
+
+const char *autocomplete_index_entry(AutocompleteIndex *index, uint32_t entry, size_t *size)
+{
+    *size = index->offsets[entry + 1] - index->offsets[entry];
+    return index->data + index->offsets[entry];
+}
+
+void autocomplete_init(Autocomplete *ac, AutocompleteIndex *index)
+{
+    bzero(ac, sizeof(Autocomplete));
+    ac->index = index;
+    ac->highlighted = SIZE_MAX;
+
+    // the empty prefix matches everything
+    da_append(&ac->ranges, ((AutocompleteRange) {0, index->count}));
+}
+
+void autocomplete_free(Autocomplete *ac)
+{
+    string_free(&ac->prefix);
+    da_free(&ac->ranges);
+}
+
+// byte of the entry at "depth", -1 when the entry is shorter, so that the entries
+// that are the prefix itself come first
+static int get_entry_byte(AutocompleteIndex *index, size_t entry, size_t depth)
+{
+    size_t start = index->offsets[entry];
+    if(start + depth >= index->offsets[entry + 1]) return -1;
+    return (unsigned char)index->data[start + depth];
+}
+
+// first entry of the range whose byte at "depth" is bigger than "byte", or equal
+// to it when "inclusive"
+static size_t search_byte(
+    AutocompleteIndex *index, AutocompleteRange range, size_t depth, int byte, bool inclusive
+)
+{
+    size_t lo = range.lo, hi = range.hi;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int mid_byte = get_entry_byte(index, mid, depth);
+        if(mid_byte < byte || (!inclusive && mid_byte == byte)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+// all the entries of "range" share the first "depth" bytes, so only the next one
+// has to be compared
+static AutocompleteRange narrow_range(
+    AutocompleteIndex *index, AutocompleteRange range, size_t depth, char c
+)
+{
+    int byte = (unsigned char)c;
+    range.lo = search_byte(index, range, depth, byte, true);
+    range.hi = search_byte(index, range, depth, byte, false);
+    return range;
+}
+
+// best entry in [lo, hi) with the segment tree, O(log n)
+static uint32_t find_best(AutocompleteIndex *index, size_t lo, size_t hi)
+{
+    uint32_t best = AUTOCOMPLETE_NONE;
+    for(size_t l = lo + index->count, r = hi + index->count; l < r; l /= 2, r /= 2) {
+        if(l & 1) best = get_better(index, best, index->best[l++]);
+        if(r & 1) best = get_better(index, best, index->best[--r]);
+    }
+
+    return best;
+}
+
+typedef struct {
+    size_t lo;
+    size_t hi;
+    uint32_t best;
+} Candidate;
+
+// the best entry of the range is taken and the range is split around it, the next
+// one is the best of the pieces. K results take 2K queries no matter the range size
+static void find_top_results(Autocomplete *ac, AutocompleteRange range)
+{
+    AutocompleteIndex *index = ac->index;
+    Candidate candidates[2*AUTOCOMPLETE_MAX_RESULTS + 1];
+    size_t candidate_count = 0;
+    ac->result_count = 0;
+
+    if(range.lo < range.hi) {
+        uint32_t best = find_best(index, range.lo, range.hi);
+        candidates[candidate_count++] = (Candidate) {range.lo, range.hi, best};
+    }
+
+    while(ac->result_count < AUTOCOMPLETE_MAX_RESULTS && candidate_count > 0) {
+        size_t picked = 0;
+        for(size_t i = 1; i < candidate_count; i++) {
+            uint32_t best = get_better(index, candidates[picked].best, candidates[i].best);
+            if(best != candidates[picked].best) picked = i;
+        }
+
+        Candidate candidate = candidates[picked];
+        candidates[picked] = candidates[--candidate_count];
+        ac->results[ac->result_count++] = candidate.best;
+
+        if(candidate.lo < candidate.best) {
+            candidates[candidate_count++] = (Candidate) {
+                candidate.lo, candidate.best, find_best(index, candidate.lo, candidate.best)
+            };
+        }
+        if(candidate.best + 1 < candidate.hi) {
+            candidates[candidate_count++] = (Candidate) {
+                candidate.best + 1, candidate.hi, find_best(index, candidate.best + 1, candidate.hi)
+            };
+        }
+    }
+}
+
+void autocomplete_update(Autocomplete *ac, const char *text, size_t size)
+{
+    // the ranges of the prefix shared with the last text are still valid
+    size_t common = 0;
+    while(common < size && common < ac->prefix.count && text[common] == ac->prefix.items[common]) {
+        common++;
+    }
+
+    ac->prefix.count = common;
+    ac->ranges.count = common + 1;
+
+    for(size_t i = common; i < size; i++) {
+        AutocompleteRange range = ac->ranges.items[i];
+        if(range.lo < range.hi) range = narrow_range(ac->index, range, i, text[i]);
+
+        da_append(&ac->ranges, range);
+        da_append(&ac->prefix, text[i]);
+    }
+
+    find_top_results(ac, ac->ranges.items[size]);
+    ac->highlighted = SIZE_MAX;
+    ac->dismissed = false;
+}
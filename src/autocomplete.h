@@ -0,0 +1,78 @@
+#ifndef AUTOCOMPLETE_H
+#define AUTOCOMPLETE_H
+
+#include "cTooling.h"
+
+#define AUTOCOMPLETE_MAGIC "CUIA"
+#define AUTOCOMPLETE_VERSION 1
+#define AUTOCOMPLETE_MAX_RESULTS 8
+#define AUTOCOMPLETE_NONE UINT32_MAX
+
+// Suggestions sorted by their bytes, the ones with a common prefix are a range
+// of the array. The index is a single block with offsets instead of pointers so
+// it can be written to a file and mapped back as it is:
+//   header, u32 offsets[count + 1], u32 weights[count],
+//   u32 best[2*count], entry bytes
+// "best" is a segment tree with the entry of biggest weight of every node, the
+// leaves are at best[count + i]
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+    uint64_t data_size;
+} AutocompleteHeader;
+
+typedef struct {
+    char *block;
+    size_t block_size;
+    bool mapped;
+    size_t count;
+    const uint32_t *offsets; // entry i is data[offsets[i]..offsets[i + 1])
+    const uint32_t *weights;
+    const uint32_t *best;
+    const char *data;
+} AutocompleteIndex;
+
+// entries starting with the first "i" bytes of the prefix
+typedef struct {
+    size_t lo;
+    size_t hi;
+} AutocompleteRange;
+
+typedef struct {
+    AutocompleteRange *items;
+    size_t count;
+    size_t capacity;
+} AutocompleteRanges;
+
+// Completions of a prefix that is typed a byte at a time. The range of every length
+// of the prefix is kept, so typing narrows the last range with a binary search on
+// a single byte and deleting only drops ranges
+typedef struct {
+    AutocompleteIndex *index;
+    String prefix;
+    AutocompleteRanges ranges; // ranges.items[i] is the range of prefix[0..i)
+    uint32_t results[AUTOCOMPLETE_MAX_RESULTS]; // biggest weights first
+    size_t result_count;
+    size_t highlighted; // result picked with the arrows, SIZE_MAX when none
+    bool dismissed;     // hidden with escape until the text changes
+} Autocomplete;
+
+// builds the index in a single block, equal entries are merged keeping the biggest
+// weight. "weights" can be NULL, then the completions are in alphabetic order
+AutocompleteIndex *autocomplete_index_build(
+    const char **entries, const uint32_t *weights, size_t count
+);
+bool autocomplete_index_write(AutocompleteIndex *index, const char *path);
+// maps an index written by autocomplete_index_write, NULL if it's not valid
+AutocompleteIndex *autocomplete_index_map(const char *path);
+void autocomplete_index_free(AutocompleteIndex *index);
+const char *autocomplete_index_entry(AutocompleteIndex *index, uint32_t entry, size_t *size);
+
+void autocomplete_init(Autocomplete *ac, AutocompleteIndex *index);
+// finds the completions of "text", reusing the ranges of the prefix it shares
+// with the last one
+void autocomplete_update(Autocomplete *ac, const char *text, size_t size);
+void autocomplete_free(Autocomplete *ac);
+
+#endif // AUTOCOMPLETE_H
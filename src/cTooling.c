@@ -88,6 +88,63 @@ void string_free(String *str)
     da_free(str);
 }
 
+int utf8_decode(const char *text, size_t size, int *codepoint_size)
+{
+    const unsigned char *bytes = (const unsigned char *)text;
+    int codepoint;
+    int len;
+
+    *codepoint_size = 1;
+
+    if(bytes[0] < 0x80) return bytes[0];
+
+    if((bytes[0] & 0xE0) == 0xC0) {
+        codepoint = bytes[0] & 0x1F;
+        len = 2;
+    } else if((bytes[0] & 0xF0) == 0xE0) {
+        codepoint = bytes[0] & 0x0F;
+        len = 3;
+    } else if((bytes[0] & 0xF8) == 0xF0) {
+        codepoint = bytes[0] & 0x07;
+        len = 4;
+    } else {
+        return '?';
+    }
+
+    if((size_t)len > size) return '?';
+
+    for(int i = 1; i < len; i++) {
+        if(!utf8_is_continuation(bytes[i])) return '?';
+        codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+    }
+
+    *codepoint_size = len;
+    return codepoint;
+}
+
+int utf8_encode(int codepoint, char dest[4])
+{
+    if(codepoint < 0x80) {
+        dest[0] = codepoint;
+        return 1;
+    } else if(codepoint < 0x800) {
+        dest[0] = 0xC0 | (codepoint >> 6);
+        dest[1] = 0x80 | (codepoint & 0x3F);
+        return 2;
+    } else if(codepoint < 0x10000) {
+        dest[0] = 0xE0 | (codepoint >> 12);
+        dest[1] = 0x80 | ((codepoint >> 6) & 0x3F);
+        dest[2] = 0x80 | (codepoint & 0x3F);
+        return 3;
+    }
+
+    dest[0] = 0xF0 | (codepoint >> 18);
+    dest[1] = 0x80 | ((codepoint >> 12) & 0x3F);
+    dest[2] = 0x80 | ((codepoint >> 6) & 0x3F);
+    dest[3] = 0x80 | (codepoint & 0x3F);
+    return 4;
+}
+
 LList *llist_create()
 {
     LList *list = malloc(sizeof(LList));
@@ -108,6 +165,39 @@ void llist_append_node(LList *list, LNode *node)
     list->count++;
 }
 
+void llist_insert_after(LList *list, LNode *prev, LNode *node)
+{
+    if(prev == NULL) {
+        node->next = list->head;
+        list->head = node;
+    } else {
+        node->next = prev->next;
+        prev->next = node;
+    }
+
+    if(node->next == NULL) list->tail = node;
+
+    list->count++;
+}
+
+LNode *llist_remove_after(LList *list, LNode *prev)
+{
+    LNode *node = prev == NULL ? list->head : prev->next;
+    if(node == NULL) return NULL;
+
+    if(prev == NULL) {
+        list->head = node->next;
+    } else {
+        prev->next = node->next;
+    }
+
+    if(list->tail == node) list->tail = prev;
+
+    node->next = NULL;
+    list->count--;
+    return node;
+}
+
 void llist_destroy(LList *list)
 {
     LNode *node = list->head;
@@ -129,3 +219,283 @@ LNode *llist_create_node(int type, void *data)
     node->next = NULL;
     return node;
 }
+
+void llist_destroy_pooled(LList *list, LNodePool *pool)
+{
+    LNode *node = list->head;
+
+    while(node != NULL) {
+        LNode *_node = node;
+        node = node->next;
+        lnode_pool_release(pool, _node);
+    }
+
+    free(list);
+}
+
+LNode *lnode_pool_alloc(LNodePool *pool, int type, void *data)
+{
+    if(pool->free_list == NULL) {
+        LNode *slab = malloc(LNODE_POOL_SLAB_SIZE*sizeof(LNode));
+        assert(slab != NULL && "No enough ram");
+        da_append(pool, slab);
+
+        // chains the slab in reverse so nodes are handed out in memory order
+        for(size_t i = LNODE_POOL_SLAB_SIZE; i > 0; i--) {
+            slab[i - 1].next = pool->free_list;
+            pool->free_list = &slab[i - 1];
+        }
+    }
+
+    LNode *node = pool->free_list;
+    pool->free_list = node->next;
+
+    node->type = type;
+    node->data = data;
+    node->next = NULL;
+    return node;
+}
+
+void lnode_pool_release(LNodePool *pool, LNode *node)
+{
+    node->next = pool->free_list;
+    pool->free_list = node;
+}
+
+void lnode_pool_free(LNodePool *pool)
+{
+    for(size_t i = 0; i < pool->count; i++) {
+        free(pool->items[i]);
+    }
+
+    da_free(pool);
+    bzero(pool, sizeof(LNodePool));
+}
+
+void ilist_init(IList *list)
+{
+    list->root.prev = &list->root;
+    list->root.next = &list->root;
+    list->count = 0;
+}
+
+void ilist_insert_after(IList *list, IListNode *pos, IListNode *node)
+{
+    node->prev = pos;
+    node->next = pos->next;
+    pos->next->prev = node;
+    pos->next = node;
+    list->count++;
+}
+
+void ilist_push_front(IList *list, IListNode *node)
+{
+    ilist_insert_after(list, &list->root, node);
+}
+
+void ilist_push_back(IList *list, IListNode *node)
+{
+    ilist_insert_after(list, list->root.prev, node);
+}
+
+void ilist_remove(IList *list, IListNode *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+    list->count--;
+}
+
+IListNode *ilist_first(IList *list)
+{
+    return list->count == 0 ? NULL : list->root.next;
+}
+
+IListNode *ilist_last(IList *list)
+{
+    return list->count == 0 ? NULL : list->root.prev;
+}
+
+RingBuffer *ring_buffer_create(size_t capacity)
+{
+    RingBuffer *rb = malloc(sizeof(RingBuffer));
+    bzero(rb, sizeof(RingBuffer));
+
+    rb->capacity = 1;
+    while(rb->capacity < capacity) rb->capacity *= 2;
+
+    rb->items = malloc(rb->capacity);
+    assert(rb->items != NULL && "No enough ram");
+
+    return rb;
+}
+
+// copies "size" bytes between the linear buffer "data" and the ring at "pos"
+static void ring_buffer_copy(RingBuffer *rb, size_t pos, char *data, size_t size, bool to_ring)
+{
+    size_t start = pos & (rb->capacity - 1);
+    size_t first = rb->capacity - start;
+    if(first > size) first = size;
+
+    if(to_ring) {
+        memcpy(rb->items + start, data, first);
+        memcpy(rb->items, data + first, size - first);
+    } else {
+        memcpy(data, rb->items + start, first);
+        memcpy(data + first, rb->items, size - first);
+    }
+}
+
+size_t ring_buffer_write(RingBuffer *rb, const char *data, size_t size)
+{
+    size_t head = atomic_load_explicit(&rb->head, memory_order_relaxed);
+
+    // the tail is only reloaded when the cached one says the buffer is full
+    if(rb->capacity - (head - rb->cached_tail) < size) {
+        rb->cached_tail = atomic_load_explicit(&rb->tail, memory_order_acquire);
+    }
+
+    size_t free_space = rb->capacity - (head - rb->cached_tail);
+    if(size > free_space) size = free_space;
+    if(size == 0) return 0;
+
+    ring_buffer_copy(rb, head, (char *)data, size, true);
+    atomic_store_explicit(&rb->head, head + size, memory_order_release);
+
+    return size;
+}
+
+size_t ring_buffer_count(RingBuffer *rb)
+{
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+    rb->cached_head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    return rb->cached_head - tail;
+}
+
+size_t ring_buffer_read(RingBuffer *rb, char *dest, size_t size)
+{
+    size_t tail = atomic_load_explicit(&rb->tail, memory_order_relaxed);
+
+    if(rb->cached_head - tail < size) {
+        rb->cached_head = atomic_load_explicit(&rb->head, memory_order_acquire);
+    }
+
+    size_t available = rb->cached_head - tail;
+    if(size > available) size = available;
+    if(size == 0) return 0;
+
+    ring_buffer_copy(rb, tail, dest, size, false);
+    atomic_store_explicit(&rb->tail, tail + size, memory_order_release);
+
+    return size;
+}
+
+void ring_buffer_destroy(RingBuffer *rb)
+{
+    free(rb->items);
+    free(rb);
+}
+
+void fenwick_build(Fenwick *tree, const size_t *values, size_t count)
+{
+    da_reserve(tree, count + 1);
+    tree->count = count;
+    tree->items[0] = 0;
+    memcpy(tree->items + 1, values, count*sizeof(size_t));
+
+    // every node adds itself to its parent once
+    for(size_t i = 1; i <= count; i++) {
+        size_t parent = i + (i & -i);
+        if(parent <= count) tree->items[parent] += tree->items[i];
+    }
+}
+
+void fenwick_push(Fenwick *tree, size_t value)
+{
+    da_reserve(tree, tree->count + 2);
+    size_t i = ++tree->count;
+    tree->items[0] = 0;
+
+    // the new node is the sum of the values from i - lowbit(i) + 1 to i, the ones
+    // before i are already summed up by the nodes that end at i - 1
+    size_t sum = value;
+    size_t first = i - (i & -i);
+    for(size_t j = i - 1; j > first; j -= j & -j) {
+        sum += tree->items[j];
+    }
+    tree->items[i] = sum;
+}
+
+void fenwick_add(Fenwick *tree, size_t index, size_t delta)
+{
+    for(size_t i = index + 1; i <= tree->count; i += i & -i) {
+        tree->items[i] += delta;
+    }
+}
+
+size_t fenwick_prefix(Fenwick *tree, size_t count)
+{
+    size_t sum = 0;
+    for(size_t i = count; i > 0; i -= i & -i) {
+        sum += tree->items[i];
+    }
+
+    return sum;
+}
+
+size_t fenwick_search(Fenwick *tree, size_t target)
+{
+    size_t step = 1;
+    while(step * 2 <= tree->count) step *= 2;
+
+    // descends from the biggest power of two, skipping every node whose sum still
+    // fits in what's left of "target"
+    size_t pos = 0;
+    for(; step > 0; step /= 2) {
+        if(pos + step <= tree->count && tree->items[pos + step] <= target) {
+            pos += step;
+            target -= tree->items[pos];
+        }
+    }
+
+    return pos;
+}
+
+void fenwick_free(Fenwick *tree)
+{
+    da_free(tree);
+    tree->items = NULL;
+    tree->count = 0;
+    tree->capacity = 0;
+}
+
+uint64_t hash_u64(uint64_t x)
+{
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t hash_bytes(const void *data, size_t size)
+{
+    // FNV-1a
+    const unsigned char *bytes = data;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for(size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+uint64_t hash_cstr(const char *str)
+{
+    return hash_bytes(str, strlen(str));
+}
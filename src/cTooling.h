@@ -2,8 +2,12 @@
 #define CTOOLING_H
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <assert.h>
 #include <string.h>
+#include <stdatomic.h>
 
 #define DA_INIT_CAP 128
 
@@ -18,6 +22,16 @@
         (da)->items[(da)->count++] = (item);                                         \
     } while(0)
 
+#define da_reserve(da, new_capacity)                                                 \
+    do {                                                                             \
+        if((new_capacity) > (da)->capacity) {                                        \
+            if((da)->capacity == 0) (da)->capacity = DA_INIT_CAP;                    \
+            while((new_capacity) > (da)->capacity) (da)->capacity *= 2;              \
+            (da)->items = realloc((da)->items, (da)->capacity*sizeof(*(da)->items)); \
+            assert((da)->items != NULL && "No enough ram");                          \
+        }                                                                            \
+    } while(0)
+
 #define da_free(da) do { free((da)->items); } while(0)
 
 #define da_append_many(da, new_items, new_items_count)                                  \
@@ -53,6 +67,14 @@ void string_remove_chr(String *str, size_t pos);
 void string_remove_slice(String *str, size_t start, size_t end);
 void string_free(String *str);
 
+#define utf8_is_continuation(c) (((unsigned char)(c) & 0xC0) == 0x80)
+
+// decodes the codepoint at the start of "text" without reading past "size" bytes,
+// invalid sequences return '?' with a size of 1 like raylib's GetCodepointNext
+int utf8_decode(const char *text, size_t size, int *codepoint_size);
+// writes the UTF-8 bytes of "codepoint" to "dest" and returns how many were written
+int utf8_encode(int codepoint, char dest[4]);
+
 typedef struct LNode LNode;
 
 typedef struct {
@@ -67,12 +89,265 @@ struct LNode {
     int type;
 };
 
+#define LNODE_POOL_SLAB_SIZE 1024
+
+// Allocates LNodes in slabs so nodes created together end up next to each other
+// in memory. Released nodes are kept in a freelist and reused by the next alloc.
+typedef struct {
+    LNode **items; // slabs
+    size_t count;
+    size_t capacity;
+    LNode *free_list;
+} LNodePool;
+
 // Linked List functions
 LList *llist_create();
 void llist_append_node(LList *list, LNode *node);
+// inserts "node" after "prev", if "prev" is NULL the node is inserted at the head
+void llist_insert_after(LList *list, LNode *prev, LNode *node);
+// unlinks and returns the node after "prev", or the head if "prev" is NULL
+LNode *llist_remove_after(LList *list, LNode *prev);
 void llist_destroy(LList *list);
+// same as llist_destroy but for lists whose nodes come from "pool"
+void llist_destroy_pooled(LList *list, LNodePool *pool);
 
 // Linked list node functions
 LNode *llist_create_node(int type, void *data);
 
+// Node pool functions
+LNode *lnode_pool_alloc(LNodePool *pool, int type, void *data);
+void lnode_pool_release(LNodePool *pool, LNode *node);
+void lnode_pool_free(LNodePool *pool);
+
+// Intrusive doubly linked list. The IListNode is embedded in the user struct and
+// ilist_entry gets the struct back, so no allocations are done by the list.
+typedef struct IListNode IListNode;
+
+struct IListNode {
+    IListNode *prev;
+    IListNode *next;
+};
+
+typedef struct {
+    IListNode root; // sentinel, root.next is the first node and root.prev the last
+    size_t count;
+} IList;
+
+#define ilist_entry(node, type, member) \
+    ((type *)((char *)(node) - offsetof(type, member)))
+
+#define ilist_foreach(list, it) \
+    for(IListNode *it = (list)->root.next; it != &(list)->root; it = it->next)
+
+void ilist_init(IList *list);
+void ilist_insert_after(IList *list, IListNode *pos, IListNode *node);
+void ilist_push_front(IList *list, IListNode *node);
+void ilist_push_back(IList *list, IListNode *node);
+void ilist_remove(IList *list, IListNode *node);
+// returns NULL when the list is empty
+IListNode *ilist_first(IList *list);
+IListNode *ilist_last(IList *list);
+
+#define CACHE_LINE_SIZE 64
+
+// Lock-free single producer, single consumer byte queue. One thread may write and
+// another one read at the same time without locks, neither of them ever blocks:
+// writes are truncated when the buffer is full and reads return what's available.
+typedef struct {
+    char *items;
+    size_t capacity; // always a power of two
+    // head and tail are on different cache lines so the producer and the consumer
+    // don't invalidate each other's cache on every operation
+    _Atomic size_t head; // written only by the producer
+    size_t cached_tail;  // producer's last seen tail
+    char pad[CACHE_LINE_SIZE];
+    _Atomic size_t tail; // written only by the consumer
+    size_t cached_head;  // consumer's last seen head
+} RingBuffer;
+
+// Ring buffer functions, the capacity is rounded up to a power of two
+RingBuffer *ring_buffer_create(size_t capacity);
+// producer side, returns the number of bytes written
+size_t ring_buffer_write(RingBuffer *rb, const char *data, size_t size);
+// consumer side, returns the number of bytes read
+size_t ring_buffer_read(RingBuffer *rb, char *dest, size_t size);
+// consumer side, returns the number of bytes ready to be read
+size_t ring_buffer_count(RingBuffer *rb);
+void ring_buffer_destroy(RingBuffer *rb);
+
+// Fenwick tree, prefix sums of a list of values with O(log n) updates and searches.
+// Negative deltas can be added, the sums wrap around and still come out right
+// as long as every prefix sum is positive
+typedef struct {
+    size_t *items; // 1-based, items[0] is unused
+    size_t count;
+    size_t capacity;
+} Fenwick;
+
+// Fenwick functions, the tree is rebuilt with "count" values in O(n)
+void fenwick_build(Fenwick *tree, const size_t *values, size_t count);
+// appends a value in amortized O(1), lowering "count" removes the last values
+void fenwick_push(Fenwick *tree, size_t value);
+void fenwick_add(Fenwick *tree, size_t index, size_t delta);
+// sum of the first "count" values
+size_t fenwick_prefix(Fenwick *tree, size_t count);
+// index of the value that contains "target", the first one whose prefix sum
+// including it is bigger than "target". Returns the count when it's past the end
+size_t fenwick_search(Fenwick *tree, size_t target);
+void fenwick_free(Fenwick *tree);
+
+// Hash functions, can be used as the "hash_fn" of a hash map
+uint64_t hash_u64(uint64_t x);
+uint64_t hash_bytes(const void *data, size_t size);
+uint64_t hash_cstr(const char *str);
+
+#define HASHMAP_INIT_CAP 16
+// the map grows when it's more than 80% full
+#define HASHMAP_MAX_LOAD(capacity) ((capacity)/5*4)
+
+#define hashmap_eq(a, b) ((a) == (b))
+#define hashmap_cstr_eq(a, b) (strcmp((a), (b)) == 0)
+
+// Open addressing hash map with Robin Hood probing. Entries are stored inline in
+// a single array, and lookups stop as soon as they reach an entry that is closer
+// to its home slot than the searched key would be, so probes stay short even
+// with high load factors.
+//
+// HASHMAP_DECLARE creates the types and HASHMAP_DEFINE the functions, e.g.:
+//     HASHMAP_DECLARE(IntMap, int, float)
+//     HASHMAP_DEFINE(IntMap, int, float, hash_u64, hashmap_eq)
+// defines IntMap, IntMap_put, IntMap_get, IntMap_remove, IntMap_clear and
+// IntMap_free. A zero initialized map is empty and ready to use.
+#define HASHMAP_DECLARE(name, K, V)                                                  \
+    typedef struct {                                                                 \
+        K key;                                                                       \
+        V value;                                                                     \
+        uint32_t hash;                                                               \
+        uint32_t dist; /* distance to the home slot plus one, 0 means empty */       \
+    } name##Slot;                                                                    \
+                                                                                     \
+    typedef struct {                                                                 \
+        name##Slot *slots;                                                           \
+        size_t capacity; /* always a power of two */                                 \
+        size_t count;                                                                \
+    } name;
+
+#define HASHMAP_DEFINE(name, K, V, hash_fn, eq_fn)                                   \
+    static inline void name##_place(name *map, name##Slot slot)                      \
+    {                                                                                \
+        size_t mask = map->capacity - 1;                                             \
+        size_t i = slot.hash & mask;                                                 \
+        slot.dist = 1;                                                               \
+                                                                                     \
+        for(;;) {                                                                    \
+            name##Slot *cur = &map->slots[i];                                        \
+            if(cur->dist == 0) {                                                     \
+                *cur = slot;                                                         \
+                return;                                                              \
+            }                                                                        \
+            if(cur->dist < slot.dist) {                                              \
+                name##Slot tmp = *cur;                                               \
+                *cur = slot;                                                         \
+                slot = tmp;                                                          \
+            }                                                                        \
+            slot.dist++;                                                             \
+            i = (i + 1) & mask;                                                      \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    static inline void name##_reserve(name *map, size_t count)                       \
+    {                                                                                \
+        size_t capacity = map->capacity == 0 ? HASHMAP_INIT_CAP : map->capacity;     \
+        while(HASHMAP_MAX_LOAD(capacity) < count) capacity *= 2;                     \
+        if(capacity == map->capacity) return;                                        \
+                                                                                     \
+        name##Slot *old_slots = map->slots;                                          \
+        size_t old_capacity = map->capacity;                                         \
+                                                                                     \
+        map->slots = calloc(capacity, sizeof(name##Slot));                           \
+        assert(map->slots != NULL && "No enough ram");                               \
+        map->capacity = capacity;                                                    \
+                                                                                     \
+        for(size_t i = 0; i < old_capacity; i++) {                                   \
+            if(old_slots[i].dist != 0) name##_place(map, old_slots[i]);              \
+        }                                                                            \
+                                                                                     \
+        free(old_slots);                                                             \
+    }                                                                                \
+                                                                                     \
+    /* returns the index of the slot holding "key" or -1 if it's not in the map */   \
+    static inline ptrdiff_t name##_find(name *map, K key)                            \
+    {                                                                                \
+        if(map->count == 0) return -1;                                               \
+                                                                                     \
+        uint32_t hash = (uint32_t)hash_fn(key);                                      \
+        size_t mask = map->capacity - 1;                                             \
+        size_t i = hash & mask;                                                      \
+                                                                                     \
+        for(uint32_t dist = 1;; dist++) {                                            \
+            name##Slot *cur = &map->slots[i];                                        \
+            if(cur->dist < dist) return -1;                                          \
+            if(cur->hash == hash && eq_fn(cur->key, key)) return i;                  \
+            i = (i + 1) & mask;                                                      \
+        }                                                                            \
+    }                                                                                \
+                                                                                     \
+    /* returns a pointer to the value of "key" or NULL if it's not in the map */     \
+    static inline V *name##_get(name *map, K key)                                    \
+    {                                                                                \
+        ptrdiff_t i = name##_find(map, key);                                         \
+        return i < 0 ? NULL : &map->slots[i].value;                                  \
+    }                                                                                \
+                                                                                     \
+    /* inserts or overwrites "key" */                                                \
+    static inline void name##_put(name *map, K key, V value)                         \
+    {                                                                                \
+        ptrdiff_t i = name##_find(map, key);                                         \
+        if(i >= 0) {                                                                 \
+            map->slots[i].value = value;                                             \
+            return;                                                                  \
+        }                                                                            \
+                                                                                     \
+        name##_reserve(map, map->count + 1);                                         \
+        name##_place(map, (name##Slot) {                                             \
+            .key = key, .value = value, .hash = (uint32_t)hash_fn(key),              \
+        });                                                                          \
+        map->count++;                                                                \
+    }                                                                                \
+                                                                                     \
+    /* removes "key", the following entries are shifted back so no tombstones */    \
+    /* are needed. Returns false if the key wasn't in the map */                     \
+    static inline bool name##_remove(name *map, K key)                               \
+    {                                                                                \
+        ptrdiff_t found = name##_find(map, key);                                     \
+        if(found < 0) return false;                                                  \
+                                                                                     \
+        size_t mask = map->capacity - 1;                                             \
+        size_t i = found;                                                            \
+        size_t next = (i + 1) & mask;                                                \
+                                                                                     \
+        while(map->slots[next].dist > 1) {                                           \
+            map->slots[i] = map->slots[next];                                        \
+            map->slots[i].dist--;                                                    \
+            i = next;                                                                \
+            next = (next + 1) & mask;                                                \
+        }                                                                            \
+                                                                                     \
+        map->slots[i].dist = 0;                                                      \
+        map->count--;                                                                \
+        return true;                                                                 \
+    }                                                                                \
+                                                                                     \
+    static inline void name##_clear(name *map)                                       \
+    {                                                                                \
+        if(map->slots != NULL) memset(map->slots, 0, map->capacity*sizeof(name##Slot)); \
+        map->count = 0;                                                              \
+    }                                                                                \
+                                                                                     \
+    static inline void name##_free(name *map)                                        \
+    {                                                                                \
+        free(map->slots);                                                            \
+        bzero(map, sizeof(name));                                                    \
+    }
+
 #endif // CTOOLING_H
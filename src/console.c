@@ -0,0 +1,324 @@
+#include "console.h"
+#include "input_source.h"
+#include "render.h"
+
+Console *create_console(InputProps props, size_t capacity)
+{
+    assert(capacity > 0 && "The console needs a line");
+
+    Console *console = malloc(sizeof(Console));
+    assert(console != NULL && "No enough ram");
+    bzero(console, sizeof(Console));
+
+    console->pos = props.pos;
+    console->size = props.size;
+    console->font = props.font;
+    console->font_size = props.font_size;
+    console->font_color = props.font_color;
+    console->padding = props.padding;
+    console->border_color = props.border_color;
+    console->bg_color = props.bg_color;
+    console->line_closed = true;
+    console->follow = true;
+
+    console->lines = calloc(capacity, sizeof(ConsoleLine));
+    assert(console->lines != NULL && "No enough ram");
+    console->capacity = capacity;
+
+    pthread_mutex_init(&console->lock, NULL);
+
+    return console;
+}
+
+void destroy_console(Console *console)
+{
+    for(size_t i = 0; i < console->capacity; i++) {
+        string_free(&console->lines[i].text);
+        da_free(&console->lines[i].run);
+    }
+
+    free(console->lines);
+    pthread_mutex_destroy(&console->lock);
+    string_free(&console->pending);
+    string_free(&console->drained);
+    free(console);
+}
+
+size_t console_line_count(Console *console)
+{
+    return console->total < console->capacity ? console->total : console->capacity;
+}
+
+static size_t get_oldest_line(Console *console)
+{
+    return console->total - console_line_count(console);
+}
+
+static ConsoleLine *get_line(Console *console, size_t seq)
+{
+    return &console->lines[seq % console->capacity];
+}
+
+// the new line takes the slot of the oldest one once the ring is full
+static void start_line(Console *console)
+{
+    ConsoleLine *line = get_line(console, console->total++);
+    line->text.count = 0;
+    line->shaped = false;
+    console->line_closed = false;
+}
+
+void console_append(Console *console, const char *text, size_t size)
+{
+    while(size > 0) {
+        if(console->line_closed) start_line(console);
+
+        ConsoleLine *line = get_line(console, console->total - 1);
+        const char *new_line = memchr(text, '\n', size);
+        size_t line_size = new_line == NULL ? size : (size_t)(new_line - text);
+
+        size_t room = CONSOLE_MAX_LINE_SIZE - line->text.count;
+        size_t kept = line_size < room ? line_size : room;
+        if(kept > 0) {
+            da_append_many(&line->text, text, kept);
+            line->shaped = false;
+        }
+        console->tail_version++;
+
+        if(new_line == NULL) return;
+
+        console->line_closed = true;
+        text += line_size + 1;
+        size -= line_size + 1;
+    }
+}
+
+void console_write(Console *console, const char *text, size_t size)
+{
+    pthread_mutex_lock(&console->lock);
+
+    String *pending = &console->pending;
+    if(pending->count + size > CONSOLE_MAX_PENDING) {
+        // the UI thread fell behind, the oldest bytes are dropped so the newest
+        // lines are still shown
+        size_t excess = pending->count + size - CONSOLE_MAX_PENDING;
+        if(excess >= pending->count) {
+            console->dropped += pending->count;
+            pending->count = 0;
+            if(size > CONSOLE_MAX_PENDING) {
+                console->dropped += size - CONSOLE_MAX_PENDING;
+                text += size - CONSOLE_MAX_PENDING;
+                size = CONSOLE_MAX_PENDING;
+            }
+        } else {
+            memmove(pending->items, pending->items + excess, pending->count - excess);
+            pending->count -= excess;
+            console->dropped += excess;
+        }
+    }
+
+    da_append_many(pending, text, size);
+    pthread_mutex_unlock(&console->lock);
+}
+
+// appends what the other threads wrote, the lock is only held for the swap
+static void drain_pending(Console *console)
+{
+    pthread_mutex_lock(&console->lock);
+    String drained = console->pending;
+    console->pending = console->drained;
+    console->drained = drained;
+    pthread_mutex_unlock(&console->lock);
+
+    console_append(console, console->drained.items, console->drained.count);
+    console->drained.count = 0;
+}
+
+void console_writer_write(ConsoleWriter *writer, const char *text, size_t size)
+{
+    da_append_many(&writer->buffer, text, size);
+    if(writer->buffer.count >= CONSOLE_WRITER_BATCH) console_writer_flush(writer);
+}
+
+void console_writer_flush(ConsoleWriter *writer)
+{
+    if(writer->buffer.count == 0) return;
+
+    console_write(writer->console, writer->buffer.items, writer->buffer.count);
+    writer->buffer.count = 0;
+}
+
+void console_writer_free(ConsoleWriter *writer)
+{
+    string_free(&writer->buffer);
+}
+
+static Rectangle get_console_box(Console *console)
+{
+    return (Rectangle) {
+        console->pos.x + console->padding.left,
+        console->pos.y + console->padding.top,
+        console->size.x - console->padding.left - console->padding.right,
+        console->size.y - console->padding.top - console->padding.bottom,
+    };
+}
+
+static float get_line_height(Console *console)
+{
+    return console->font_size + CONSOLE_LINE_SPACING;
+}
+
+// lines that fit whole in the console
+static size_t get_page_size(Console *console)
+{
+    size_t page = get_console_box(console).height / get_line_height(console);
+    return page > 0 ? page : 1;
+}
+
+// the console follows the output while the last line is shown
+static void scroll_to_line(Console *console, size_t seq)
+{
+    size_t oldest = get_oldest_line(console);
+    size_t page = get_page_size(console);
+    size_t max_top = console->total > oldest + page ? console->total - page : oldest;
+
+    if(seq < oldest) seq = oldest;
+    console->top = seq < max_top ? seq : max_top;
+    console->follow = console->top == max_top;
+}
+
+static void handle_mouse(Console *console)
+{
+    Vector2 mouse = input_source_get_mouse_position();
+    Rectangle rect = {console->pos.x, console->pos.y, console->size.x, console->size.y};
+    console->hovered = CheckCollisionPointRec(mouse, rect);
+
+    // the focus changes on press, like the other widgets
+    if(input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        console->focused = console->hovered;
+    }
+
+    float wheel = input_source_get_mouse_wheel_move();
+    if(console->hovered && wheel != 0) {
+        long lines = -wheel * CONSOLE_WHEEL_LINES;
+        size_t top = console->top;
+        scroll_to_line(console, lines < 0 && (size_t)-lines > top ? 0 : top + lines);
+    }
+}
+
+static bool is_key_active(int key)
+{
+    return input_source_is_key_pressed(key) || input_source_is_key_pressed_repeat(key);
+}
+
+static void handle_keys(Console *console)
+{
+    size_t page = get_page_size(console);
+    size_t top = console->top;
+
+    if(is_key_active(KEY_DOWN)) {
+        scroll_to_line(console, top + 1);
+    } else if(is_key_active(KEY_UP)) {
+        scroll_to_line(console, top > 0 ? top - 1 : 0);
+    } else if(is_key_active(KEY_PAGE_DOWN)) {
+        scroll_to_line(console, top + page);
+    } else if(is_key_active(KEY_PAGE_UP)) {
+        scroll_to_line(console, top > page ? top - page : 0);
+    } else if(input_source_is_key_pressed(KEY_HOME)) {
+        scroll_to_line(console, 0);
+    } else if(input_source_is_key_pressed(KEY_END)) {
+        scroll_to_line(console, SIZE_MAX);
+    }
+}
+
+// line after the last one that is at least partly visible
+static size_t get_visible_end(Console *console)
+{
+    Rectangle box = get_console_box(console);
+    size_t visible = box.height / get_line_height(console) + 1;
+    size_t end = console->top + visible;
+    return end < console->total ? end : console->total;
+}
+
+// same as the damage of Input, the lines appended under the visible ones don't
+// repaint the console
+static void damage_changes(Console *console)
+{
+    ConsoleDrawState state;
+    memset(&state, 0, sizeof(state));
+    state.pos = console->pos;
+    state.size = console->size;
+    state.focused = console->focused;
+    state.top = console->top;
+    state.end = get_visible_end(console);
+    if(state.end == console->total) state.tail_version = console->tail_version;
+
+    ConsoleDrawState *drawn = &console->drawn;
+    if(memcmp(&state, drawn, sizeof(state)) != 0) {
+        Vector2 pos = console->pos;
+        Vector2 size = console->size;
+        render_add_damage((Rectangle) {drawn->pos.x, drawn->pos.y, drawn->size.x, drawn->size.y});
+        render_add_damage((Rectangle) {pos.x, pos.y, size.x, size.y});
+    }
+
+    *drawn = state;
+}
+
+// the runs of the lines that didn't change since the last frame are drawn again as
+// they are, only new lines and the ones hit by a glyph eviction are shaped
+static void draw_lines(Console *console)
+{
+    Rectangle box = get_console_box(console);
+    float line_height = get_line_height(console);
+    render_push_clip(box);
+    render_set_layer(RENDER_LAYER_TEXT);
+
+    size_t end = get_visible_end(console);
+    for(size_t seq = console->top; seq < end; seq++) {
+        ConsoleLine *line = get_line(console, seq);
+        bool valid = line->shaped && ui_font_run_is_valid(console->font, &line->run)
+            && line->run.font_size == console->font_size;
+
+        if(!valid) {
+            size_t size = line->text.count;
+            if(size > 0 && line->text.items[size - 1] == '\r') size--;
+            ui_font_shape(
+                console->font,
+                line->text.items,
+                size,
+                console->font_size,
+                FONT_SPACING,
+                &line->run
+            );
+            line->shaped = true;
+        }
+
+        float y = box.y + (seq - console->top) * line_height;
+        ui_font_draw_run(console->font, &line->run, (Vector2) {box.x, y}, console->font_color);
+    }
+
+    render_pop_clip();
+}
+
+void handle_console(Console *console)
+{
+    drain_pending(console);
+
+    handle_mouse(console);
+    if(console->focused) handle_keys(console);
+    // the lines dropped from the ring can't stay at the top
+    scroll_to_line(console, console->follow ? SIZE_MAX : console->top);
+
+    damage_changes(console);
+
+    Rectangle rect = {console->pos.x, console->pos.y, console->size.x, console->size.y};
+    render_set_layer(RENDER_LAYER_BACKGROUND);
+    render_rect(rect, console->bg_color);
+
+    draw_lines(console);
+
+    if(console->focused) {
+        render_set_layer(RENDER_LAYER_OVERLAY);
+        render_rect_lines(rect, 2, console->border_color);
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <pthread.h>
+
+#include "cTooling.h"
+#include "font.h"
+#include "input.h"
+#include "raylib.h"
+
+#define CONSOLE_MAX_LINE_SIZE 1024          // longer lines are cut
+#define CONSOLE_MAX_PENDING (4*1024*1024)   // bytes written by other threads between two frames
+#define CONSOLE_WRITER_BATCH (16*1024)      // bytes a ConsoleWriter buffers before taking the lock
+#define CONSOLE_LINE_SPACING 4
+#define CONSOLE_WHEEL_LINES 3
+
+// slot of the ring, its buffers are kept when a new line takes it
+typedef struct {
+    String text;
+    GlyphRun run; // shaped when the line is drawn for the first time
+    bool shaped;
+} ConsoleLine;
+
+// state that was drawn on the last frame, like InputDrawState
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    bool focused;
+    size_t top;
+    size_t end;                // line after the last visible one
+    unsigned int tail_version; // only set when the last line is visible
+} ConsoleDrawState;
+
+// Output console that keeps the last "capacity" lines. The lines are a ring of
+// slots that are reused with their buffers, so appending is amortized O(1) and the
+// memory stops growing once every slot was used. Lines are numbered from the first
+// one ever appended, line "seq" is in lines[seq % capacity].
+//
+// console_append is for the UI thread, other threads write with console_write, the
+// bytes are kept in a buffer that the next frame appends with a single swap under
+// the lock. A ConsoleWriter batches the writes of a thread to take the lock less
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    ConsoleDrawState drawn;
+    ConsoleLine *lines;
+    size_t capacity;
+    size_t total;       // lines ever started
+    bool line_closed;   // the last line ended with a new line
+    unsigned int tail_version; // incremented when the last line changes
+
+    pthread_mutex_t lock; // protects "pending"
+    String pending;
+    String drained;       // pending bytes taken by the UI thread
+    size_t dropped;       // bytes dropped when the UI thread fell behind
+
+    UIFont *font;
+    int font_size;
+    Color font_color;
+    Padding padding;
+    bool focused;
+    bool hovered;
+    size_t top;  // first visible line
+    bool follow; // the last line stays visible as lines are appended
+    Color border_color;
+    Color bg_color;
+} Console;
+
+typedef struct {
+    Console *console;
+    String buffer;
+} ConsoleWriter;
+
+Console *create_console(InputProps props, size_t capacity);
+void destroy_console(Console *console);
+void handle_console(Console *console);
+// UI thread only, the text is split into lines at the new lines
+void console_append(Console *console, const char *text, size_t size);
+// any thread, the text is appended on the next frame
+void console_write(Console *console, const char *text, size_t size);
+// lines kept, at most the capacity
+size_t console_line_count(Console *console);
+
+// buffers the text of a thread and writes it to the console in batches
+void console_writer_write(ConsoleWriter *writer, const char *text, size_t size);
+void console_writer_flush(ConsoleWriter *writer);
+void console_writer_free(ConsoleWriter *writer);
+
+#endif // CONSOLE_H
@@ -0,0 +1,527 @@
+#include <stdio.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "find.h"
+#include "input.h"
+#include "input_source.h"
+#include "render.h"
+
+const char *find_substring(const char *text, size_t size, const char *query, size_t query_size)
+{
+    if(query_size == 0 || query_size > size) return NULL;
+    if(query_size == 1) return memchr(text, query[0], size);
+
+    // "last" is the last position where a match can start
+    size_t last = size - query_size;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // a position is only checked when its first and last bytes match the query,
+    // that filters out almost everything on real text
+    __m128i first = _mm_set1_epi8(query[0]);
+    __m128i final = _mm_set1_epi8(query[query_size - 1]);
+    for(; i + 16 <= last + 1; i += 16) {
+        __m128i starts = _mm_loadu_si128((const __m128i *)(text + i));
+        __m128i ends = _mm_loadu_si128((const __m128i *)(text + i + query_size - 1));
+        __m128i both = _mm_and_si128(_mm_cmpeq_epi8(starts, first), _mm_cmpeq_epi8(ends, final));
+
+        unsigned int mask = _mm_movemask_epi8(both);
+        while(mask != 0) {
+            size_t at = i + __builtin_ctz(mask);
+            if(memcmp(text + at + 1, query + 1, query_size - 2) == 0) return text + at;
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // the tail that doesn't fill 16 bytes
+    while(i <= last) {
+        const char *found = memchr(text + i, query[0], last - i + 1);
+        if(found == NULL) return NULL;
+        if(memcmp(found + 1, query + 1, query_size - 1) == 0) return found;
+        i = found - text + 1;
+    }
+
+    return NULL;
+}
+
+void text_find_free(TextFind *find)
+{
+    string_free(&find->query);
+    string_free(&find->replacement);
+    da_free(&find->matches);
+    da_free(&find->found);
+}
+
+// appends the matches that start in text[from..to)
+static void search_range(
+    TextFind *find,
+    const char *text,
+    size_t size,
+    size_t from,
+    size_t to,
+    TextFindMatches *matches
+)
+{
+    size_t query_size = find->query.count;
+    size_t end = to + query_size - 1 < size ? to + query_size - 1 : size;
+
+    const char *at = text + from;
+    while(at < text + end) {
+        at = find_substring(at, text + end - at, find->query.items, query_size);
+        if(at == NULL) break;
+
+        da_append(matches, at - text);
+        at++;
+    }
+}
+
+void text_find_set_query(
+    TextFind *find,
+    const char *text,
+    size_t size,
+    const char *query,
+    size_t query_size
+)
+{
+    String *old = &find->query;
+    bool extends = old->count > 0 && query_size > old->count
+        && memcmp(query, old->items, old->count) == 0;
+
+    size_t old_size = old->count;
+    old->count = 0;
+    if(query_size > 0) da_append_many(old, query, query_size);
+    find->current = SIZE_MAX;
+    find->version++;
+
+    // filtering touches the text at every match, past a point searching again a
+    // budget per frame is faster to show
+    if(!extends || find->matches.count > TEXT_FIND_MAX_FILTERED) {
+        find->matches.count = 0;
+        find->scanned = 0;
+        return;
+    }
+
+    // the matches of the longer query are matches of the old one that go on with
+    // the new chars, so only the new chars are compared
+    TextFindMatches *matches = &find->matches;
+    const char *added = query + old_size;
+    size_t added_size = query_size - old_size;
+    size_t kept = 0;
+    for(size_t i = 0; i < matches->count; i++) {
+        size_t start = matches->items[i];
+        if(start + query_size > size) break;
+
+        const char *next = text + start + old_size;
+        bool same = next[0] == added[0]
+            && (added_size == 1 || memcmp(next + 1, added + 1, added_size - 1) == 0);
+        matches->items[kept] = start;
+        kept += same;
+    }
+    matches->count = kept;
+}
+
+bool text_find_is_done(TextFind *find, size_t size)
+{
+    return find->query.count == 0 || find->scanned >= size;
+}
+
+bool text_find_update(TextFind *find, const char *text, size_t size, size_t budget)
+{
+    if(text_find_is_done(find, size)) return true;
+
+    size_t to = size - find->scanned > budget ? find->scanned + budget : size;
+    size_t count = find->matches.count;
+    search_range(find, text, size, find->scanned, to, &find->matches);
+    find->scanned = to;
+
+    if(find->matches.count != count || to == size) find->version++;
+    return to == size;
+}
+
+// first match that starts at or after "pos"
+static size_t get_first_starting_at(TextFind *find, size_t pos)
+{
+    TextFindMatches *matches = &find->matches;
+    size_t lo = 0, hi = matches->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(matches->items[mid] < pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+size_t text_find_first_after(TextFind *find, size_t pos)
+{
+    // the match ends after "pos" when it starts after pos - query size
+    size_t query_size = find->query.count;
+    return get_first_starting_at(find, pos >= query_size ? pos - query_size + 1 : 0);
+}
+
+void text_find_match(TextFind *find, size_t index, size_t *start, size_t *end)
+{
+    *start = find->matches.items[index];
+    *end = *start + find->query.count;
+}
+
+void text_find_truncate(TextFind *find, size_t pos)
+{
+    size_t from = text_find_first_after(find, pos);
+    if(from == find->matches.count && find->scanned <= pos) return;
+
+    find->matches.count = from;
+    size_t query_size = find->query.count;
+    size_t rescan = pos >= query_size ? pos - query_size + 1 : 0;
+    if(find->scanned > rescan) find->scanned = rescan;
+    find->current = SIZE_MAX;
+    find->version++;
+}
+
+void text_find_edit(
+    TextFind *find,
+    const char *text,
+    size_t size,
+    size_t pos,
+    size_t removed,
+    size_t inserted
+)
+{
+    size_t query_size = find->query.count;
+    if(query_size == 0) return;
+
+    // matches that start from here on can overlap the edit
+    size_t from = pos >= query_size ? pos - query_size + 1 : 0;
+    if(find->scanned <= from) return;
+
+    // the search stopped inside of the edit, it goes on from before it
+    if(find->scanned < pos + removed) {
+        text_find_truncate(find, pos);
+        return;
+    }
+
+    TextFindMatches *matches = &find->matches;
+    size_t lo = get_first_starting_at(find, from);
+    size_t hi = get_first_starting_at(find, pos + removed);
+
+    // the matches after the edit keep their text, they are only moved. The sum
+    // wraps around when the text shrinks like the delta of the text area lines
+    size_t shift = inserted - removed;
+    for(size_t i = hi; i < matches->count; i++) matches->items[i] += shift;
+    find->scanned += shift;
+
+    // the matches that start between "from" and the end of the inserted bytes
+    // replace the ones that overlapped the edit
+    TextFindMatches *found = &find->found;
+    found->count = 0;
+    search_range(find, text, size, from, pos + inserted, found);
+
+    size_t new_count = matches->count - (hi - lo) + found->count;
+    da_reserve(matches, new_count);
+    if(hi < matches->count) {
+        memmove(
+            matches->items + lo + found->count,
+            matches->items + hi,
+            (matches->count - hi)*sizeof(*matches->items)
+        );
+    }
+    if(found->count > 0) {
+        memcpy(matches->items + lo, found->items, found->count*sizeof(*found->items));
+    }
+    matches->count = new_count;
+
+    find->current = SIZE_MAX;
+    find->version++;
+}
+
+bool text_find_next(TextFind *find, const char *text, size_t size, size_t pos)
+{
+    if(find->query.count == 0) return false;
+
+    size_t index = get_first_starting_at(find, pos);
+    while(index == find->matches.count && !text_find_is_done(find, size)) {
+        text_find_update(find, text, size, TEXT_FIND_BUDGET);
+        index = get_first_starting_at(find, pos);
+    }
+
+    // wraps around to the first match
+    if(index == find->matches.count) index = 0;
+    if(index == find->matches.count) return false;
+
+    find->current = index;
+    find->version++;
+    return true;
+}
+
+bool text_find_previous(TextFind *find, const char *text, size_t size, size_t pos)
+{
+    if(find->query.count == 0) return false;
+
+    while(find->scanned < pos && !text_find_is_done(find, size)) {
+        text_find_update(find, text, size, TEXT_FIND_BUDGET);
+    }
+
+    size_t index = get_first_starting_at(find, pos);
+    if(index == 0) {
+        // wraps around to the last match, that needs the whole text searched
+        while(!text_find_update(find, text, size, TEXT_FIND_BUDGET));
+        index = find->matches.count;
+    }
+    if(index == 0) return false;
+
+    find->current = index - 1;
+    find->version++;
+    return true;
+}
+
+// the capacity of "out" has to be reserved already
+static void append_reserved(String *out, const char *bytes, size_t size)
+{
+    if(size == 0) return;
+    memcpy(out->items + out->count, bytes, size);
+    out->count += size;
+}
+
+size_t text_find_replace_all(
+    TextFind *find,
+    const char *text,
+    size_t size,
+    String *out,
+    size_t *pos
+)
+{
+    if(find->query.count == 0) return 0;
+    while(!text_find_update(find, text, size, TEXT_FIND_BUDGET));
+
+    // the matches can overlap, the ones that start inside of a replaced match are
+    // skipped. The size of the result is known before copying anything
+    TextFindMatches *matches = &find->matches;
+    size_t query_size = find->query.count;
+    size_t count = 0, end = 0;
+    for(size_t i = 0; i < matches->count; i++) {
+        if(matches->items[i] < end) continue;
+        count++;
+        end = matches->items[i] + query_size;
+    }
+    if(count == 0) return 0;
+
+    String *replacement = &find->replacement;
+    out->count = 0;
+    da_reserve(out, size - count*query_size + count*replacement->count);
+
+    // copies the text between the matches and the replacements in a single pass,
+    // "pos" is moved with the text around it
+    size_t copied = 0, new_pos = SIZE_MAX;
+    for(size_t i = 0; i < matches->count; i++) {
+        size_t start = matches->items[i];
+        if(start < copied) continue;
+
+        if(*pos >= copied && *pos <= start) new_pos = out->count + *pos - copied;
+        append_reserved(out, text + copied, start - copied);
+
+        if(*pos > start && *pos < start + query_size) new_pos = out->count;
+        append_reserved(out, replacement->items, replacement->count);
+        copied = start + query_size;
+    }
+
+    if(new_pos == SIZE_MAX) new_pos = out->count + *pos - copied;
+    append_reserved(out, text + copied, size - copied);
+    *pos = new_pos;
+
+    // the text is new, it's searched again from the start
+    text_find_truncate(find, 0);
+    return count;
+}
+
+// applies the typed chars and backspace to "field" that holds "size" bytes, a
+// "selected" field is replaced. Returns the new size
+static size_t edit_field(char *field, size_t size, bool *selected)
+{
+    bool is_backspace_active = input_source_is_key_pressed(KEY_BACKSPACE)
+        || input_source_is_key_pressed_repeat(KEY_BACKSPACE);
+
+    int chr;
+    while((chr = input_source_get_char()) != 0) {
+        if(*selected) size = 0;
+        *selected = false;
+        if(size + 4 > TEXT_FIND_MAX_QUERY) continue;
+        size += utf8_encode(chr, field + size);
+    }
+
+    if(is_backspace_active && *selected) {
+        size = 0;
+    } else if(is_backspace_active && size > 0) {
+        size--;
+        while(size > 0 && utf8_is_continuation(field[size])) size--;
+    }
+    if(is_backspace_active) *selected = false;
+
+    return size;
+}
+
+// ctrl + f and ctrl + h open the bar, or close it when it already shows the same
+static void toggle_bar(TextFind *find, bool replacing)
+{
+    if(find->active && find->replacing == replacing) {
+        find->active = false;
+    } else {
+        // the query of the last search is selected when the bar opens
+        if(!find->active) find->query_selected = find->query.count > 0;
+        find->active = true;
+        find->replacing = replacing;
+        find->editing_replacement = false;
+    }
+    find->version++;
+}
+
+TextFindAction text_find_handle_keys(TextFind *find, const char *text, size_t text_size)
+{
+    bool ctrl = is_ctrl_down();
+    if(ctrl && input_source_is_key_pressed(KEY_F)) {
+        toggle_bar(find, false);
+        return TEXT_FIND_NONE;
+    } else if(ctrl && input_source_is_key_pressed(KEY_H)) {
+        toggle_bar(find, true);
+        return TEXT_FIND_NONE;
+    }
+
+    if(!find->active) return TEXT_FIND_NONE;
+
+    if(input_source_is_key_pressed(KEY_ESCAPE)) {
+        find->active = false;
+        find->version++;
+        return TEXT_FIND_NONE;
+    }
+
+    // tab moves between the query and the replacement
+    if(find->replacing && input_source_is_key_pressed(KEY_TAB)) {
+        find->editing_replacement = !find->editing_replacement;
+        find->version++;
+    }
+
+    // the fields are edited in a copy so the matches are filtered from the old query
+    char field[TEXT_FIND_MAX_QUERY + 4];
+    String *edited = find->editing_replacement ? &find->replacement : &find->query;
+    size_t size = edited->count;
+    if(size > 0) memcpy(field, edited->items, size);
+
+    bool not_selected = false;
+    bool *selected = find->editing_replacement ? &not_selected : &find->query_selected;
+    size = edit_field(field, size, selected);
+
+    bool changed = size != edited->count || (size > 0 && memcmp(field, edited->items, size) != 0);
+    if(changed && find->editing_replacement) {
+        edited->count = 0;
+        if(size > 0) da_append_many(edited, field, size);
+        find->version++;
+    } else if(changed) {
+        text_find_set_query(find, text, text_size, field, size);
+    }
+
+    bool shift = input_source_is_key_down(KEY_LEFT_SHIFT)
+        || input_source_is_key_down(KEY_RIGHT_SHIFT);
+    bool is_enter_active = input_source_is_key_pressed(KEY_ENTER)
+        || input_source_is_key_pressed_repeat(KEY_ENTER);
+    if(is_enter_active && ctrl && find->replacing) return TEXT_FIND_REPLACE_ALL;
+    if(is_enter_active) return shift ? TEXT_FIND_PREVIOUS : TEXT_FIND_NEXT;
+
+    return TEXT_FIND_NONE;
+}
+
+float text_find_bar_height(TextFind *find, int font_size)
+{
+    float row_height = font_size + TEXT_FIND_BAR_PADDING*2;
+    return find->replacing ? row_height*2 : row_height;
+}
+
+// the field being edited is brighter, the placeholder is shown until something is typed
+static void draw_field(
+    String *field,
+    const char *placeholder,
+    bool editing,
+    bool selected,
+    Vector2 pos,
+    UIFont *font,
+    int font_size,
+    Color font_color
+)
+{
+    Color color = ColorAlpha(font_color, editing ? 1 : 0.6);
+    if(field->count == 0) {
+        color = ColorAlpha(font_color, 0.5);
+        ui_font_draw(font, placeholder, strlen(placeholder), pos, font_size, FONT_SPACING, color);
+        return;
+    }
+
+    if(selected) {
+        Vector2 measured = ui_font_measure(
+            font, field->items, field->count, font_size, FONT_SPACING
+        );
+        Rectangle selection = {pos.x, pos.y - 1, measured.x, font_size + 2};
+        render_set_layer(RENDER_LAYER_POPUP);
+        render_rect(selection, ColorAlpha(font_color, 0.4));
+        render_set_layer(RENDER_LAYER_POPUP_TEXT);
+    }
+    ui_font_draw(font, field->items, field->count, pos, font_size, FONT_SPACING, color);
+}
+
+void text_find_draw_bar(
+    TextFind *find,
+    size_t size,
+    Rectangle rect,
+    UIFont *font,
+    int font_size,
+    Color font_color,
+    Color bg_color,
+    Color border_color
+)
+{
+    char status[64];
+    int status_size;
+    const char *searching = text_find_is_done(find, size) ? "" : " ...";
+    size_t count = find->matches.count;
+    if(find->current != SIZE_MAX) {
+        status_size = snprintf(
+            status, sizeof(status), "%zu/%zu%s", find->current + 1, count, searching
+        );
+    } else {
+        status_size = snprintf(status, sizeof(status), "%zu%s", count, searching);
+    }
+
+    render_push_clip(rect);
+    render_set_layer(RENDER_LAYER_POPUP);
+    render_rect(rect, bg_color);
+    render_set_layer(RENDER_LAYER_POPUP_TEXT);
+
+    Vector2 pos = {rect.x + TEXT_FIND_BAR_PADDING, rect.y + TEXT_FIND_BAR_PADDING};
+    bool editing = !find->editing_replacement;
+    draw_field(
+        &find->query, "Find", editing, find->query_selected, pos, font, font_size, font_color
+    );
+    if(find->replacing) {
+        Vector2 replacement_pos = {pos.x, pos.y + font_size + TEXT_FIND_BAR_PADDING*2};
+        draw_field(
+            &find->replacement,
+            "Replace",
+            !editing,
+            false,
+            replacement_pos,
+            font,
+            font_size,
+            font_color
+        );
+    }
+
+    float status_width = ui_font_measure(font, status, status_size, font_size, FONT_SPACING).x;
+    pos.x = rect.x + rect.width - TEXT_FIND_BAR_PADDING - status_width;
+    Color status_color = ColorAlpha(font_color, 0.7);
+    ui_font_draw(font, status, status_size, pos, font_size, FONT_SPACING, status_color);
+
+    render_pop_clip();
+    render_rect_lines(rect, 1, border_color);
+}
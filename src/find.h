@@ -0,0 +1,113 @@
+#ifndef FIND_H
+#define FIND_H
+
+#include "cTooling.h"
+#include "font.h"
+#include "raylib.h"
+
+#define TEXT_FIND_BUDGET (4*1024*1024) // bytes searched per frame
+#define TEXT_FIND_MAX_FILTERED 65536  // more matches are searched again when the query grows
+#define TEXT_FIND_MAX_QUERY 256
+#define TEXT_FIND_BAR_PADDING 6
+
+// starts of the matches, sorted. They all have the size of the query so the ends
+// are sorted too, matches can overlap
+typedef struct {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+} TextFindMatches;
+
+// Find mode shared by the text widgets. Every occurrence of the query is kept,
+// the text is searched a budget of bytes per frame so the first matches show up
+// right away on big texts. When a char is added to the query the new matches are
+// picked from the old ones instead of searching again, unless there are too many,
+// and an edit only searches the text around it
+typedef struct {
+    bool active;
+    String query;
+    bool query_selected; // the next char typed replaces the query
+    String replacement;
+    bool replacing;           // the bar shows the replacement under the query
+    bool editing_replacement; // the typed chars go to the replacement
+    TextFindMatches matches;
+    TextFindMatches found; // matches of the last edit, kept to reuse its buffer
+    size_t scanned;        // every match that starts in text[0..scanned) is known
+    size_t current;        // match picked by next or previous, SIZE_MAX when none
+    size_t version;        // incremented when the matches or the query change
+} TextFind;
+
+// same as memmem, candidates are found 16 bytes at a time comparing their first
+// and last bytes with SSE2, or with memchr on the first byte without it
+const char *find_substring(const char *text, size_t size, const char *query, size_t query_size);
+
+void text_find_free(TextFind *find);
+// the text is only read to filter the matches when the query gets longer
+void text_find_set_query(
+    TextFind *find,
+    const char *text,
+    size_t size,
+    const char *query,
+    size_t query_size
+);
+// searches "budget" bytes more of the text, returns true when it's all searched
+bool text_find_update(TextFind *find, const char *text, size_t size, size_t budget);
+bool text_find_is_done(TextFind *find, size_t size);
+// the text changed from "pos" on, it will be searched again from there
+void text_find_truncate(TextFind *find, size_t pos);
+// "removed" bytes at "pos" were replaced with "inserted" ones, the matches after
+// them are shifted and only the bytes around the edit are searched
+void text_find_edit(
+    TextFind *find,
+    const char *text,
+    size_t size,
+    size_t pos,
+    size_t removed,
+    size_t inserted
+);
+// index of the first match that ends after "pos", to draw the visible ones
+size_t text_find_first_after(TextFind *find, size_t pos);
+void text_find_match(TextFind *find, size_t index, size_t *start, size_t *end);
+// first match at or after "pos", or the first one when there's none. The text is
+// searched as far as needed, returns false when there are no matches
+bool text_find_next(TextFind *find, const char *text, size_t size, size_t pos);
+// last match that starts before "pos", or the last one when there's none
+bool text_find_previous(TextFind *find, const char *text, size_t size, size_t pos);
+// writes the text with every match replaced to "out", that is allocated once with
+// the final size. When matches overlap only the first one is replaced. "pos" is
+// moved to the same place in the new text. Returns the number of replacements,
+// "out" is left as it was when there are none
+size_t text_find_replace_all(
+    TextFind *find,
+    const char *text,
+    size_t size,
+    String *out,
+    size_t *pos
+);
+
+typedef enum {
+    TEXT_FIND_NONE,
+    TEXT_FIND_NEXT,     // enter
+    TEXT_FIND_PREVIOUS, // shift + enter
+    TEXT_FIND_REPLACE_ALL, // ctrl + enter when replacing
+} TextFindAction;
+
+// ctrl + f opens the find bar and ctrl + h opens it with a replacement, while it's
+// open the typed chars go to the query, or to the replacement after a tab, and
+// escape closes it
+TextFindAction text_find_handle_keys(TextFind *find, const char *text, size_t size);
+// one row for the query and another one for the replacement
+float text_find_bar_height(TextFind *find, int font_size);
+// the query, the match picked and the count of matches, with "..." while searching
+void text_find_draw_bar(
+    TextFind *find,
+    size_t size,
+    Rectangle rect,
+    UIFont *font,
+    int font_size,
+    Color font_color,
+    Color bg_color,
+    Color border_color
+);
+
+#endif // FIND_H
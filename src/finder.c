@@ -0,0 +1,200 @@
+#include <stdio.h>
+
+#include "finder.h"
+#include "input_source.h"
+#include "render.h"
+
+static size_t get_match_count(void *data)
+{
+    Finder *finder = data;
+    return finder->snapshot.matches.count;
+}
+
+static void get_match_text(void *data, size_t row, String *text)
+{
+    Finder *finder = data;
+    uint32_t index = finder->snapshot.matches.items[row].index;
+    string_append_text(text, finder->matcher->candidates[index]);
+}
+
+static float get_status_height(int font_size)
+{
+    return font_size + FINDER_STATUS_PADDING*2;
+}
+
+Finder *create_finder(FinderProps props)
+{
+    Finder *finder = malloc(sizeof(Finder));
+    assert(finder != NULL && "No enough ram");
+    bzero(finder, sizeof(Finder));
+
+    finder->pos = props.pos;
+    finder->size = props.size;
+
+    finder->input = create_input((InputProps) {
+        .pos = props.pos,
+        .size = { props.size.x, FINDER_INPUT_HEIGHT },
+        .placeholder = "Filter",
+        .font = props.font,
+        .font_size = props.font_size,
+        .font_color = props.font_color,
+        .padding = { 20, 20, 20, 20 },
+        .border_color = props.border_color,
+        .bg_color = props.bg_color,
+    });
+
+    // the match count is shown between the input and the list
+    float list_y = FINDER_INPUT_HEIGHT + get_status_height(props.font_size);
+    finder->list = create_list((ListProps) {
+        .pos = { props.pos.x, props.pos.y + list_y },
+        .size = { props.size.x, props.size.y - list_y },
+        .source = {
+            .data = finder,
+            .get_count = get_match_count,
+            .get_text = get_match_text,
+        },
+        .font = props.font,
+        .font_size = props.font_size,
+        .font_color = props.font_color,
+        .padding = { 10, 10, 10, 10 },
+        .row_height = props.font_size + 8,
+        .border_color = props.border_color,
+        .bg_color = props.bg_color,
+        .selection_color = props.selection_color,
+    });
+
+    // everything matches the empty query
+    finder->matcher = fuzzy_matcher_create(props.candidates, props.count, 0);
+    fuzzy_matcher_submit(finder->matcher, "", 0);
+
+    return finder;
+}
+
+const char *finder_get_selected(Finder *finder)
+{
+    size_t selected = finder->list->selected;
+    if(selected >= finder->snapshot.matches.count) return NULL;
+
+    return finder->matcher->candidates[finder->snapshot.matches.items[selected].index];
+}
+
+static bool is_key_active(int key)
+{
+    return input_source_is_key_pressed(key) || input_source_is_key_pressed_repeat(key);
+}
+
+// the query is submitted on every change of the text, the query in flight is
+// cancelled by the matcher
+static void submit_query(Finder *finder)
+{
+    Input *input = finder->input;
+    if(finder->query_version == input->text_version) return;
+
+    fuzzy_matcher_submit(finder->matcher, input->text.items, input->text.count);
+    finder->query_version = input->text_version;
+}
+
+// takes the results published by the workers since the last frame, a new query
+// selects its best match
+static void pull_results(Finder *finder)
+{
+    unsigned int generation = finder->snapshot.generation;
+    if(!fuzzy_matcher_poll(finder->matcher, &finder->snapshot)) return;
+
+    List *list = finder->list;
+    list_invalidate(list);
+    if(finder->snapshot.generation != generation) {
+        list->selected = SIZE_MAX;
+        list->scroll = 0;
+        list->scroll_target = 0;
+    }
+
+    // the first chunks can have no matches
+    if(list->selected == SIZE_MAX && finder->snapshot.matches.count > 0) list->selected = 0;
+}
+
+// the arrows move the selection of the list while the query is typed
+static void handle_selection_keys(Finder *finder)
+{
+    List *list = finder->list;
+    size_t count = finder->snapshot.matches.count;
+    if(!finder->input->focused || count == 0) return;
+
+    size_t selected = list->selected;
+    bool none = selected == SIZE_MAX;
+    if(is_key_active(KEY_DOWN)) {
+        selected = none ? 0 : selected + 1;
+    } else if(is_key_active(KEY_UP)) {
+        selected = none || selected == 0 ? 0 : selected - 1;
+    } else {
+        return;
+    }
+
+    if(selected >= count) selected = count - 1;
+    list->selected = selected;
+    list_scroll_to(list, selected);
+}
+
+static Rectangle get_status_rect(Finder *finder)
+{
+    return (Rectangle) {
+        finder->pos.x,
+        finder->pos.y + FINDER_INPUT_HEIGHT,
+        finder->size.x,
+        get_status_height(finder->input->font_size),
+    };
+}
+
+// same as the damage of Input
+static void damage_changes(Finder *finder)
+{
+    FinderDrawState state;
+    memset(&state, 0, sizeof(state));
+    state.pos = finder->pos;
+    state.size = finder->size;
+    state.matched = finder->snapshot.matched;
+    state.done = finder->snapshot.done;
+
+    FinderDrawState *drawn = &finder->drawn;
+    if(memcmp(&state, drawn, sizeof(state)) != 0) render_add_damage(get_status_rect(finder));
+
+    *drawn = state;
+}
+
+static void draw_status(Finder *finder)
+{
+    Input *input = finder->input;
+    String *status = &finder->status;
+    char buffer[64];
+    snprintf(
+        buffer, sizeof(buffer), "%zu/%zu%s",
+        finder->snapshot.matched, finder->matcher->count, finder->snapshot.done ? "" : " ..."
+    );
+    status->count = 0;
+    string_append_text(status, buffer);
+
+    Rectangle rect = get_status_rect(finder);
+    render_set_layer(RENDER_LAYER_TEXT);
+    ui_font_draw(
+        input->font,
+        status->items,
+        status->count,
+        (Vector2) {rect.x + input->padding.left, rect.y + FINDER_STATUS_PADDING},
+        input->font_size,
+        FONT_SPACING,
+        ColorAlpha(input->font_color, 0.6)
+    );
+}
+
+void handle_finder(Finder *finder)
+{
+    handle_input(finder->input);
+    submit_query(finder);
+    pull_results(finder);
+    handle_selection_keys(finder);
+
+    handle_list(finder->list);
+
+    damage_changes(finder);
+    draw_status(finder);
+}
@@ -0,0 +1,55 @@
+#ifndef FINDER_H
+#define FINDER_H
+
+#include "cTooling.h"
+#include "font.h"
+#include "fuzzy.h"
+#include "input.h"
+#include "list.h"
+#include "raylib.h"
+
+#define FINDER_INPUT_HEIGHT 60
+#define FINDER_STATUS_PADDING 4 // space above and below the match count
+
+// state that was drawn on the last frame, like InputDrawState
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    size_t matched;
+    bool done;
+} FinderDrawState;
+
+// fzf like filter, the query is typed in the input and the candidates that match
+// it are ranked in the list under it. The matching runs on the threads of the
+// matcher, every frame only takes the results published since the last one
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    Input *input;
+    List *list;
+    FuzzyMatcher *matcher;
+    FuzzySnapshot snapshot;
+    size_t query_version; // text version of the input the last query was submitted for
+    FinderDrawState drawn;
+    String status;
+} Finder;
+
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    const char **candidates; // borrowed, they have to outlive the finder
+    size_t count;
+    UIFont *font;
+    int font_size;
+    Color font_color;
+    Color border_color;
+    Color bg_color;
+    Color selection_color;
+} FinderProps;
+
+Finder *create_finder(FinderProps props);
+void handle_finder(Finder *finder);
+// candidate of the selected row, NULL when none is selected
+const char *finder_get_selected(Finder *finder);
+
+#endif // FINDER_H
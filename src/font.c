@@ -0,0 +1,542 @@
+#include "font.h"
+#include "render.h"
+
+HASHMAP_DEFINE(GlyphMap, int, int, hash_u64, hashmap_eq)
+
+// dynamic fonts, their atlases are uploaded once per frame by ui_font_flush_all
+static struct {
+    UIFont **items;
+    size_t count;
+    size_t capacity;
+} dynamic_fonts;
+
+// same as raylib's SDF example shader, the distance is stored in the alpha channel
+// and the edge is smoothed by how much the distance changes between fragments
+static const char *sdf_fragment_shader =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    float dist = texture(texture0, fragTexCoord).a - 0.5;\n"
+    "    float change = length(vec2(dFdx(dist), dFdy(dist)));\n"
+    "    float alpha = smoothstep(-change, change, dist);\n"
+    "    finalColor = vec4(fragColor.rgb, fragColor.a*alpha);\n"
+    "}\n";
+
+UIFont *create_ui_font(Font font)
+{
+    UIFont *ui_font = malloc(sizeof(UIFont));
+    bzero(ui_font, sizeof(UIFont));
+
+    ui_font->font = font;
+    ui_font->bmp = malloc(FONT_BMP_SIZE*sizeof(int));
+    ui_font->bmp_size = FONT_BMP_SIZE;
+    assert(ui_font->bmp != NULL && "No enough ram");
+
+    // raylib falls back to '?' or to the first glyph
+    for(int i = 0; i < font.glyphCount; i++) {
+        if(font.glyphs[i].value == '?') {
+            ui_font->fallback = i;
+            break;
+        }
+    }
+
+    for(int i = 0; i < FONT_BMP_SIZE; i++) {
+        ui_font->bmp[i] = ui_font->fallback;
+    }
+
+    // iterates backwards so the first glyph wins when a codepoint is repeated, like
+    // with GetGlyphIndex
+    for(int i = font.glyphCount - 1; i >= 0; i--) {
+        int codepoint = font.glyphs[i].value;
+
+        if(codepoint >= 0 && codepoint < FONT_BMP_SIZE) {
+            ui_font->bmp[codepoint] = i;
+        } else {
+            GlyphMap_put(&ui_font->astral, codepoint, i);
+        }
+    }
+
+    return ui_font;
+}
+
+static void set_glyph_index(UIFont *font, int codepoint, int index)
+{
+    if(codepoint >= 0 && codepoint < font->bmp_size) {
+        font->bmp[codepoint] = index;
+    } else if(index < 0) {
+        GlyphMap_remove(&font->astral, codepoint);
+    } else {
+        GlyphMap_put(&font->astral, codepoint, index);
+    }
+}
+
+static int get_cell_count(UIFont *font, int height)
+{
+    return (FONT_ATLAS_WIDTH / font->cell_size) * (height / font->cell_size);
+}
+
+// makes room for the glyphs of all the cells in an atlas of "height". The slots
+// are allocated once for the max height since the lru list points to them
+static void resize_slots(UIFont *font, int height)
+{
+    int capacity = get_cell_count(font, height);
+
+    font->font.glyphs = realloc(font->font.glyphs, capacity*sizeof(GlyphInfo));
+    font->font.recs = realloc(font->font.recs, capacity*sizeof(Rectangle));
+    assert(font->font.glyphs != NULL && font->font.recs != NULL && "No enough ram");
+
+    font->slot_capacity = capacity;
+}
+
+// returns a free slot, growing the atlas or evicting the least recently used glyph
+// if needed. Returns -1 if every glyph was used in this frame
+static int get_free_slot(UIFont *font)
+{
+    if(font->font.glyphCount < font->slot_capacity) {
+        return font->font.glyphCount++;
+    }
+
+    if(font->atlas.height < FONT_ATLAS_MAX_HEIGHT) {
+        int old_height = font->atlas.height;
+        ImageResizeCanvas(&font->atlas, FONT_ATLAS_WIDTH, old_height*2, 0, 0, BLANK);
+        resize_slots(font, font->atlas.height);
+        font->atlas_grown = true;
+        return font->font.glyphCount++;
+    }
+
+    IListNode *last = ilist_last(&font->lru);
+    if(last == NULL) return -1;
+
+    // the glyphs used in this frame may already be in the command buffer
+    GlyphSlot *slot = ilist_entry(last, GlyphSlot, lru);
+    if(slot->epoch == font->epoch) return -1;
+
+    ilist_remove(&font->lru, last);
+    set_glyph_index(font, slot->codepoint, -1);
+    font->glyphs_version++;
+    return slot - font->slots;
+}
+
+// rasterizes "codepoint" into a free cell and returns its glyph index
+static int load_glyph(UIFont *font, int codepoint)
+{
+    GlyphInfo *glyph = LoadFontData(
+        font->file_data,
+        font->file_size,
+        font->font.baseSize,
+        &codepoint,
+        1,
+        font->mode == UI_FONT_SDF ? FONT_SDF : FONT_DEFAULT
+    );
+
+    // codepoints missing in the font are drawn with the fallback glyph
+    if(glyph == NULL || (glyph->advanceX == 0 && glyph->image.data == NULL)) {
+        if(glyph != NULL) UnloadFontData(glyph, 1);
+        if(font->font.glyphCount > 0) set_glyph_index(font, codepoint, font->fallback);
+        return font->fallback;
+    }
+
+    int index = get_free_slot(font);
+    if(index < 0) {
+        UnloadFontData(glyph, 1);
+        // the next lookups of the frame take the fallback without rasterizing the
+        // glyph again, it's loaded on the first lookup after the flush
+        set_glyph_index(font, codepoint, font->fallback);
+        da_append(&font->deferred, codepoint);
+        return font->fallback;
+    }
+
+    int columns = FONT_ATLAS_WIDTH / font->cell_size;
+    int cell_x = (index % columns) * font->cell_size + FONT_GLYPH_PADDING;
+    int cell_y = (index / columns) * font->cell_size + FONT_GLYPH_PADDING;
+    int max_size = font->cell_size - 2*FONT_GLYPH_PADDING;
+
+    Image *image = &glyph->image;
+    Rectangle rec = {
+        cell_x,
+        cell_y,
+        image->width < max_size ? image->width : max_size,
+        image->height < max_size ? image->height : max_size,
+    };
+
+    // the glyph is grayscale and the atlas gray+alpha, like raylib's atlases. The
+    // whole cell is written to clear what an evicted glyph left there
+    unsigned char *src = image->data;
+    unsigned char *dest = font->atlas.data;
+    for(int y = 0; y < font->cell_size - FONT_GLYPH_PADDING; y++) {
+        for(int x = 0; x < font->cell_size - FONT_GLYPH_PADDING; x++) {
+            bool inside = y < rec.height && x < rec.width;
+            size_t i = ((cell_y + y) * FONT_ATLAS_WIDTH + cell_x + x) * 2;
+            dest[i] = 255;
+            dest[i + 1] = inside ? src[y * image->width + x] : 0;
+        }
+    }
+
+    font->font.glyphs[index] = (GlyphInfo) {
+        .value = codepoint,
+        .offsetX = glyph->offsetX,
+        .offsetY = glyph->offsetY,
+        .advanceX = glyph->advanceX,
+    };
+    UnloadFontData(glyph, 1);
+
+    font->font.recs[index] = rec;
+
+    if(font->dirty_top > cell_y) font->dirty_top = cell_y - FONT_GLYPH_PADDING;
+    int cell_bottom = cell_y + font->cell_size - FONT_GLYPH_PADDING;
+    if(font->dirty_bottom < cell_bottom) font->dirty_bottom = cell_bottom;
+
+    GlyphSlot *slot = &font->slots[index];
+    slot->codepoint = codepoint;
+    slot->epoch = font->epoch;
+    set_glyph_index(font, codepoint, index);
+
+    // the fallback glyph is never evicted
+    if(index != font->fallback) ilist_push_front(&font->lru, &slot->lru);
+
+    return index;
+}
+
+static void load_atlas_texture(UIFont *font)
+{
+    font->font.texture = LoadTextureFromImage(font->atlas);
+
+    // distances have to be interpolated between texels for the edges to be smooth
+    if(font->mode == UI_FONT_SDF) {
+        SetTextureFilter(font->font.texture, TEXTURE_FILTER_BILINEAR);
+    }
+}
+
+UIFont *load_ui_font_dynamic(const char *file_name, int base_size, UIFontMode mode)
+{
+    UIFont *font = malloc(sizeof(UIFont));
+    bzero(font, sizeof(UIFont));
+
+    font->file_data = LoadFileData(file_name, &font->file_size);
+    assert(font->file_data != NULL && "Couldn't load the font file");
+
+    font->dynamic = true;
+    font->mode = mode;
+    font->font.baseSize = base_size;
+    font->font.glyphPadding = FONT_GLYPH_PADDING;
+    font->cell_size = base_size * 3 / 2 + 2*FONT_GLYPH_PADDING;
+    ilist_init(&font->lru);
+
+    font->atlas = GenImageColor(FONT_ATLAS_WIDTH, FONT_ATLAS_INIT_HEIGHT, BLANK);
+    ImageFormat(&font->atlas, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+    font->slots = malloc(get_cell_count(font, FONT_ATLAS_MAX_HEIGHT)*sizeof(GlyphSlot));
+    assert(font->slots != NULL && "No enough ram");
+    resize_slots(font, font->atlas.height);
+
+    font->bmp = malloc(FONT_BMP_SIZE*sizeof(int));
+    font->bmp_size = FONT_BMP_SIZE;
+    assert(font->bmp != NULL && "No enough ram");
+    for(int i = 0; i < FONT_BMP_SIZE; i++) {
+        font->bmp[i] = -1;
+    }
+
+    // the first glyph is '?', it's used when there's no room for new glyphs. Fonts
+    // without it fall back to an empty glyph in the first cell
+    font->fallback = 0;
+    load_glyph(font, '?');
+    if(font->font.glyphCount == 0) {
+        get_free_slot(font);
+        font->font.glyphs[0] = (GlyphInfo) {.value = '?', .advanceX = base_size / 2};
+        font->font.recs[0] = (Rectangle) {FONT_GLYPH_PADDING, FONT_GLYPH_PADDING, 0, 0};
+        font->slots[0].codepoint = '?';
+        set_glyph_index(font, '?', 0);
+    }
+
+    load_atlas_texture(font);
+    if(mode == UI_FONT_SDF) {
+        font->sdf_shader = LoadShaderFromMemory(NULL, sdf_fragment_shader);
+    }
+
+    font->dirty_top = font->atlas.height;
+    font->dirty_bottom = 0;
+
+    da_append(&dynamic_fonts, font);
+
+    return font;
+}
+
+UIFont *load_ui_font_baked(const BakedFont *baked)
+{
+    UIFont *font = malloc(sizeof(UIFont));
+    bzero(font, sizeof(UIFont));
+
+    Image atlas = {
+        .data = (void *)baked->pixels,
+        .width = baked->atlas_width,
+        .height = baked->atlas_height,
+        .mipmaps = 1,
+        .format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA,
+    };
+
+    font->baked = baked;
+    font->font = (Font) {
+        .baseSize = baked->base_size,
+        .glyphCount = baked->glyph_count,
+        .glyphPadding = baked->glyph_padding,
+        .texture = LoadTextureFromImage(atlas),
+        .recs = baked->recs,
+        .glyphs = baked->glyphs,
+    };
+
+    // the table is used in place, it's never written for non dynamic fonts
+    font->bmp = (int *)baked->bmp;
+    font->bmp_size = baked->bmp_size;
+    font->fallback = baked->fallback;
+
+    for(int i = 0; i < baked->astral_count; i++) {
+        GlyphMap_put(&font->astral, baked->astral[i*2], baked->astral[i*2 + 1]);
+    }
+
+    return font;
+}
+
+static void flush_font(UIFont *font)
+{
+    bool is_dirty = font->dirty_top < font->dirty_bottom;
+
+    // the recorded glyph commands point to font.texture, so they are drawn with
+    // the new texture even if they were recorded before it was recreated
+
+    // text that was drawn with missing glyphs has to be repainted
+    if(font->atlas_grown || is_dirty) render_damage_all();
+
+    if(font->atlas_grown) {
+        UnloadTexture(font->font.texture);
+        load_atlas_texture(font);
+        font->atlas_grown = false;
+    } else if(is_dirty) {
+        // the dirty rows are contiguous in the image so they are uploaded at once
+        Rectangle rows = {
+            0, font->dirty_top, FONT_ATLAS_WIDTH, font->dirty_bottom - font->dirty_top
+        };
+        unsigned char *pixels = font->atlas.data;
+        UpdateTextureRec(font->font.texture, rows, pixels + font->dirty_top*FONT_ATLAS_WIDTH*2);
+    }
+
+    font->dirty_top = font->atlas.height;
+    font->dirty_bottom = 0;
+    font->epoch++;
+
+    // the glyphs of this frame can be evicted now, so the codepoints that fell back
+    // get a slot on their next lookup and the widths measured with the fallback go stale
+    for(size_t i = 0; i < font->deferred.count; i++) {
+        set_glyph_index(font, font->deferred.items[i], -1);
+    }
+    if(font->deferred.count > 0) {
+        font->glyphs_version++;
+        font->widths_version++;
+    }
+    font->deferred.count = 0;
+}
+
+void ui_font_flush_all(void)
+{
+    for(size_t i = 0; i < dynamic_fonts.count; i++) flush_font(dynamic_fonts.items[i]);
+}
+
+void destroy_ui_font(UIFont *font)
+{
+    if(font->dynamic) {
+        for(size_t i = 0; i < dynamic_fonts.count; i++) {
+            if(dynamic_fonts.items[i] == font) {
+                dynamic_fonts.items[i] = dynamic_fonts.items[--dynamic_fonts.count];
+                break;
+            }
+        }
+
+        if(font->mode == UI_FONT_SDF) UnloadShader(font->sdf_shader);
+        UnloadTexture(font->font.texture);
+        UnloadImage(font->atlas);
+        UnloadFileData(font->file_data);
+        free(font->font.glyphs);
+        free(font->font.recs);
+        free(font->slots);
+        da_free(&font->deferred);
+    }
+
+    if(font->baked != NULL) {
+        UnloadTexture(font->font.texture);
+    } else {
+        free(font->bmp);
+    }
+
+    GlyphMap_free(&font->astral);
+    free(font);
+}
+
+// moves the glyph of a dynamic font to the front of the lru list at most once per upload
+static void touch_glyph(UIFont *font, int index)
+{
+    GlyphSlot *slot = &font->slots[index];
+    if(slot->epoch != font->epoch && index != font->fallback) {
+        ilist_remove(&font->lru, &slot->lru);
+        ilist_push_front(&font->lru, &slot->lru);
+        slot->epoch = font->epoch;
+    }
+}
+
+int ui_font_glyph_index(UIFont *font, int codepoint)
+{
+    int index;
+
+    if(codepoint >= 0 && codepoint < font->bmp_size) {
+        index = font->bmp[codepoint];
+    } else {
+        int *value = GlyphMap_get(&font->astral, codepoint);
+        index = value == NULL ? -1 : *value;
+    }
+
+    if(!font->dynamic) {
+        return index < 0 ? font->fallback : index;
+    }
+
+    if(index < 0) {
+        return load_glyph(font, codepoint);
+    }
+
+    touch_glyph(font, index);
+    return index;
+}
+
+float ui_font_glyph_advance(UIFont *font, int index, float font_size)
+{
+    float scale = font_size / font->font.baseSize;
+    GlyphInfo *glyph = &font->font.glyphs[index];
+
+    if(glyph->advanceX > 0) {
+        return glyph->advanceX * scale;
+    }
+
+    return (font->font.recs[index].width + glyph->offsetX) * scale;
+}
+
+Vector2 ui_font_measure(UIFont *font, const char *text, size_t size, float font_size, float spacing)
+{
+    float width = 0;
+    size_t chr_count = 0;
+
+    for(size_t i = 0; i < size;) {
+        int codepoint_size;
+        int codepoint = utf8_decode(text + i, size - i, &codepoint_size);
+        i += codepoint_size;
+
+        width += ui_font_glyph_advance(font, ui_font_glyph_index(font, codepoint), font_size);
+        chr_count++;
+    }
+
+    if(chr_count == 0) return (Vector2) {0, 0};
+
+    return (Vector2) {
+        .x = width + (chr_count - 1) * spacing,
+        .y = font_size,
+    };
+}
+
+// same as DrawTextCodepoint but with the glyph index already known
+static void draw_glyph(UIFont *font, int index, Vector2 pos, float font_size, Color color)
+{
+    Font *f = &font->font;
+    float scale = font_size / f->baseSize;
+    float padding = f->glyphPadding;
+    Rectangle rec = f->recs[index];
+
+    Rectangle src = {
+        rec.x - padding,
+        rec.y - padding,
+        rec.width + 2*padding,
+        rec.height + 2*padding,
+    };
+    Rectangle dst = {
+        pos.x + (f->glyphs[index].offsetX - padding) * scale,
+        pos.y + (f->glyphs[index].offsetY - padding) * scale,
+        src.width * scale,
+        src.height * scale,
+    };
+
+    render_texture(&f->texture, src, dst, color);
+}
+
+void ui_font_draw(
+    UIFont *font,
+    const char *text,
+    size_t size,
+    Vector2 pos,
+    float font_size,
+    float spacing,
+    Color color
+)
+{
+    float offset = 0;
+
+    if(font->mode == UI_FONT_SDF) render_set_shader(font->sdf_shader);
+
+    for(size_t i = 0; i < size;) {
+        int codepoint_size;
+        int codepoint = utf8_decode(text + i, size - i, &codepoint_size);
+        i += codepoint_size;
+
+        int index = ui_font_glyph_index(font, codepoint);
+
+        if(codepoint != ' ' && codepoint != '\t') {
+            draw_glyph(font, index, (Vector2) {pos.x + offset, pos.y}, font_size, color);
+        }
+
+        offset += ui_font_glyph_advance(font, index, font_size) + spacing;
+    }
+
+    if(font->mode == UI_FONT_SDF) render_clear_shader();
+}
+
+void ui_font_shape(
+    UIFont *font, const char *text, size_t size, float font_size, float spacing, GlyphRun *run
+)
+{
+    // a glyph loaded by the shaping can evict one loaded before it, then the run
+    // is shaped again the next time
+    run->glyphs_version = font->glyphs_version;
+    run->count = 0;
+    run->font_size = font_size;
+
+    float offset = 0;
+    for(size_t i = 0; i < size;) {
+        int codepoint_size;
+        int codepoint = utf8_decode(text + i, size - i, &codepoint_size);
+        i += codepoint_size;
+
+        int index = ui_font_glyph_index(font, codepoint);
+        if(codepoint != ' ' && codepoint != '\t') {
+            da_append(run, ((RunGlyph) {index, offset}));
+        }
+
+        offset += ui_font_glyph_advance(font, index, font_size) + spacing;
+    }
+}
+
+bool ui_font_run_is_valid(UIFont *font, GlyphRun *run)
+{
+    return run->glyphs_version == font->glyphs_version;
+}
+
+void ui_font_draw_run(UIFont *font, GlyphRun *run, Vector2 pos, Color color)
+{
+    if(font->mode == UI_FONT_SDF) render_set_shader(font->sdf_shader);
+
+    for(size_t i = 0; i < run->count; i++) {
+        RunGlyph glyph = run->items[i];
+        // the glyphs drawn from runs are still in use for the lru
+        if(font->dynamic) touch_glyph(font, glyph.index);
+        draw_glyph(font, glyph.index, (Vector2) {pos.x + glyph.x, pos.y}, run->font_size, color);
+    }
+
+    if(font->mode == UI_FONT_SDF) render_clear_shader();
+}
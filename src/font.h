@@ -0,0 +1,146 @@
+#ifndef FONT_H
+#define FONT_H
+
+#include "cTooling.h"
+#include "raylib.h"
+
+// number of codepoints in the basic multilingual plane
+#define FONT_BMP_SIZE 0x10000
+
+// atlas of dynamic fonts, it starts small and its height is doubled when full
+#define FONT_ATLAS_WIDTH 1024
+#define FONT_ATLAS_INIT_HEIGHT 128
+#define FONT_ATLAS_MAX_HEIGHT 4096
+#define FONT_GLYPH_PADDING 2
+
+HASHMAP_DECLARE(GlyphMap, int, int)
+
+typedef enum {
+    UI_FONT_BITMAP,
+    // the atlas stores signed distance fields drawn with a shader, so a single
+    // atlas looks sharp at every font size
+    UI_FONT_SDF,
+} UIFontMode;
+
+// cell of the atlas of a dynamic font, the glyph in the cell has the same index
+// in font.glyphs and font.recs
+typedef struct {
+    IListNode lru;
+    int codepoint;
+    unsigned int epoch; // last frame in which the glyph was used
+} GlyphSlot;
+
+typedef struct {
+    int *items;
+    size_t count;
+    size_t capacity;
+} FontCodepoints;
+
+// Font generated at build time by tools/bake_font.c, everything is already in the
+// layout used at runtime so loading it is a texture upload
+typedef struct {
+    int base_size;
+    int glyph_padding;
+    int glyph_count;
+    GlyphInfo *glyphs;
+    Rectangle *recs;
+    int atlas_width;
+    int atlas_height;
+    const unsigned char *pixels; // gray+alpha
+    const int *bmp;              // glyph index of the codepoints below "bmp_size"
+    int bmp_size;
+    const int *astral;           // codepoint and glyph index pairs above the BMP
+    int astral_count;
+    int fallback;
+} BakedFont;
+
+// Wraps a raylib Font with a codepoint to glyph index table, so finding a glyph
+// is a single array access instead of the linear search done by GetGlyphIndex
+typedef struct {
+    Font font;
+    int *bmp;         // glyph index of every codepoint in the basic multilingual plane
+    int bmp_size;     // baked fonts only have the table up to their last codepoint
+    GlyphMap astral;  // glyph index of the codepoints above the BMP
+    int fallback;     // glyph used for codepoints that are not in the font ('?')
+    const BakedFont *baked;
+
+    // dynamic fonts rasterize a glyph the first time it's looked up, the rest
+    // of the fields are only used by them
+    bool dynamic;
+    UIFontMode mode;
+    Shader sdf_shader;
+    unsigned char *file_data;
+    int file_size;
+    Image atlas;        // CPU copy of the texture, glyphs are rasterized here first
+    int cell_size;      // every glyph takes a square cell of the atlas
+    GlyphSlot *slots;   // one per cell
+    int slot_capacity;
+    IList lru;          // used slots, the least recently used is the last one
+    unsigned int epoch; // incremented once per frame by ui_font_flush_all
+    // incremented when a codepoint changes glyph index, when a glyph is evicted and
+    // its index reused or when a codepoint that fell back gets its glyph
+    unsigned int glyphs_version;
+    // incremented when a codepoint that fell back gets its glyph, the widths
+    // measured before are stale
+    unsigned int widths_version;
+    FontCodepoints deferred; // fell back in this frame since every slot was in use
+    int dirty_top;      // rows of the atlas that have to be uploaded
+    int dirty_bottom;
+    bool atlas_grown;   // the texture has to be recreated with the new size
+} UIFont;
+
+// glyph of a GlyphRun and its x from the start of the run
+typedef struct {
+    int index;
+    float x;
+} RunGlyph;
+
+// Text laid out once with ui_font_shape, drawing it again skips the UTF-8 decoding
+// and the glyph lookups. Spaces are not drawn so they are left out. A dynamic font
+// can change the glyph of a codepoint, the runs shaped before have to be shaped
+// again
+typedef struct {
+    RunGlyph *items;
+    size_t count;
+    size_t capacity;
+    float font_size;
+    unsigned int glyphs_version; // glyphs version of the font when it was shaped
+} GlyphRun;
+
+UIFont *create_ui_font(Font font);
+// loads a font whose glyphs are rasterized on demand into a growable atlas, the
+// least recently used glyphs are evicted when the atlas can't grow anymore
+UIFont *load_ui_font_dynamic(const char *file_name, int base_size, UIFontMode mode);
+UIFont *load_ui_font_baked(const BakedFont *baked);
+// frees the lookup tables, the raylib font is only unloaded if it's dynamic
+void destroy_ui_font(UIFont *font);
+// uploads the glyphs of every dynamic font rasterized since the last call to their
+// textures. render_end_frame calls it once per frame before submitting the commands,
+// so the glyphs recorded by any widget of the frame can't be evicted until then
+void ui_font_flush_all(void);
+
+int ui_font_glyph_index(UIFont *font, int codepoint);
+// horizontal advance of the glyph at "index" scaled to "font_size"
+float ui_font_glyph_advance(UIFont *font, int index, float font_size);
+
+// same as MeasureTextEx and DrawTextEx but "text" doesn't have to be null terminated
+Vector2 ui_font_measure(UIFont *font, const char *text, size_t size, float font_size, float spacing);
+void ui_font_draw(
+    UIFont *font,
+    const char *text,
+    size_t size,
+    Vector2 pos,
+    float font_size,
+    float spacing,
+    Color color
+);
+
+void ui_font_shape(
+    UIFont *font, const char *text, size_t size, float font_size, float spacing, GlyphRun *run
+);
+// false when the run has to be shaped again
+bool ui_font_run_is_valid(UIFont *font, GlyphRun *run);
+// draws the run at the font size it was shaped with
+void ui_font_draw_run(UIFont *font, GlyphRun *run, Vector2 pos, Color color);
+
+#endif // FONT_H
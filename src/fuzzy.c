@@ -0,0 +1,391 @@
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "fuzzy.h"
+
+#define FUZZY_SCORE_MATCH 16       // every matched char
+#define FUZZY_BONUS_BOUNDARY 8     // the matched char starts a word
+#define FUZZY_BONUS_CONSECUTIVE 4  // the matched char follows the last one
+#define FUZZY_PENALTY_GAP 1        // every skipped char between the first and last match
+
+static char to_lower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c + 'a' - 'A' : c;
+}
+
+// letters (of any case) and digits have a bit each, the other bytes share the rest
+static int get_chr_bit(unsigned char c)
+{
+    c = to_lower(c);
+    if(c >= 'a' && c <= 'z') return c - 'a';
+    if(c >= '0' && c <= '9') return 26 + c - '0';
+    return 36 + c % 28;
+}
+
+static uint64_t get_mask(const char *text, size_t size)
+{
+    uint64_t mask = 0;
+    for(size_t i = 0; i < size; i++) mask |= (uint64_t)1 << get_chr_bit(text[i]);
+    return mask;
+}
+
+static bool is_word_start(const char *text, size_t i)
+{
+    if(i == 0) return true;
+
+    char prev = text[i - 1];
+    if(prev == ' ' || prev == '/' || prev == '\\' || prev == '_' || prev == '-' || prev == '.') {
+        return true;
+    }
+
+    // camelCase
+    return prev >= 'a' && prev <= 'z' && text[i] >= 'A' && text[i] <= 'Z';
+}
+
+int fuzzy_score(const char *query, size_t query_size, const char *text, size_t size)
+{
+    if(query_size == 0) return 0;
+
+    // the first match from the left ends the window
+    size_t q = 0;
+    size_t end = 0;
+    for(size_t i = 0; i < size; i++) {
+        if(to_lower(text[i]) != query[q]) continue;
+        if(++q == query_size) {
+            end = i + 1;
+            break;
+        }
+    }
+    if(q < query_size) return -1;
+
+    // and the match from the right, back from there, starts it, so it's the
+    // shortest window ending at "end"
+    size_t start = end;
+    while(q > 0) {
+        start--;
+        if(to_lower(text[start]) == query[q - 1]) q--;
+    }
+
+    int score = 0;
+    bool consecutive = false;
+    for(size_t i = start; i < end; i++) {
+        if(q == query_size || to_lower(text[i]) != query[q]) {
+            score -= FUZZY_PENALTY_GAP;
+            consecutive = false;
+            continue;
+        }
+
+        score += FUZZY_SCORE_MATCH;
+        if(is_word_start(text, i)) score += FUZZY_BONUS_BOUNDARY;
+        if(consecutive) score += FUZZY_BONUS_CONSECUTIVE;
+        consecutive = true;
+        q++;
+    }
+
+    return score < 0 ? 0 : score;
+}
+
+// bigger is better, on ties the candidate that comes first
+static uint64_t get_rank(FuzzyMatch match)
+{
+    return (uint64_t)(uint32_t)match.score << 32 | (UINT32_MAX - match.index);
+}
+
+static int compare_matches(const void *a, const void *b)
+{
+    uint64_t rank_a = get_rank(*(const FuzzyMatch *)a);
+    uint64_t rank_b = get_rank(*(const FuzzyMatch *)b);
+    return rank_a < rank_b ? 1 : rank_a > rank_b ? -1 : 0;
+}
+
+// sorts the matches and keeps the best ones, returns the rank a match needs to
+// beat to get in, 0 while there is room for more
+static uint64_t keep_best(FuzzyMatches *matches)
+{
+    qsort(matches->items, matches->count, sizeof(FuzzyMatch), compare_matches);
+    if(matches->count < FUZZY_MAX_RESULTS) return 0;
+
+    matches->count = FUZZY_MAX_RESULTS;
+    return get_rank(matches->items[FUZZY_MAX_RESULTS - 1]);
+}
+
+// writes the candidates whose masks have all the bits of the query to "passed",
+// returns how many
+static size_t prefilter(const uint64_t *masks, size_t count, uint64_t query_mask, uint32_t *passed)
+{
+    size_t passed_count = 0;
+    size_t i = 0;
+
+#ifdef __SSE2__
+    // two masks per compare, SSE2 compares 32 bit lanes so a mask passes when both
+    // of its halves do
+    __m128i query = _mm_set1_epi64x(query_mask);
+    for(; i + 2 <= count; i += 2) {
+        __m128i pair = _mm_loadu_si128((const __m128i *)(masks + i));
+        int equal = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pair, query), query));
+        if((equal & 0x00FF) == 0x00FF) passed[passed_count++] = i;
+        if((equal & 0xFF00) == 0xFF00) passed[passed_count++] = i + 1;
+    }
+#endif
+
+    for(; i < count; i++) {
+        if((masks[i] & query_mask) == query_mask) passed[passed_count++] = i;
+    }
+
+    return passed_count;
+}
+
+// next chunk of the query "generation", false when they were all claimed or the
+// query was cancelled
+static bool claim_chunk(FuzzyMatcher *matcher, unsigned int generation, size_t *chunk)
+{
+    uint64_t cursor = atomic_load(&matcher->cursor);
+    while(true) {
+        if(cursor >> 32 != generation) return false;
+        if((cursor & UINT32_MAX) >= matcher->chunk_count) return false;
+
+        if(atomic_compare_exchange_weak(&matcher->cursor, &cursor, cursor + 1)) {
+            *chunk = cursor & UINT32_MAX;
+            return true;
+        }
+    }
+}
+
+// state of a worker for the query it's running
+typedef struct {
+    unsigned int generation;
+    String query; // lowercase
+    uint64_t query_mask;
+    uint32_t *passed;
+    FuzzyMatches matches; // best matches of the chunk
+    FuzzyMatches merged;
+    uint64_t cutoff;      // rank of the worst shared result when they are full
+    size_t matched;
+} FuzzyWorker;
+
+static void score_chunk(FuzzyMatcher *matcher, FuzzyWorker *worker, size_t chunk)
+{
+    size_t first = chunk * FUZZY_CHUNK_SIZE;
+    size_t count = matcher->count - first;
+    if(count > FUZZY_CHUNK_SIZE) count = FUZZY_CHUNK_SIZE;
+
+    size_t passed = prefilter(matcher->masks + first, count, worker->query_mask, worker->passed);
+
+    FuzzyMatches *matches = &worker->matches;
+    matches->count = 0;
+    worker->matched = 0;
+    uint64_t cutoff = worker->cutoff;
+
+    for(size_t i = 0; i < passed; i++) {
+        uint32_t index = first + worker->passed[i];
+        const char *text = matcher->candidates[index];
+        String *query = &worker->query;
+        int score = fuzzy_score(query->items, query->count, text, matcher->lengths[index]);
+        if(score < 0) continue;
+
+        worker->matched++;
+        FuzzyMatch match = {index, score};
+        if(cutoff != 0 && get_rank(match) <= cutoff) continue;
+
+        da_append(matches, match);
+        if(matches->count == 2*FUZZY_MAX_RESULTS) {
+            uint64_t kept = keep_best(matches);
+            if(kept > cutoff) cutoff = kept;
+        }
+    }
+
+    keep_best(matches);
+}
+
+// merges the best matches of the chunk into the shared results, they are dropped
+// when a newer query was submitted in the meantime
+static void publish_chunk(FuzzyMatcher *matcher, FuzzyWorker *worker)
+{
+    FuzzyMatches *matches = &worker->matches;
+    FuzzyMatches *merged = &worker->merged;
+
+    pthread_mutex_lock(&matcher->results_lock);
+    if(atomic_load(&matcher->generation) != worker->generation) {
+        pthread_mutex_unlock(&matcher->results_lock);
+        return;
+    }
+
+    // the results of the last query are shown until the first chunk of this one
+    FuzzyMatches *results = &matcher->results;
+    if(matcher->results_generation != worker->generation) {
+        matcher->results_generation = worker->generation;
+        results->count = 0;
+        matcher->matched = 0;
+        matcher->scored_chunks = 0;
+    }
+
+    merged->count = 0;
+    da_reserve(merged, FUZZY_MAX_RESULTS);
+    size_t a = 0, b = 0;
+    while(merged->count < FUZZY_MAX_RESULTS && (a < results->count || b < matches->count)) {
+        bool take_a = b == matches->count ||
+            (a < results->count && get_rank(results->items[a]) > get_rank(matches->items[b]));
+        merged->items[merged->count++] = take_a ? results->items[a++] : matches->items[b++];
+    }
+
+    results->count = 0;
+    da_append_many(results, merged->items, merged->count);
+    matcher->matched += worker->matched;
+    matcher->scored_chunks++;
+    matcher->results_version++;
+
+    if(results->count == FUZZY_MAX_RESULTS) {
+        worker->cutoff = get_rank(results->items[FUZZY_MAX_RESULTS - 1]);
+    }
+
+    pthread_mutex_unlock(&matcher->results_lock);
+}
+
+static void *run_worker(void *arg)
+{
+    FuzzyMatcher *matcher = arg;
+    FuzzyWorker worker = {0};
+    da_reserve(&worker.query, DA_INIT_CAP);
+    da_reserve(&worker.matches, 2*FUZZY_MAX_RESULTS);
+    worker.passed = malloc(FUZZY_CHUNK_SIZE*sizeof(uint32_t));
+    assert(worker.passed != NULL && "No enough ram");
+
+    pthread_mutex_lock(&matcher->lock);
+    while(true) {
+        while(!matcher->quit && atomic_load(&matcher->generation) == worker.generation) {
+            pthread_cond_wait(&matcher->wake, &matcher->lock);
+        }
+        if(matcher->quit) break;
+
+        worker.generation = atomic_load(&matcher->generation);
+        worker.query.count = 0;
+        da_append_many(&worker.query, matcher->query.items, matcher->query.count);
+        pthread_mutex_unlock(&matcher->lock);
+
+        worker.query_mask = get_mask(worker.query.items, worker.query.count);
+        worker.cutoff = 0;
+
+        size_t chunk;
+        while(claim_chunk(matcher, worker.generation, &chunk)) {
+            score_chunk(matcher, &worker, chunk);
+            publish_chunk(matcher, &worker);
+        }
+
+        pthread_mutex_lock(&matcher->lock);
+    }
+    pthread_mutex_unlock(&matcher->lock);
+
+    free(worker.passed);
+    string_free(&worker.query);
+    da_free(&worker.matches);
+    da_free(&worker.merged);
+    return NULL;
+}
+
+FuzzyMatcher *fuzzy_matcher_create(const char **candidates, size_t count, size_t thread_count)
+{
+    assert(count <= UINT32_MAX && "Too many candidates");
+
+    FuzzyMatcher *matcher = malloc(sizeof(FuzzyMatcher));
+    assert(matcher != NULL && "No enough ram");
+    bzero(matcher, sizeof(FuzzyMatcher));
+
+    matcher->candidates = candidates;
+    matcher->count = count;
+    matcher->chunk_count = (count + FUZZY_CHUNK_SIZE - 1) / FUZZY_CHUNK_SIZE;
+    matcher->masks = malloc(count*sizeof(uint64_t));
+    matcher->lengths = malloc(count*sizeof(uint32_t));
+    assert(((matcher->masks != NULL && matcher->lengths != NULL) || count == 0) && "No enough ram");
+
+    for(size_t i = 0; i < count; i++) {
+        size_t length = strlen(candidates[i]);
+        matcher->lengths[i] = length;
+        matcher->masks[i] = get_mask(candidates[i], length);
+    }
+
+    if(thread_count == 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = cores > 0 ? cores : 1;
+    }
+
+    da_reserve(&matcher->results, FUZZY_MAX_RESULTS);
+
+    pthread_mutex_init(&matcher->lock, NULL);
+    pthread_mutex_init(&matcher->results_lock, NULL);
+    pthread_cond_init(&matcher->wake, NULL);
+
+    matcher->threads = malloc(thread_count*sizeof(pthread_t));
+    assert(matcher->threads != NULL && "No enough ram");
+    matcher->thread_count = thread_count;
+    for(size_t i = 0; i < thread_count; i++) {
+        pthread_create(&matcher->threads[i], NULL, run_worker, matcher);
+    }
+
+    return matcher;
+}
+
+void fuzzy_matcher_destroy(FuzzyMatcher *matcher)
+{
+    pthread_mutex_lock(&matcher->lock);
+    matcher->quit = true;
+    pthread_cond_broadcast(&matcher->wake);
+    pthread_mutex_unlock(&matcher->lock);
+
+    for(size_t i = 0; i < matcher->thread_count; i++) {
+        pthread_join(matcher->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&matcher->lock);
+    pthread_mutex_destroy(&matcher->results_lock);
+    pthread_cond_destroy(&matcher->wake);
+
+    free(matcher->threads);
+    free(matcher->masks);
+    free(matcher->lengths);
+    string_free(&matcher->query);
+    da_free(&matcher->results);
+    free(matcher);
+}
+
+unsigned int fuzzy_matcher_submit(FuzzyMatcher *matcher, const char *query, size_t size)
+{
+    pthread_mutex_lock(&matcher->lock);
+
+    // reserved so the workers never copy from a NULL query
+    matcher->query.count = 0;
+    da_reserve(&matcher->query, size + 1);
+    for(size_t i = 0; i < size; i++) da_append(&matcher->query, to_lower(query[i]));
+
+    // the workers of the last query fail to claim the next chunk and drop the one
+    // they are scoring
+    unsigned int generation = atomic_load(&matcher->generation) + 1;
+    atomic_store(&matcher->generation, generation);
+    atomic_store(&matcher->cursor, (uint64_t)generation << 32);
+
+    pthread_cond_broadcast(&matcher->wake);
+    pthread_mutex_unlock(&matcher->lock);
+
+    return generation;
+}
+
+bool fuzzy_matcher_poll(FuzzyMatcher *matcher, FuzzySnapshot *snapshot)
+{
+    if(pthread_mutex_trylock(&matcher->results_lock) != 0) return false;
+
+    bool changed = matcher->results_version != snapshot->version;
+    if(changed) {
+        FuzzyMatches *matches = &snapshot->matches;
+        matches->count = 0;
+        da_reserve(matches, FUZZY_MAX_RESULTS);
+        da_append_many(matches, matcher->results.items, matcher->results.count);
+        snapshot->generation = matcher->results_generation;
+        snapshot->version = matcher->results_version;
+        snapshot->matched = matcher->matched;
+        snapshot->done = matcher->scored_chunks == matcher->chunk_count;
+    }
+
+    pthread_mutex_unlock(&matcher->results_lock);
+    return changed;
+}
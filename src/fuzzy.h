@@ -0,0 +1,75 @@
+#ifndef FUZZY_H
+#define FUZZY_H
+
+#include <pthread.h>
+
+#include "cTooling.h"
+
+#define FUZZY_MAX_RESULTS 1000
+#define FUZZY_CHUNK_SIZE 16384 // candidates claimed at once by a worker
+
+typedef struct {
+    uint32_t index;
+    int32_t score;
+} FuzzyMatch;
+
+typedef struct {
+    FuzzyMatch *items; // best score first
+    size_t count;
+    size_t capacity;
+} FuzzyMatches;
+
+// copy of the results owned by the UI thread
+typedef struct {
+    FuzzyMatches matches;
+    unsigned int generation; // query the matches are for
+    unsigned int version;    // incremented every time a worker publishes matches
+    size_t matched;          // candidates matched so far, not only the best ones
+    bool done;               // all the candidates were scored
+} FuzzySnapshot;
+
+// Fuzzy matcher that scores the candidates on a pool of threads. The candidates
+// are split in chunks that the workers claim from a shared cursor, so a worker
+// that finishes early takes the chunks left by the slower ones. Every chunk is
+// prefiltered with masks of the chars in the candidates and the best matches of
+// every chunk are merged into the shared results as soon as they are scored.
+// Submitting a query cancels the one in flight, the cursor has the generation of
+// the query in its high bits so a worker can't claim a chunk of another query
+typedef struct {
+    const char **candidates;
+    size_t count;
+    uint64_t *masks;   // chars in every candidate, see get_chr_bit
+    uint32_t *lengths;
+    size_t chunk_count;
+
+    pthread_t *threads;
+    size_t thread_count;
+    pthread_mutex_t lock; // protects the query and wakes the workers
+    pthread_cond_t wake;
+    String query;
+    bool quit;
+    atomic_uint generation;
+    _Atomic uint64_t cursor; // generation << 32 | next chunk
+
+    pthread_mutex_t results_lock;
+    FuzzyMatches results;
+    unsigned int results_generation;
+    unsigned int results_version;
+    size_t matched;
+    size_t scored_chunks;
+} FuzzyMatcher;
+
+// the candidates are borrowed, "thread_count" 0 uses one thread per core
+FuzzyMatcher *fuzzy_matcher_create(const char **candidates, size_t count, size_t thread_count);
+void fuzzy_matcher_destroy(FuzzyMatcher *matcher);
+// starts matching "query", returns its generation
+unsigned int fuzzy_matcher_submit(FuzzyMatcher *matcher, const char *query, size_t size);
+// copies the results into the snapshot if they changed, it never waits for the
+// workers, when they hold the lock it returns false and the old snapshot is kept
+bool fuzzy_matcher_poll(FuzzyMatcher *matcher, FuzzySnapshot *snapshot);
+
+// score of "text" for the lowercase "query", -1 when it doesn't contain the query
+// chars in order
+int fuzzy_score(const char *query, size_t query_size, const char *text, size_t size);
+
+#endif // FUZZY_H
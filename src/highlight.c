@@ -0,0 +1,497 @@
+#include <ctype.h>
+
+#include "highlight.h"
+#include "input.h"
+
+HASHMAP_DEFINE(LexerKeywords, const char *, bool, hash_cstr, hashmap_cstr_eq)
+
+static const Color default_colors[HIGHLIGHT_KIND_COUNT] = {
+    [HIGHLIGHT_KEYWORD] = {198, 160, 246, 255},
+    [HIGHLIGHT_STRING] = {166, 218, 149, 255},
+    [HIGHLIGHT_NUMBER] = {245, 169, 127, 255},
+    [HIGHLIGHT_COMMENT] = {128, 135, 162, 255},
+    [HIGHLIGHT_OPERATOR] = {145, 215, 227, 255},
+};
+
+Lexer *create_lexer(bool ignore_case)
+{
+    Lexer *lexer = malloc(sizeof(Lexer));
+    assert(lexer != NULL && "No enough ram");
+    bzero(lexer, sizeof(Lexer));
+
+    lexer->ignore_case = ignore_case;
+    // state 0 ends the tokens, it has no table
+    lexer->state_count = 1;
+    lexer_add_state(lexer, HIGHLIGHT_TEXT);
+    lexer_add_state(lexer, HIGHLIGHT_TEXT);
+    lexer_add_rule(lexer, LEXER_START, NULL, LEXER_OTHER);
+
+    return lexer;
+}
+
+void destroy_lexer(Lexer *lexer)
+{
+    LexerKeywords *keywords = &lexer->keywords;
+    for(size_t i = 0; i < keywords->capacity; i++) {
+        if(keywords->slots[i].dist != 0) free((char *)keywords->slots[i].key);
+    }
+
+    LexerKeywords_free(keywords);
+    free(lexer);
+}
+
+uint8_t lexer_add_state(Lexer *lexer, HighlightKind kind)
+{
+    assert(lexer->state_count < LEXER_MAX_STATES && "Too many lexer states");
+
+    lexer->kinds[lexer->state_count] = kind;
+    return lexer->state_count++;
+}
+
+void lexer_add_rule(Lexer *lexer, uint8_t from, const char *bytes, uint8_t to)
+{
+    uint8_t *next = lexer->next[from];
+    if(bytes == NULL) {
+        memset(next, to, sizeof(lexer->next[from]));
+        return;
+    }
+
+    const unsigned char *b = (const unsigned char *)bytes;
+    for(size_t i = 0; b[i] != '\0'; i++) {
+        if(b[i + 1] == '-' && b[i + 2] != '\0') {
+            for(int c = b[i]; c <= b[i + 2]; c++) next[c] = to;
+            i += 2;
+        } else {
+            next[b[i]] = to;
+        }
+    }
+}
+
+void lexer_add_keyword(Lexer *lexer, const char *word)
+{
+    size_t size = strlen(word);
+    assert(size <= LEXER_MAX_KEYWORD && "The keyword is too long");
+
+    char *key = malloc(size + 1);
+    assert(key != NULL && "No enough ram");
+    for(size_t i = 0; i <= size; i++) {
+        key[i] = lexer->ignore_case ? tolower((unsigned char)word[i]) : word[i];
+    }
+
+    if(LexerKeywords_get(&lexer->keywords, key) != NULL) {
+        free(key);
+        return;
+    }
+    LexerKeywords_put(&lexer->keywords, key, true);
+}
+
+static void add_keywords(Lexer *lexer, const char **words, size_t count)
+{
+    for(size_t i = 0; i < count; i++) lexer_add_keyword(lexer, words[i]);
+}
+
+Lexer *create_sql_lexer(void)
+{
+    Lexer *lexer = create_lexer(true);
+
+    uint8_t space = lexer_add_state(lexer, HIGHLIGHT_TEXT);
+    lexer_add_rule(lexer, LEXER_START, " \t\r\n", space);
+    lexer_add_rule(lexer, space, " \t\r\n", space);
+
+    uint8_t word = lexer_add_state(lexer, HIGHLIGHT_IDENTIFIER);
+    lexer_add_rule(lexer, LEXER_START, "a-zA-Z_", word);
+    lexer_add_rule(lexer, word, "a-zA-Z0-9_$", word);
+
+    uint8_t number = lexer_add_state(lexer, HIGHLIGHT_NUMBER);
+    lexer_add_rule(lexer, LEXER_START, "0-9", number);
+    lexer_add_rule(lexer, number, "0-9.eE", number);
+
+    // a quote is escaped by doubling it
+    uint8_t string = lexer_add_state(lexer, HIGHLIGHT_STRING);
+    uint8_t string_quote = lexer_add_state(lexer, HIGHLIGHT_STRING);
+    lexer_add_rule(lexer, LEXER_START, "'", string);
+    lexer_add_rule(lexer, string, NULL, string);
+    lexer_add_rule(lexer, string, "'", string_quote);
+    lexer_add_rule(lexer, string_quote, "'", string);
+
+    // quoted identifiers are never keywords
+    uint8_t name = lexer_add_state(lexer, HIGHLIGHT_TEXT);
+    uint8_t name_quote = lexer_add_state(lexer, HIGHLIGHT_TEXT);
+    lexer_add_rule(lexer, LEXER_START, "\"", name);
+    lexer_add_rule(lexer, name, NULL, name);
+    lexer_add_rule(lexer, name, "\"", name_quote);
+    lexer_add_rule(lexer, name_quote, "\"", name);
+
+    // "-" and "/" start the comments, so they aren't part of the other operators
+    uint8_t operator = lexer_add_state(lexer, HIGHLIGHT_OPERATOR);
+    lexer_add_rule(lexer, LEXER_START, "+*%=<>!|&^~,;().[]:", operator);
+    lexer_add_rule(lexer, operator, "+*%=<>!|&^~,;().[]:", operator);
+
+    uint8_t minus = lexer_add_state(lexer, HIGHLIGHT_OPERATOR);
+    uint8_t line_comment = lexer_add_state(lexer, HIGHLIGHT_COMMENT);
+    lexer_add_rule(lexer, LEXER_START, "-", minus);
+    lexer_add_rule(lexer, minus, "-", line_comment);
+    lexer_add_rule(lexer, line_comment, NULL, line_comment);
+    lexer_add_rule(lexer, line_comment, "\n", 0);
+
+    uint8_t slash = lexer_add_state(lexer, HIGHLIGHT_OPERATOR);
+    uint8_t block_comment = lexer_add_state(lexer, HIGHLIGHT_COMMENT);
+    uint8_t block_star = lexer_add_state(lexer, HIGHLIGHT_COMMENT);
+    uint8_t block_end = lexer_add_state(lexer, HIGHLIGHT_COMMENT);
+    lexer_add_rule(lexer, LEXER_START, "/", slash);
+    lexer_add_rule(lexer, slash, "*", block_comment);
+    lexer_add_rule(lexer, block_comment, NULL, block_comment);
+    lexer_add_rule(lexer, block_comment, "*", block_star);
+    lexer_add_rule(lexer, block_star, NULL, block_comment);
+    lexer_add_rule(lexer, block_star, "*", block_star);
+    lexer_add_rule(lexer, block_star, "/", block_end);
+
+    const char *keywords[] = {
+        "select", "from", "where", "and", "or", "not", "insert", "into", "values",
+        "update", "set", "delete", "create", "drop", "alter", "table", "index", "view",
+        "join", "left", "right", "inner", "outer", "full", "cross", "on", "using",
+        "group", "by", "order", "having", "limit", "offset", "as", "distinct", "all",
+        "union", "intersect", "except", "null", "is", "in", "like", "between", "case",
+        "when", "then", "else", "end", "exists", "asc", "desc", "primary", "key",
+        "foreign", "references", "default", "unique", "check", "constraint", "with",
+        "recursive", "returning", "true", "false", "cast", "begin", "commit",
+        "rollback", "int", "integer", "bigint", "text", "varchar", "boolean", "date",
+        "timestamp", "numeric", "real",
+    };
+    add_keywords(lexer, keywords, sizeof(keywords) / sizeof(*keywords));
+
+    return lexer;
+}
+
+Lexer *create_jsonpath_lexer(void)
+{
+    Lexer *lexer = create_lexer(false);
+
+    uint8_t space = lexer_add_state(lexer, HIGHLIGHT_TEXT);
+    lexer_add_rule(lexer, LEXER_START, " \t\r\n", space);
+    lexer_add_rule(lexer, space, " \t\r\n", space);
+
+    // the root and the current node
+    uint8_t node = lexer_add_state(lexer, HIGHLIGHT_KEYWORD);
+    lexer_add_rule(lexer, LEXER_START, "$@", node);
+
+    uint8_t word = lexer_add_state(lexer, HIGHLIGHT_IDENTIFIER);
+    lexer_add_rule(lexer, LEXER_START, "a-zA-Z_", word);
+    lexer_add_rule(lexer, word, "a-zA-Z0-9_", word);
+
+    uint8_t number = lexer_add_state(lexer, HIGHLIGHT_NUMBER);
+    lexer_add_rule(lexer, LEXER_START, "0-9", number);
+    lexer_add_rule(lexer, number, "0-9.eE", number);
+
+    // both quotes, with backslash escapes
+    const char *quotes[] = {"'", "\""};
+    for(size_t i = 0; i < 2; i++) {
+        uint8_t string = lexer_add_state(lexer, HIGHLIGHT_STRING);
+        uint8_t escape = lexer_add_state(lexer, HIGHLIGHT_STRING);
+        uint8_t string_end = lexer_add_state(lexer, HIGHLIGHT_STRING);
+        lexer_add_rule(lexer, LEXER_START, quotes[i], string);
+        lexer_add_rule(lexer, string, NULL, string);
+        lexer_add_rule(lexer, string, "\\", escape);
+        lexer_add_rule(lexer, string, quotes[i], string_end);
+        lexer_add_rule(lexer, escape, NULL, string);
+    }
+
+    uint8_t operator = lexer_add_state(lexer, HIGHLIGHT_OPERATOR);
+    lexer_add_rule(lexer, LEXER_START, ".[]*?(),:=!<>&|~+/%-", operator);
+    lexer_add_rule(lexer, operator, ".[]*?(),:=!<>&|~+/%-", operator);
+
+    const char *keywords[] = {"true", "false", "null"};
+    add_keywords(lexer, keywords, sizeof(keywords) / sizeof(*keywords));
+
+    return lexer;
+}
+
+void highlighter_init(Highlighter *highlighter, Lexer *lexer)
+{
+    bzero(highlighter, sizeof(Highlighter));
+    highlighter->lexer = lexer;
+    memcpy(highlighter->colors, default_colors, sizeof(default_colors));
+
+    highlighter->resume = (HighlightCheckpoint) {.state = LEXER_START};
+    da_append(&highlighter->checkpoints, highlighter->resume);
+}
+
+void highlighter_free(Highlighter *highlighter)
+{
+    da_free(&highlighter->kinds);
+    da_free(&highlighter->checkpoints);
+}
+
+// index of the first checkpoint after "offset"
+static size_t find_checkpoint(Highlighter *highlighter, size_t offset)
+{
+    HighlightCheckpoints *checkpoints = &highlighter->checkpoints;
+    size_t lo = 0, hi = checkpoints->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(checkpoints->items[mid].offset <= offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void highlighter_edit(Highlighter *highlighter, size_t pos, size_t removed, size_t inserted)
+{
+    HighlightKinds *kinds = &highlighter->kinds;
+    assert(pos + removed <= kinds->count && "The edit is outside of the text");
+
+    size_t edit_end = pos + removed;
+    size_t tail = kinds->count - edit_end;
+    da_reserve(kinds, kinds->count - removed + inserted);
+    if(tail > 0) memmove(kinds->items + pos + inserted, kinds->items + edit_end, tail);
+    if(inserted > 0) memset(kinds->items + pos, HIGHLIGHT_TEXT, inserted);
+    kinds->count = kinds->count - removed + inserted;
+
+    HighlightCheckpoints *checkpoints = &highlighter->checkpoints;
+    HighlightCheckpoint *resume = &highlighter->resume;
+    if(resume->offset > edit_end && resume->offset < kinds->count + removed - inserted) {
+        // an earlier edit wasn't lexed to the end. The lexer will go back before
+        // this edit and the states it reaches up to here are only valid until the
+        // stale text, so it has to start again from here
+        size_t at = find_checkpoint(highlighter, resume->offset);
+        if(checkpoints->items[at - 1].offset != resume->offset) {
+            da_append(checkpoints, *resume);
+            memmove(
+                checkpoints->items + at + 1,
+                checkpoints->items + at,
+                (checkpoints->count - at - 1)*sizeof(*checkpoints->items)
+            );
+            checkpoints->items[at] = *resume;
+            at++;
+        }
+        checkpoints->items[at - 1].barrier = true;
+    }
+
+    size_t first = find_checkpoint(highlighter, pos);
+    if(resume->offset <= pos) {
+        // the lexer didn't get to the edit yet. The states after it can't be
+        // reached, they would skip the edit
+        checkpoints->count = first;
+    } else {
+        // the states after the edit are shifted and the ones inside of it dropped
+        size_t kept = first;
+        for(size_t i = first; i < checkpoints->count; i++) {
+            HighlightCheckpoint checkpoint = checkpoints->items[i];
+            if(checkpoint.offset <= edit_end) continue;
+
+            checkpoint.offset = checkpoint.offset - removed + inserted;
+            if(checkpoint.token_start >= edit_end) {
+                checkpoint.token_start = checkpoint.token_start - removed + inserted;
+            } else if(checkpoint.token_start > pos) {
+                // the token started in the removed bytes, it won't match any state
+                checkpoint.token_start = SIZE_MAX;
+            }
+            checkpoints->items[kept++] = checkpoint;
+        }
+        checkpoints->count = kept;
+
+        // when the text ends at the state, the token that was being lexed there
+        // has to end again with the text, so lexing starts from the state before
+        size_t from = first - 1;
+        HighlightCheckpoint *last = &checkpoints->items[from];
+        if(from > 0 && last->offset == kinds->count && last->token_start < last->offset) from--;
+
+        *resume = checkpoints->items[from];
+        resume->barrier = false;
+    }
+
+    highlighter->version++;
+}
+
+static HighlightKind get_token_kind(
+    Lexer *lexer,
+    const char *text,
+    size_t start,
+    size_t end,
+    uint8_t state
+)
+{
+    HighlightKind kind = lexer->kinds[state];
+    size_t size = end - start;
+    if(kind != HIGHLIGHT_IDENTIFIER || size > LEXER_MAX_KEYWORD || lexer->keywords.count == 0) {
+        return kind;
+    }
+
+    char word[LEXER_MAX_KEYWORD + 1];
+    for(size_t i = 0; i < size; i++) {
+        word[i] = lexer->ignore_case ? tolower((unsigned char)text[start + i]) : text[start + i];
+    }
+    word[size] = '\0';
+
+    return LexerKeywords_get(&lexer->keywords, word) != NULL ? HIGHLIGHT_KEYWORD : kind;
+}
+
+static void end_token(
+    Highlighter *highlighter,
+    const char *text,
+    size_t start,
+    size_t end,
+    uint8_t state
+)
+{
+    HighlightKind kind = get_token_kind(highlighter->lexer, text, start, end, state);
+    memset(highlighter->kinds.items + start, kind, end - start);
+}
+
+// lexes text[resume.offset..to), the kinds of the tokens that end are set
+static void lex(Highlighter *highlighter, const char *text, size_t to)
+{
+    Lexer *lexer = highlighter->lexer;
+    const unsigned char *bytes = (const unsigned char *)text;
+    HighlightCheckpoint *at = &highlighter->resume;
+    uint8_t state = at->state;
+    size_t token_start = at->token_start;
+
+    for(size_t i = at->offset; i < to; i++) {
+        uint8_t next = lexer->next[state][bytes[i]];
+        if(next == 0) {
+            end_token(highlighter, text, token_start, i, state);
+            token_start = i;
+            next = lexer->next[LEXER_START][bytes[i]];
+            if(next == 0) next = LEXER_OTHER;
+        }
+        state = next;
+    }
+
+    *at = (HighlightCheckpoint) {.offset = to, .token_start = token_start, .state = state};
+}
+
+// the lexer reached the shifted state "index" in the same state, so the text up to
+// the next barrier, or up to the last state, was already lexed this way. Only the
+// token that is being lexed needs its kind. Returns the index lexing goes on from
+static size_t converge(Highlighter *highlighter, const char *text, size_t size, size_t index)
+{
+    HighlightCheckpoints *checkpoints = &highlighter->checkpoints;
+    HighlightCheckpoint *checkpoint = &checkpoints->items[index];
+    HighlightCheckpoint *at = &highlighter->resume;
+    if(checkpoint->state != at->state || checkpoint->token_start != at->token_start) return 0;
+
+    Lexer *lexer = highlighter->lexer;
+    if(at->token_start < at->offset) {
+        bool continues = at->offset < size
+            && lexer->next[at->state][(unsigned char)text[at->offset]] != 0;
+
+        if(!continues) {
+            end_token(highlighter, text, at->token_start, at->offset, at->state);
+        } else if(lexer->kinds[at->state] == HIGHLIGHT_IDENTIFIER) {
+            // the edit could have made the word a keyword
+            return 0;
+        } else {
+            // the kind only depends on the state where the token ends
+            uint8_t *kinds = highlighter->kinds.items;
+            memset(kinds + at->token_start, kinds[at->offset], at->offset - at->token_start);
+        }
+    }
+
+    size_t target = index;
+    while(target + 1 < checkpoints->count && !checkpoints->items[target].barrier) target++;
+    checkpoints->items[target].barrier = false;
+    *at = checkpoints->items[target];
+    return target + 1;
+}
+
+bool highlighter_update(Highlighter *highlighter, const char *text, size_t size, size_t budget)
+{
+    HighlightCheckpoint *at = &highlighter->resume;
+    if(at->offset >= size) return true;
+    assert(highlighter->kinds.count == size && "The highlighter missed an edit");
+
+    HighlightCheckpoints *checkpoints = &highlighter->checkpoints;
+    size_t next = find_checkpoint(highlighter, at->offset);
+    size_t saved = checkpoints->items[next - 1].offset;
+    size_t stop = size - at->offset > budget ? at->offset + budget : size;
+
+    while(at->offset < stop) {
+        // lexes up to the next state from before the edits, or to where a new
+        // state is saved
+        size_t to = saved + HIGHLIGHT_CHECKPOINT_SPACING;
+        bool reached = next < checkpoints->count && checkpoints->items[next].offset <= to;
+        if(reached) to = checkpoints->items[next].offset;
+        if(to > stop) {
+            to = stop;
+            reached = false;
+        }
+
+        lex(highlighter, text, to);
+
+        size_t converged = reached ? converge(highlighter, text, size, next) : 0;
+        if(converged > 0) {
+            next = converged;
+            saved = at->offset;
+        } else if(reached) {
+            checkpoints->items[next++] = *at;
+            saved = to;
+        } else if(to == saved + HIGHLIGHT_CHECKPOINT_SPACING) {
+            da_append(checkpoints, *at);
+            memmove(
+                checkpoints->items + next + 1,
+                checkpoints->items + next,
+                (checkpoints->count - next - 1)*sizeof(*checkpoints->items)
+            );
+            checkpoints->items[next++] = *at;
+            saved = to;
+        }
+    }
+
+    if(at->offset == size) {
+        // the last token ends with the text, typing after it starts from this state
+        end_token(highlighter, text, at->token_start, size, at->state);
+        if(checkpoints->items[checkpoints->count - 1].offset != size) {
+            da_append(checkpoints, *at);
+        }
+    }
+
+    highlighter->version++;
+    return at->offset == size;
+}
+
+bool highlighter_is_done(Highlighter *highlighter, size_t size)
+{
+    return highlighter->resume.offset >= size;
+}
+
+// identifiers that aren't keywords are drawn in the same run as the text
+static uint8_t get_color_kind(uint8_t kind)
+{
+    return kind == HIGHLIGHT_IDENTIFIER ? HIGHLIGHT_TEXT : kind;
+}
+
+void highlighter_draw(
+    Highlighter *highlighter,
+    UIFont *font,
+    const char *text,
+    size_t start,
+    size_t end,
+    Vector2 pos,
+    int font_size,
+    Color text_color
+)
+{
+    Color colors[HIGHLIGHT_KIND_COUNT];
+    memcpy(colors, highlighter->colors, sizeof(colors));
+    colors[HIGHLIGHT_TEXT] = text_color;
+
+    uint8_t *kinds = highlighter->kinds.items;
+    size_t run_start = start;
+    while(run_start < end) {
+        uint8_t kind = get_color_kind(kinds[run_start]);
+        size_t run_end = run_start + 1;
+        while(run_end < end && get_color_kind(kinds[run_end]) == kind) run_end++;
+        // a run never splits a char
+        while(run_end < end && utf8_is_continuation(text[run_end])) run_end++;
+
+        size_t size = run_end - run_start;
+        ui_font_draw(font, text + run_start, size, pos, font_size, FONT_SPACING, colors[kind]);
+        pos.x += ui_font_measure(font, text + run_start, size, font_size, FONT_SPACING).x
+            + FONT_SPACING;
+        run_start = run_end;
+    }
+}
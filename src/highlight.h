@@ -0,0 +1,114 @@
+#ifndef HIGHLIGHT_H
+#define HIGHLIGHT_H
+
+#include "cTooling.h"
+#include "font.h"
+#include "raylib.h"
+
+#define LEXER_MAX_STATES 64
+#define LEXER_MAX_KEYWORD 32 // longer identifiers are never keywords
+#define HIGHLIGHT_CHECKPOINT_SPACING 1024 // bytes lexed between two saved states
+#define HIGHLIGHT_BUDGET (256*1024)       // bytes lexed per frame
+
+typedef enum {
+    HIGHLIGHT_TEXT,
+    HIGHLIGHT_IDENTIFIER, // becomes a keyword when the lexer knows the word
+    HIGHLIGHT_KEYWORD,
+    HIGHLIGHT_STRING,
+    HIGHLIGHT_NUMBER,
+    HIGHLIGHT_COMMENT,
+    HIGHLIGHT_OPERATOR,
+    HIGHLIGHT_KIND_COUNT,
+} HighlightKind;
+
+HASHMAP_DECLARE(LexerKeywords, const char *, bool)
+
+// every token starts from this state, state 0 ends the token
+#define LEXER_START 1
+// bytes with no rule from the start state are tokens of a single byte
+#define LEXER_OTHER 2
+
+// Table driven lexer. A token goes from state to state with the byte tables of
+// "next", when a byte has no transition the token ends before it with the kind of
+// the state it was in and the byte starts a new token from LEXER_START. Tokens can
+// span lines, so a block comment or a string keeps its color until it's closed.
+// The languages are built with lexer_add_state and lexer_add_rule
+typedef struct {
+    uint8_t next[LEXER_MAX_STATES][256];
+    uint8_t kinds[LEXER_MAX_STATES];
+    size_t state_count;
+    LexerKeywords keywords; // lowercase when "ignore_case" is set
+    bool ignore_case;
+} Lexer;
+
+// the lexer only has LEXER_START and LEXER_OTHER
+Lexer *create_lexer(bool ignore_case);
+void destroy_lexer(Lexer *lexer);
+uint8_t lexer_add_state(Lexer *lexer, HighlightKind kind);
+// the bytes in "bytes" take "from" to "to", "a-z" is a range so a '-' has to go
+// first or last. NULL is every byte, the rules added later take precedence
+void lexer_add_rule(Lexer *lexer, uint8_t from, const char *bytes, uint8_t to);
+void lexer_add_keyword(Lexer *lexer, const char *word);
+Lexer *create_sql_lexer(void);
+Lexer *create_jsonpath_lexer(void);
+
+// state of the lexer before text[offset], "token_start" is where the token that
+// is being lexed started
+typedef struct {
+    size_t offset;
+    size_t token_start;
+    uint8_t state;
+    bool barrier; // the lexer stopped here before an edit, the text after it is stale
+} HighlightCheckpoint;
+
+// sorted by offset, items[0] is always the start of the text
+typedef struct {
+    HighlightCheckpoint *items;
+    size_t count;
+    size_t capacity;
+} HighlightCheckpoints;
+
+// kind of every byte of the text
+typedef struct {
+    uint8_t *items;
+    size_t count;
+    size_t capacity;
+} HighlightKinds;
+
+// Incremental highlighting shared by the text widgets. The state of the lexer is
+// saved every few KB, an edit keeps the states before it and shifts the ones after
+// it. Lexing starts again from the last state before the edit and stops at the
+// first shifted state that is reached in the same state, since the rest of the text
+// would be lexed the same way, so a keystroke only lexes a few KB. When an edit
+// changes the rest of the text, like opening a block comment, the text is lexed
+// a budget of bytes per frame
+typedef struct {
+    Lexer *lexer;
+    HighlightKinds kinds;
+    HighlightCheckpoints checkpoints; // the ones after "resume" are from before the last edits
+    HighlightCheckpoint resume;       // the kinds are up to date for text[0..resume.offset)
+    size_t version;                   // incremented when the kinds change
+    Color colors[HIGHLIGHT_KIND_COUNT];
+} Highlighter;
+
+void highlighter_init(Highlighter *highlighter, Lexer *lexer);
+void highlighter_free(Highlighter *highlighter);
+// "removed" bytes at "pos" were replaced with "inserted" ones
+void highlighter_edit(Highlighter *highlighter, size_t pos, size_t removed, size_t inserted);
+// lexes "budget" bytes more of the text, returns true when it's all highlighted
+bool highlighter_update(Highlighter *highlighter, const char *text, size_t size, size_t budget);
+bool highlighter_is_done(Highlighter *highlighter, size_t size);
+// draws text[start..end) at "pos" with a run for every kind, the text and the
+// identifiers take "text_color"
+void highlighter_draw(
+    Highlighter *highlighter,
+    UIFont *font,
+    const char *text,
+    size_t start,
+    size_t end,
+    Vector2 pos,
+    int font_size,
+    Color text_color
+);
+
+#endif // HIGHLIGHT_H
@@ -1,10 +1,10 @@
 #include <ctype.h>
+#include <math.h>
 
 #include "input.h"
-
-#define FONT_SPACING 2
-#define CURSOR_BLINK_RATE 0.5 // time for the cursor to show and hide in seconds
-#define CURSOR_LINE_WIDTH 2
+#include "input_source.h"
+#include "latency.h"
+#include "render.h"
 
 Input *create_input(InputProps props)
 {
@@ -20,56 +20,55 @@ Input *create_input(InputProps props)
     input->padding = props.padding;
     input->border_color = props.border_color;
     input->bg_color = props.bg_color;
+    input->read_only = props.read_only;
     input->cursor.is_collapsed = true;
 
     return input;
 }
 
-// similar to DrawTextEx from raylib
-static void draw_string(
-    Font font,
-    String *str,
-    Vector2 pos,
-    float font_size,
-    float spacing,
-    Color color
-)
-{
-    string_append_chr(str, '\0');
-    DrawTextEx(font, str->items, pos, font_size, spacing, color);
-    str->count--; // remove appended char
-}
-
-// measures a String from the beginning until "pos"
-static Vector2 measure_string_slice(
-    String *str,
-    Font font,
-    int font_size,
-    int font_spacing,
-    size_t start,
-    size_t end
-)
+// extends the width index to cover text[0..end), or until the offset of a char goes
+// past "max_x". Only the chars after the last edit are measured, the ones after
+// "end" are left until something looks at them
+static void update_width_index(Input *input, size_t end, float max_x)
 {
-    Vector2 size;
+    InputWidthIndex *index = &input->width_index;
 
-    if(end == 0 || end > str->count || start >= end) {
-        return (Vector2) {0, 0};
+    // glyphs loaded late by a dynamic font change the widths of their chars
+    if(index->font_size != input->font_size || index->font_version != input->font->widths_version) {
+        index->count = 0;
+        index->font_size = input->font_size;
+        index->font_version = input->font->widths_version;
     }
 
-    if(end == str->count) {
-        string_append_chr(str, '\0');
-        size = MeasureTextEx(font, str->items + start, font_size, font_spacing);
-        str->count--;
-    } else {
-        // saves the char, replaces the char with the null terminator, measures the text,
-        // and then replaces back the char
-        char c = str->items[end];
-        str->items[end] = '\0';
-        size = MeasureTextEx(font, str->items + start, font_size, font_spacing);
-        str->items[end] = c;
+    if(index->count == 0) da_append(index, 0);
+
+    String *text = &input->text;
+
+    if(end > text->count) end = text->count;
+    while(index->count <= end && index->items[index->count - 1] <= max_x) {
+        size_t i = index->count - 1;
+        float x = index->items[i];
+
+        // the whole width of a multibyte char goes to its first byte
+        if(!utf8_is_continuation(text->items[i])) {
+            int codepoint_size;
+            int codepoint = utf8_decode(text->items + i, text->count - i, &codepoint_size);
+            int glyph = ui_font_glyph_index(input->font, codepoint);
+            x += ui_font_glyph_advance(input->font, glyph, input->font_size) + FONT_SPACING;
+        }
+
+        da_append(index, x);
     }
+}
 
-    return size;
+// measures the text from "start" until "end", same result as MeasureTextEx
+static float get_text_width(Input *input, size_t start, size_t end)
+{
+    if(end > input->text.count) end = input->text.count;
+    if(start >= end) return 0;
+
+    update_width_index(input, end, INFINITY);
+    return input->width_index.items[end] - input->width_index.items[start] - FONT_SPACING;
 }
 
 typedef struct {
@@ -95,9 +94,7 @@ static InputBox get_input_visible_box(Input *input)
 static void update_scroll_to(Input *input, size_t pos)
 {
     // after the cursor is change, we update the input scroll
-    float text_width = measure_string_slice(
-        &input->text, input->font, input->font_size, FONT_SPACING, 0, pos
-    ).x;
+    float text_width = get_text_width(input, 0, pos);
 
     float pos_x = text_width - input->scroll;
     InputBox input_box = get_input_visible_box(input);
@@ -142,13 +139,85 @@ static void set_cursor_selection(Input *input, size_t start, size_t end)
     }
 }
 
-static bool is_ctrl_down()
+// must be called after every change to the text, "removed" bytes at "pos" were
+// replaced with "inserted" ones
+static void input_text_changed(Input *input, size_t pos, size_t removed, size_t inserted)
+{
+    input->text_version++;
+
+    // boundaries before "pos" depend only on unchanged chars so they are kept
+    InputWordBounds *bounds = &input->word_bounds;
+    while(bounds->count > 0 && bounds->items[bounds->count - 1] >= pos) {
+        bounds->count--;
+    }
+    if(bounds->scanned > pos) bounds->scanned = pos;
+
+    // the offset of the char at "pos" only depends on the chars before it, but the
+    // first byte of a multibyte char also depends on the following 3 bytes
+    size_t valid = pos > 3 ? pos - 3 : 0;
+    if(input->width_index.count > valid + 1) {
+        input->width_index.count = valid + 1;
+    }
+
+    text_find_truncate(&input->find, pos);
+    if(input->highlighter != NULL) highlighter_edit(input->highlighter, pos, removed, inserted);
+}
+
+int get_chr_class(char chr)
+{
+    unsigned char c = chr;
+    if(isspace(c)) return 0;
+    // the bytes of multibyte chars are part of the words
+    if(isalnum(c) || c == '_' || c >= 0x80) return 1;
+    return 2;
+}
+
+static void update_word_bounds(Input *input)
+{
+    InputWordBounds *bounds = &input->word_bounds;
+    String *text = &input->text;
+
+    size_t i = bounds->scanned > 0 ? bounds->scanned : 1;
+    for(; i < text->count; i++) {
+        if(get_chr_class(text->items[i - 1]) != get_chr_class(text->items[i])) {
+            da_append(bounds, i);
+        }
+    }
+
+    bounds->scanned = text->count;
+}
+
+// finds the word around "pos" using a binary search over the word boundaries
+static InputSelection get_word_at(Input *input, size_t pos)
+{
+    update_word_bounds(input);
+
+    InputWordBounds *bounds = &input->word_bounds;
+    if(pos >= input->text.count && pos > 0) pos = input->text.count - 1;
+
+    // first boundary that is bigger than "pos"
+    size_t lo = 0, hi = bounds->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(bounds->items[mid] <= pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return (InputSelection) {
+        .start = lo > 0 ? bounds->items[lo - 1] : 0,
+        .end = lo < bounds->count ? bounds->items[lo] : input->text.count,
+    };
+}
+
+bool is_ctrl_down(void)
 {
-    return IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
+    return input_source_is_key_down(KEY_LEFT_CONTROL) || input_source_is_key_down(KEY_RIGHT_CONTROL);
 }
 
-// returns a selection where the start is always smaller than the end
-static InputSelection get_corrected_selection(InputSelection selection)
+InputSelection get_corrected_selection(InputSelection selection)
 {
     if(selection.start > selection.end) {
         return (InputSelection) {selection.end, selection.start};
@@ -165,106 +234,191 @@ static void remove_selected_text(Input *input)
     InputSelection sel = get_corrected_selection(cursor->selection);
 
     string_remove_slice(&input->text, sel.start, sel.end);
+    input_text_changed(input, sel.start, sel.end - sel.start, 0);
     cursor->is_collapsed = true;
     set_cursor_pos(input, sel.start);
 }
 
-static size_t get_cursor_pos_pointed_by_mouse(Input *input)
+// returns the cursor position closest to the screen coordinate "x"
+static size_t get_cursor_pos_at(Input *input, float x)
 {
-    Vector2 mouse_pos = GetMousePosition();
     InputBox input_box = get_input_visible_box(input);
+    float text_x = x - input_box.left + input->scroll;
+
+    // the chars after the first one past "x" aren't measured
+    update_width_index(input, input->text.count, text_x);
+    float *offsets = input->width_index.items;
+
+    // binary search of the first char whose threshold is past "x". The division
+    // makes the click feel right. If you click the left part of a letter the cursor
+    // goes to the left of the letter. The same happens if you click the right part
+    size_t lo = 0, hi = input->width_index.count - 1;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        float chr_size = offsets[mid + 1] - offsets[mid] - FONT_SPACING;
+
+        if(offsets[mid] + chr_size / 1.5 > text_x) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
 
-    // helper string for measuring the letters with raylib
-    char s[2];
-    s[1] = '\0';
-    float chr_pos = 0;
+    // the cursor can't be placed in the middle of a multibyte char
+    while(lo < input->text.count && utf8_is_continuation(input->text.items[lo])) lo++;
 
-    for(size_t i = 0; i < input->text.count; i++) {
-        s[0] = input->text.items[i];
+    // if the mouse position exceeds last char position, lo is the last position
+    return lo;
+}
+
+static size_t get_cursor_pos_pointed_by_mouse(Input *input)
+{
+    InputBox input_box = get_input_visible_box(input);
+    float x = input_source_get_mouse_position().x;
 
-        float chr_size = MeasureTextEx(input->font, s, input->font_size, FONT_SPACING).x;
+    // while dragging outside of the box the closest visible char is the one pointed
+    if(x < input_box.left) x = input_box.left;
+    if(x > input_box.right) x = input_box.right;
 
-        // this division makes the click feel right. If you click the left part of a letter
-        // the cursor goes to the left of the letter. The same happens if you click the right part
-        if(chr_pos + chr_size / 1.5 > mouse_pos.x - input_box.left) {
-            return i;
-            break;
-        }
+    return get_cursor_pos_at(input, x);
+}
 
-        chr_pos += chr_size;
+// scrolls the text while dragging a selection past the sides of the input, the
+// further away the mouse is the faster it scrolls
+static void auto_scroll(Input *input, float mouse_x)
+{
+    InputBox input_box = get_input_visible_box(input);
+    float dt = input_source_get_frame_time();
 
-        // between characters an additional width (font spacing) is added
-        if(i > 0) chr_pos += FONT_SPACING;
+    if(mouse_x < input_box.left) {
+        input->scroll -= (input_box.left - mouse_x) * AUTO_SCROLL_SPEED * dt;
+    } else if(mouse_x > input_box.right) {
+        input->scroll += (mouse_x - input_box.right) * AUTO_SCROLL_SPEED * dt;
+    } else {
+        return;
     }
 
-    // if the mouse position exceeds last char position, we set the cursor to the last position
-    return input->text.count;
+    float max_scroll = get_text_width(input, 0, input->text.count)
+        - (input_box.right - input_box.left);
+
+    if(input->scroll > max_scroll) input->scroll = max_scroll;
+    if(input->scroll < 0) input->scroll = 0;
 }
 
 static void handle_mouse(Input *input)
 {
     static size_t initial_pos;
 
-    Vector2 mouse_pos = GetMousePosition();
+    Vector2 mouse_pos = input_source_get_mouse_position();
     Rectangle input_rect =  {
         input->pos.x, input->pos.y,
         input->size.x, input->size.y,
     };
     input->hovered = CheckCollisionPointRec(mouse_pos, input_rect);
 
-    if(IsMouseButtonReleased(MOUSE_BUTTON_LEFT) && input->hovered) {
-        input->focused = true;
+    // the focus changes on press, so a drag selection released outside keeps it
+    if(input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        input->focused = input->hovered;
         // reset cursor's blinking
         input->cursor.blink_t = 0;
-    } else if(IsMouseButtonReleased(MOUSE_BUTTON_LEFT) && !input->hovered) {
-        input->focused = false;
     }
 
     InputBox input_box = get_input_visible_box(input);
-    if(mouse_pos.y > input_box.top && mouse_pos.y < input_box.top + input->font_size) {
-        if(IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            initial_pos = get_cursor_pos_pointed_by_mouse(input);
+    bool in_text_row = mouse_pos.y > input_box.top
+        && mouse_pos.y < input_box.top + input->font_size;
+
+    if(input->hovered && in_text_row && input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        size_t pos = get_cursor_pos_pointed_by_mouse(input);
+        double time = input_source_get_time();
+
+        bool is_multi_click = time - input->last_click_time < MULTI_CLICK_TIME
+            && pos == input->last_click_pos;
+        input->click_count = is_multi_click ? input->click_count % 3 + 1 : 1;
+        input->last_click_time = time;
+        input->last_click_pos = pos;
+
+        if(input->click_count == 2) {
+            InputSelection word = get_word_at(input, pos);
+            set_cursor_selection(input, word.start, word.end);
+        } else if(input->click_count == 3) {
+            set_cursor_selection(input, 0, input->text.count);
         }
 
-        if(IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
-            size_t final_pos = get_cursor_pos_pointed_by_mouse(input);
+        initial_pos = pos;
+        // double and triple clicks select on press, dragging only applies to single clicks
+        input->dragging = input->click_count == 1;
+    }
 
-            if(input->cursor.selection.end != final_pos) {
-                set_cursor_selection(input, initial_pos, final_pos);
-            }
-        }
+    if(!input->dragging) return;
+
+    if(input_source_is_mouse_button_down(MOUSE_BUTTON_LEFT)) {
+        auto_scroll(input, mouse_pos.x);
+        size_t final_pos = get_cursor_pos_pointed_by_mouse(input);
 
-        if(IsMouseButtonReleased(MOUSE_BUTTON_LEFT)) {
-            size_t final_pos = get_cursor_pos_pointed_by_mouse(input);
+        if(input->cursor.selection.end != final_pos) {
             set_cursor_selection(input, initial_pos, final_pos);
         }
     }
+
+    if(input_source_is_mouse_button_released(MOUSE_BUTTON_LEFT)) {
+        size_t final_pos = get_cursor_pos_pointed_by_mouse(input);
+        set_cursor_selection(input, initial_pos, final_pos);
+        input->dragging = false;
+    }
+}
+
+// position of the char after the one at "pos", skipping the bytes of multibyte chars
+static size_t get_next_chr_pos(Input *input, size_t pos)
+{
+    if(pos < input->text.count) pos++;
+    while(pos < input->text.count && utf8_is_continuation(input->text.items[pos])) pos++;
+    return pos;
+}
+
+static size_t get_prev_chr_pos(Input *input, size_t pos)
+{
+    if(pos > 0) pos--;
+    while(pos > 0 && utf8_is_continuation(input->text.items[pos])) pos--;
+    return pos;
 }
 
 static void handle_editing(Input *input)
 {
     int chr;
-    while((chr = GetCharPressed()) != 0) {
+    while((chr = input_source_get_char()) != 0) {
+        latency_mark_char(chr);
+
         if(!input->cursor.is_collapsed) {
             remove_selected_text(input);
         }
-        string_insert_chr(&input->text, chr, input->cursor.pos);
-        set_cursor_pos(input, input->cursor.pos + 1);
+
+        char bytes[4];
+        int size = utf8_encode(chr, bytes);
+        for(int i = 0; i < size; i++) {
+            string_insert_chr(&input->text, bytes[i], input->cursor.pos + i);
+        }
+
+        input_text_changed(input, input->cursor.pos, 0, size);
+        // the glyph of a new codepoint is rasterized here by dynamic fonts
+        set_cursor_pos(input, input->cursor.pos + size);
     }
 
-    bool is_backspace_active = IsKeyPressedRepeat(KEY_BACKSPACE) || IsKeyPressed(KEY_BACKSPACE);
+    bool is_backspace_active = input_source_is_key_pressed_repeat(KEY_BACKSPACE)
+        || input_source_is_key_pressed(KEY_BACKSPACE);
 
     if(!input->cursor.is_collapsed && is_backspace_active) {
         remove_selected_text(input);
     } else if(is_ctrl_down() && is_backspace_active && input->cursor.pos > 0) {
-        char cur_chr = input->text.items[input->cursor.pos - 1];
+        unsigned char cur_chr = input->text.items[input->cursor.pos - 1];
 
-        if(!isalnum(cur_chr)) {
-            string_remove_chr(&input->text, input->cursor.pos - 1);
-            set_cursor_pos(input, input->cursor.pos - 1);
+        if(get_chr_class(cur_chr) != 1) {
+            size_t prev_pos = get_prev_chr_pos(input, input->cursor.pos);
+            string_remove_slice(&input->text, prev_pos, input->cursor.pos);
+            input_text_changed(input, prev_pos, input->cursor.pos - prev_pos, 0);
+            set_cursor_pos(input, prev_pos);
         } else {
             size_t cur_pos = input->cursor.pos;
-            while(cur_pos > 0 && isalnum(cur_chr)) {
+            while(cur_pos > 0 && get_chr_class(cur_chr) == 1) {
                 cur_pos--;
                 if(cur_pos > 0) {
                     cur_chr = input->text.items[cur_pos - 1];
@@ -272,60 +426,71 @@ static void handle_editing(Input *input)
             }
 
             string_remove_slice(&input->text, cur_pos, input->cursor.pos);
+            input_text_changed(input, cur_pos, input->cursor.pos - cur_pos, 0);
             set_cursor_pos(input, cur_pos);
         }
     } else if(input->cursor.pos > 0 && is_backspace_active) {
-        string_remove_chr(&input->text, input->cursor.pos - 1);
-        set_cursor_pos(input, input->cursor.pos - 1);
+        size_t prev_pos = get_prev_chr_pos(input, input->cursor.pos);
+        string_remove_slice(&input->text, prev_pos, input->cursor.pos);
+        input_text_changed(input, prev_pos, input->cursor.pos - prev_pos, 0);
+        set_cursor_pos(input, prev_pos);
     }
 }
 
-static void copy_selected_text_to_clipboard(Input *input)
+void copy_to_clipboard(const char *text, size_t size)
 {
-    InputSelection selection = get_corrected_selection(input->cursor.selection);
-    size_t selection_len = selection.end - selection.start;
-    char *slice = malloc(selection_len + 1);
+    // the clipboard takes a null terminated string
+    char *slice = malloc(size + 1);
+    assert(slice != NULL && "No enough ram");
 
-    size_t j = 0;
-    for(size_t i = selection.start; i < selection.end; i++) {
-        slice[j++] = input->text.items[i];
-    }
+    memcpy(slice, text, size);
+    slice[size] = '\0';
 
-    slice[j] = '\0';
+    input_source_set_clipboard_text(slice);
+    free(slice);
+}
 
-    SetClipboardText(slice);
+static void copy_selected_text_to_clipboard(Input *input)
+{
+    InputSelection selection = get_corrected_selection(input->cursor.selection);
+    copy_to_clipboard(input->text.items + selection.start, selection.end - selection.start);
 }
 
 static void handle_clipboard(Input *input)
 {
     bool ctrl = is_ctrl_down();
-    if(ctrl && IsKeyPressed(KEY_V)) {
+    if(ctrl && input_source_is_key_pressed(KEY_V) && !input->read_only) {
         // PASTE
-        const char *raw = GetClipboardText();
+        const char *raw = input_source_get_clipboard_text();
+        size_t raw_size = strlen(raw);
 
-        if(strlen(raw) > 0) {
-            char *formatted_text = malloc(strlen(raw) + 1);
-            size_t i = 0;
+        if(raw_size > 0) {
+            char *formatted_text = malloc(raw_size + 1);
+            assert(formatted_text != NULL && "No enough ram");
+            size_t size = 0;
 
             // removes new lines from pasted text
-            for(size_t j = 0; j <= strlen(raw); j++) {
+            for(size_t j = 0; j < raw_size; j++) {
                 if(raw[j] != '\n') {
-                    formatted_text[i++] = raw[j];
+                    formatted_text[size++] = raw[j];
                 }
             }
+            formatted_text[size] = '\0';
 
             string_insert_text(&input->text, formatted_text, input->cursor.pos);
-            set_cursor_pos(input, input->cursor.pos + strlen(formatted_text));
+            input_text_changed(input, input->cursor.pos, 0, size);
+            set_cursor_pos(input, input->cursor.pos + size);
 
             free(formatted_text);
         }
-    } else if(ctrl && IsKeyPressed(KEY_C) && !input->cursor.is_collapsed) {
+    } else if(ctrl && input_source_is_key_pressed(KEY_C) && !input->cursor.is_collapsed) {
         copy_selected_text_to_clipboard(input);
-    } else if(ctrl && IsKeyPressed(KEY_X) && !input->cursor.is_collapsed) {
+    } else if(ctrl && input_source_is_key_pressed(KEY_X)
+        && !input->cursor.is_collapsed && !input->read_only) {
         // CUT
         copy_selected_text_to_clipboard(input);
         remove_selected_text(input);
-    } else if(ctrl && IsKeyPressed(KEY_A)) {
+    } else if(ctrl && input_source_is_key_pressed(KEY_A)) {
         // SELECT ALL
         set_cursor_selection(input, 0, input->text.count);
     }
@@ -333,26 +498,28 @@ static void handle_clipboard(Input *input)
 
 static void handle_arrow_keys(Input *input)
 {
-    bool is_right_down = IsKeyPressed(KEY_RIGHT) || IsKeyPressedRepeat(KEY_RIGHT);
-    bool is_left_down = IsKeyPressed(KEY_LEFT) || IsKeyPressedRepeat(KEY_LEFT);
+    bool is_right_down = input_source_is_key_pressed(KEY_RIGHT)
+        || input_source_is_key_pressed_repeat(KEY_RIGHT);
+    bool is_left_down = input_source_is_key_pressed(KEY_LEFT)
+        || input_source_is_key_pressed_repeat(KEY_LEFT);
 
     InputCursor *cursor = &input->cursor;
 
-    if(IsKeyDown(KEY_RIGHT_SHIFT) || IsKeyDown(KEY_LEFT_SHIFT)) {
+    if(input_source_is_key_down(KEY_RIGHT_SHIFT) || input_source_is_key_down(KEY_LEFT_SHIFT)) {
         if(is_right_down) {
             if(cursor->is_collapsed && cursor->pos < input->text.count) {
-                set_cursor_selection(input, cursor->pos, cursor->pos + 1);
-            } else if(cursor->selection.end < input->text.count) {
+                set_cursor_selection(input, cursor->pos, get_next_chr_pos(input, cursor->pos));
+            } else if(!cursor->is_collapsed && cursor->selection.end < input->text.count) {
                 set_cursor_selection(
-                    input, cursor->selection.start, cursor->selection.end + 1
+                    input, cursor->selection.start, get_next_chr_pos(input, cursor->selection.end)
                 );
             }
         } else if(is_left_down) {
             if(cursor->is_collapsed && cursor->pos > 0) {
-                set_cursor_selection(input, cursor->pos, cursor->pos - 1);
-            } else if(cursor->selection.end > 0) {
+                set_cursor_selection(input, cursor->pos, get_prev_chr_pos(input, cursor->pos));
+            } else if(!cursor->is_collapsed && cursor->selection.end > 0) {
                 set_cursor_selection(
-                    input, cursor->selection.start, cursor->selection.end - 1
+                    input, cursor->selection.start, get_prev_chr_pos(input, cursor->selection.end)
                 );
             }
         }
@@ -360,7 +527,7 @@ static void handle_arrow_keys(Input *input)
         if(is_right_down) {
             if(cursor->is_collapsed && cursor->pos < input->text.count) {
                 // moves cursor to the right
-                set_cursor_pos(input, cursor->pos + 1);
+                set_cursor_pos(input, get_next_chr_pos(input, cursor->pos));
             } else if(!cursor->is_collapsed) {
                 // removes the selection and sets the cursor at the end of it
                 InputSelection sel = cursor->selection;
@@ -371,7 +538,7 @@ static void handle_arrow_keys(Input *input)
         } else if(is_left_down) {
             if(cursor->is_collapsed && cursor->pos > 0) {
                 // moves the cursor to the left
-                set_cursor_pos(input, cursor->pos - 1);
+                set_cursor_pos(input, get_prev_chr_pos(input, cursor->pos));
             } else if(!cursor->is_collapsed) {
                 // removes the selection and sets the cursor at the start of it
                 InputSelection sel = cursor->selection;
@@ -383,15 +550,22 @@ static void handle_arrow_keys(Input *input)
     }
 }
 
-static void draw_input_text(Input *input)
+static Rectangle get_input_visible_rect(Input *input)
 {
     InputBox input_box = get_input_visible_box(input);
-    BeginScissorMode(
+    return (Rectangle) {
         input_box.left,
         input_box.top,
         input_box.right - input_box.left,
-        input_box.bottom - input_box.top
-    );
+        input_box.bottom - input_box.top,
+    };
+}
+
+static void draw_input_text(Input *input)
+{
+    InputBox input_box = get_input_visible_box(input);
+    render_set_layer(RENDER_LAYER_TEXT);
+    render_push_clip(get_input_visible_rect(input));
 
     Vector2 text_pos = {
         .x = input_box.left - input->scroll,
@@ -399,26 +573,52 @@ static void draw_input_text(Input *input)
     };
 
     if(input->text.count > 0) {
-        draw_string(
-            input->font,
-            &input->text,
-            text_pos,
-            input->font_size,
-            FONT_SPACING,
-            input->font_color
-        );
+        // only the chars inside the box are drawn, one extra char is taken at each
+        // side for the ones that are partially visible
+        size_t start = get_cursor_pos_at(input, input_box.left);
+        size_t end = get_cursor_pos_at(input, input_box.right);
+        String *text = &input->text;
+        if(start > 0) start--;
+        while(start > 0 && utf8_is_continuation(text->items[start])) start--;
+        if(end < text->count) end++;
+        while(end < text->count && utf8_is_continuation(text->items[end])) end++;
+
+        text_pos.x += input->width_index.items[start];
+        if(input->highlighter != NULL) {
+            highlighter_draw(
+                input->highlighter,
+                input->font,
+                text->items,
+                start,
+                end,
+                text_pos,
+                input->font_size,
+                input->font_color
+            );
+        } else {
+            ui_font_draw(
+                input->font,
+                text->items + start,
+                end - start,
+                text_pos,
+                input->font_size,
+                FONT_SPACING,
+                input->font_color
+            );
+        }
     } else {
         Color color = ColorAlpha(input->font_color, 0.5);
-        DrawTextEx(
+        ui_font_draw(
             input->font,
             input->placeholder,
+            strlen(input->placeholder),
             text_pos,
             input->font_size,
             FONT_SPACING,
             color
         );
     }
-    EndScissorMode();
+    render_pop_clip();
 
     if(input->focused) {
         int border_size = 2;
@@ -426,102 +626,398 @@ static void draw_input_text(Input *input)
             input->pos.x, input->pos.y,
             input->size.x, input->size.y,
         };
-        DrawRectangleLinesEx(input_rect, border_size, input->border_color);
+        render_set_layer(RENDER_LAYER_OVERLAY);
+        render_rect_lines(input_rect, border_size, input->border_color);
     }
 }
 
-static void draw_selection(Input *input)
+// highlights the chars of "selection", its start has to be smaller than its end
+static void draw_range(Input *input, InputSelection selection, Color color)
 {
-    InputCursor *cursor = &input->cursor;
     InputBox input_box = get_input_visible_box(input);
 
-    InputSelection selection = get_corrected_selection(cursor->selection);
+    float selection_width = get_text_width(input, selection.start, selection.end);
+    float start_pos = get_text_width(input, 0, selection.start);
 
-    float selection_width = measure_string_slice(
-        &input->text,
-        input->font,
-        input->font_size,
-        FONT_SPACING,
-        selection.start,
-        selection.end
-    ).x;
-
-    float start_pos = measure_string_slice(
-        &input->text,
-        input->font,
-        input->font_size,
-        FONT_SPACING,
-        0,
-        selection.start
-    ).x;
-
-    Vector2 pos = {
+    Rectangle rec = {
         .x = input_box.left + start_pos - input->scroll,
         .y = input_box.top - 1,
+        .width = selection_width,
+        .height = input->font_size + 2,
     };
 
     // We add a little offset if the selection doesn't start from the first char
     if(selection.start > 0) {
-        pos.x += FONT_SPACING;
+        rec.x += FONT_SPACING;
     }
 
-    Vector2 size = {
-        .x = selection_width,
-        .y = input->font_size + 2,
-    };
+    render_set_layer(RENDER_LAYER_HIGHLIGHT);
+    render_push_clip(get_input_visible_rect(input));
+    render_rect(rec, color);
+    render_pop_clip();
+}
 
-    BeginScissorMode(
-        input_box.left,
-        input_box.top,
-        input_box.right - input_box.left,
-        input_box.bottom - input_box.top
-    );
-    DrawRectangleV(pos, size, ColorAlpha(input->font_color, 0.4));
-    EndScissorMode();
+static void draw_selection(Input *input)
+{
+    InputSelection selection = get_corrected_selection(input->cursor.selection);
+    draw_range(input, selection, ColorAlpha(input->font_color, 0.4));
 }
 
-static void draw_cursor(Input *input)
+// only the matches between the chars at the sides of the box are drawn
+static void draw_find_matches(Input *input)
 {
-    InputCursor *cursor = &input->cursor;
     InputBox input_box = get_input_visible_box(input);
+    size_t first = get_cursor_pos_at(input, input_box.left);
+    size_t last = get_cursor_pos_at(input, input_box.right);
+
+    TextFind *find = &input->find;
+    Color color = ColorAlpha(input->font_color, 0.2);
+    for(size_t i = text_find_first_after(find, first); i < find->matches.count; i++) {
+        InputSelection match;
+        text_find_match(find, i, &match.start, &match.end);
+        if(match.start > last) break;
 
-    cursor->blink_t += GetFrameTime();
+        draw_range(input, match, color);
+    }
+}
+
+static void update_cursor_blink(Input *input)
+{
+    InputCursor *cursor = &input->cursor;
+    if(!cursor->is_collapsed || !input->focused) return;
+
+    cursor->blink_t += input_source_get_frame_time();
 
     if(cursor->blink_t > CURSOR_BLINK_RATE * 2) {
         cursor->blink_t = 0;
     }
+}
+
+static bool is_cursor_visible(Input *input)
+{
+    InputCursor *cursor = &input->cursor;
+    return cursor->is_collapsed && input->focused && cursor->blink_t < CURSOR_BLINK_RATE;
+}
+
+static Rectangle get_cursor_rect(Input *input)
+{
+    InputBox input_box = get_input_visible_box(input);
+    float text_width = get_text_width(input, 0, input->cursor.pos);
+
+    return (Rectangle) {
+        .x = input_box.left + text_width - input->scroll,
+        .y = input_box.top - 1,
+        .width = CURSOR_LINE_WIDTH,
+        .height = input->font_size + 2,
+    };
+}
+
+static void draw_cursor(Input *input)
+{
+    render_set_layer(RENDER_LAYER_OVERLAY);
+    render_rect(get_cursor_rect(input), input->font_color);
+}
+
+static bool is_dropdown_visible(Input *input)
+{
+    Autocomplete *ac = input->autocomplete;
+    return ac != NULL && input->focused && !ac->dismissed && !input->find.active
+        && ac->result_count > 0 && input->text.count > 0;
+}
+
+// takes the place of the dropdown under the input
+static Rectangle get_find_bar_rect(Input *input)
+{
+    return (Rectangle) {
+        .x = input->pos.x,
+        .y = input->pos.y + input->size.y,
+        .width = input->size.x,
+        .height = text_find_bar_height(&input->find, input->font_size),
+    };
+}
+
+static float get_dropdown_row_height(Input *input)
+{
+    return input->font_size + DROPDOWN_ROW_PADDING*2;
+}
+
+static Rectangle get_dropdown_rect(Input *input)
+{
+    return (Rectangle) {
+        .x = input->pos.x,
+        .y = input->pos.y + input->size.y,
+        .width = input->size.x,
+        .height = input->autocomplete->result_count * get_dropdown_row_height(input),
+    };
+}
+
+static void draw_dropdown(Input *input)
+{
+    Autocomplete *ac = input->autocomplete;
+    Rectangle rect = get_dropdown_rect(input);
+    float row_height = get_dropdown_row_height(input);
+
+    // the background and the highlight share the clip so they keep their order
+    render_push_clip(rect);
+    render_set_layer(RENDER_LAYER_POPUP);
+    render_rect(rect, input->bg_color);
+
+    for(size_t i = 0; i < ac->result_count; i++) {
+        float y = rect.y + i * row_height;
+        if(i == ac->highlighted) {
+            render_set_layer(RENDER_LAYER_POPUP);
+            Rectangle row = {rect.x, y, rect.width, row_height};
+            render_rect(row, ColorAlpha(input->font_color, 0.2));
+        }
 
-    if(cursor->blink_t < CURSOR_BLINK_RATE) {
-        float text_width = measure_string_slice(
-            &input->text,
+        size_t size;
+        const char *entry = autocomplete_index_entry(ac->index, ac->results[i], &size);
+        render_set_layer(RENDER_LAYER_POPUP_TEXT);
+        ui_font_draw(
             input->font,
+            entry,
+            size,
+            (Vector2) {rect.x + input->padding.left, y + DROPDOWN_ROW_PADDING},
             input->font_size,
             FONT_SPACING,
-            0, input->cursor.pos
-        ).x;
+            input->font_color
+        );
+    }
 
-        Vector2 pos = {
-            .x = input_box.left + text_width - input->scroll,
-            .y = input_box.top - 1,
-        };
-        Vector2 size = {
-            .x = CURSOR_LINE_WIDTH,
-            .y = input->font_size + 2,
-        };
-        DrawRectangleV(pos, size, input->font_color);
+    render_pop_clip();
+    render_set_layer(RENDER_LAYER_POPUP_TEXT);
+    render_rect_lines(rect, 1, input->border_color);
+}
+
+// compares what's going to be drawn with the last frame and damages what changed.
+// When only the cursor blinked just the cursor is repainted
+static void damage_changes(Input *input)
+{
+    InputDrawState state;
+    // the padding has to be zero too since the states are compared with memcmp
+    memset(&state, 0, sizeof(state));
+    state.pos = input->pos;
+    state.size = input->size;
+    state.focused = input->focused;
+    state.is_collapsed = input->cursor.is_collapsed;
+    state.cursor_visible = is_cursor_visible(input);
+    state.cursor_pos = input->cursor.pos;
+    state.selection = input->cursor.selection;
+    state.scroll = input->scroll;
+    state.text_version = input->text_version;
+    if(is_dropdown_visible(input)) {
+        state.dropdown = get_dropdown_rect(input);
+        state.dropdown_highlighted = input->autocomplete->highlighted;
+    }
+    if(input->find.active) state.find_bar = get_find_bar_rect(input);
+    state.find_version = input->find.version;
+    if(input->highlighter != NULL) state.highlight_version = input->highlighter->version;
+
+    InputDrawState *drawn = &input->drawn;
+    bool cursor_toggled = state.cursor_visible != drawn->cursor_visible;
+    drawn->cursor_visible = state.cursor_visible;
+
+    if(memcmp(&state, drawn, sizeof(state)) != 0) {
+        render_add_damage((Rectangle) {drawn->pos.x, drawn->pos.y, drawn->size.x, drawn->size.y});
+        render_add_damage((Rectangle) {input->pos.x, input->pos.y, input->size.x, input->size.y});
+        // the dropdown covers other widgets, they are repainted where it was
+        render_add_damage(drawn->dropdown);
+        render_add_damage(state.dropdown);
+        render_add_damage(drawn->find_bar);
+        render_add_damage(state.find_bar);
+    } else if(cursor_toggled) {
+        render_add_damage(get_cursor_rect(input));
+    }
+
+    *drawn = state;
+}
+
+void input_attach_stream(Input *input, RingBuffer *stream)
+{
+    input->stream = stream;
+}
+
+void input_attach_autocomplete(Input *input, AutocompleteIndex *index)
+{
+    input->autocomplete = malloc(sizeof(Autocomplete));
+    assert(input->autocomplete != NULL && "No enough ram");
+
+    autocomplete_init(input->autocomplete, index);
+    autocomplete_update(input->autocomplete, input->text.items, input->text.count);
+    input->completed_version = input->text_version;
+}
+
+void input_attach_lexer(Input *input, Lexer *lexer)
+{
+    input->highlighter = malloc(sizeof(Highlighter));
+    assert(input->highlighter != NULL && "No enough ram");
+
+    highlighter_init(input->highlighter, lexer);
+    highlighter_edit(input->highlighter, 0, 0, input->text.count);
+}
+
+// the completions follow the text, only the bytes that changed at its end are searched
+static void update_completions(Input *input)
+{
+    if(input->autocomplete == NULL || input->completed_version == input->text_version) return;
+
+    autocomplete_update(input->autocomplete, input->text.items, input->text.count);
+    input->completed_version = input->text_version;
+}
+
+// arrows pick a suggestion, tab or enter accept it and escape hides the dropdown
+static void handle_dropdown_keys(Input *input)
+{
+    if(!is_dropdown_visible(input)) return;
+
+    Autocomplete *ac = input->autocomplete;
+    size_t count = ac->result_count;
+    bool none = ac->highlighted == SIZE_MAX;
+    bool is_down_active = input_source_is_key_pressed(KEY_DOWN)
+        || input_source_is_key_pressed_repeat(KEY_DOWN);
+    bool is_up_active = input_source_is_key_pressed(KEY_UP)
+        || input_source_is_key_pressed_repeat(KEY_UP);
+    bool accept = input_source_is_key_pressed(KEY_TAB)
+        || (input_source_is_key_pressed(KEY_ENTER) && !none);
+
+    if(is_down_active) {
+        ac->highlighted = none ? 0 : (ac->highlighted + 1) % count;
+    } else if(is_up_active) {
+        ac->highlighted = none || ac->highlighted == 0 ? count - 1 : ac->highlighted - 1;
+    } else if(input_source_is_key_pressed(KEY_ESCAPE)) {
+        ac->dismissed = true;
+    } else if(accept && !input->read_only) {
+        size_t size;
+        uint32_t picked = ac->results[none ? 0 : ac->highlighted];
+        const char *entry = autocomplete_index_entry(ac->index, picked, &size);
+
+        size_t old_count = input->text.count;
+        input->text.count = 0;
+        da_append_many(&input->text, entry, size);
+        input_text_changed(input, 0, old_count, size);
+        set_cursor_pos(input, size);
+
+        update_completions(input);
+        ac->dismissed = true;
+    }
+}
+
+// appends everything available in the stream to the text with a single read
+static void drain_stream(Input *input)
+{
+    size_t available = ring_buffer_count(input->stream);
+    if(available == 0) return;
+
+    String *text = &input->text;
+    size_t old_count = text->count;
+    da_reserve(text, text->count + available);
+
+    char *dest = text->items + text->count;
+    size_t read = ring_buffer_read(input->stream, dest, available);
+
+    // removes new lines like pasting does
+    size_t j = 0;
+    for(size_t i = 0; i < read; i++) {
+        if(dest[i] != '\n') dest[j++] = dest[i];
+    }
+    text->count += j;
+    input_text_changed(input, old_count, 0, j);
+
+    // if the cursor was at the end it keeps following the text
+    if(input->cursor.is_collapsed && input->cursor.pos == old_count) {
+        set_cursor_pos(input, text->count);
+    }
+}
+
+// the new text is built in a single pass and takes the place of the old one
+static void replace_all(Input *input)
+{
+    InputCursor *cursor = &input->cursor;
+    InputSelection selection = get_corrected_selection(cursor->selection);
+    size_t pos = cursor->is_collapsed ? cursor->pos : selection.start;
+
+    String replaced = {0};
+    size_t count = text_find_replace_all(
+        &input->find, input->text.items, input->text.count, &replaced, &pos
+    );
+    if(count == 0) return;
+
+    size_t old_count = input->text.count;
+    string_free(&input->text);
+    input->text = replaced;
+    input_text_changed(input, 0, old_count, replaced.count);
+    set_cursor_pos(input, pos);
+}
+
+// enter selects the next match and shift + enter the previous one
+static void handle_find_keys(Input *input)
+{
+    TextFind *find = &input->find;
+    String *text = &input->text;
+    TextFindAction action = text_find_handle_keys(find, text->items, text->count);
+
+    InputCursor *cursor = &input->cursor;
+    InputSelection selection = get_corrected_selection(cursor->selection);
+    bool found = false;
+    if(action == TEXT_FIND_NEXT) {
+        // a selected match is skipped
+        size_t pos = cursor->is_collapsed ? cursor->pos : selection.start + 1;
+        found = text_find_next(find, text->items, text->count, pos);
+    } else if(action == TEXT_FIND_PREVIOUS) {
+        size_t pos = cursor->is_collapsed ? cursor->pos : selection.start;
+        found = text_find_previous(find, text->items, text->count, pos);
+    } else if(action == TEXT_FIND_REPLACE_ALL && !input->read_only) {
+        replace_all(input);
+    }
+
+    if(found) {
+        size_t start, end;
+        text_find_match(find, find->current, &start, &end);
+        set_cursor_selection(input, start, end);
     }
 }
 
 void handle_input(Input *input)
 {
+    if(input->stream != NULL) {
+        drain_stream(input);
+    }
+
     handle_mouse(input);
     if(input->focused) {
-        handle_editing(input);
+        // while the find bar is open the typed chars go to its query
+        bool finding = input->find.active;
+        handle_find_keys(input);
+        if(!finding && !input->find.active) {
+            handle_dropdown_keys(input);
+            if(!input->read_only) handle_editing(input);
+        }
         handle_arrow_keys(input);
         handle_clipboard(input);
     }
+    update_completions(input);
 
-    DrawRectangleV(input->pos, input->size, input->bg_color);
+    // the matches are searched a budget of bytes per frame
+    TextFind *find = &input->find;
+    if(find->active) text_find_update(find, input->text.items, input->text.count, TEXT_FIND_BUDGET);
+
+    // the edits of this frame are lexed again before drawing, a budget of bytes at most
+    Highlighter *highlighter = input->highlighter;
+    if(highlighter != NULL && !highlighter_is_done(highlighter, input->text.count)) {
+        highlighter_update(highlighter, input->text.items, input->text.count, HIGHLIGHT_BUDGET);
+    }
+
+    update_cursor_blink(input);
+    damage_changes(input);
+
+    render_set_layer(RENDER_LAYER_BACKGROUND);
+    render_rect((Rectangle) {
+        input->pos.x, input->pos.y, input->size.x, input->size.y
+    }, input->bg_color);
+
+    if(find->active && input->text.count > 0) {
+        draw_find_matches(input);
+    }
 
     if(!input->cursor.is_collapsed && input->focused) {
         draw_selection(input);
@@ -529,7 +1025,24 @@ void handle_input(Input *input)
 
     draw_input_text(input);
 
-    if(input->cursor.is_collapsed && input->focused) {
+    if(is_cursor_visible(input)) {
         draw_cursor(input);
     }
+
+    if(is_dropdown_visible(input)) {
+        draw_dropdown(input);
+    }
+
+    if(find->active) {
+        text_find_draw_bar(
+            find,
+            input->text.count,
+            get_find_bar_rect(input),
+            input->font,
+            input->font_size,
+            input->font_color,
+            input->bg_color,
+            input->border_color
+        );
+    }
 }
@@ -1,9 +1,20 @@
 #ifndef INPUT_H
 #define INPUT_H
 
+#include "autocomplete.h"
 #include "cTooling.h"
+#include "find.h"
+#include "font.h"
+#include "highlight.h"
 #include "raylib.h"
 
+#define FONT_SPACING 2
+#define CURSOR_BLINK_RATE 0.5 // time for the cursor to show and hide in seconds
+#define CURSOR_LINE_WIDTH 2
+#define AUTO_SCROLL_SPEED 8 // scrolled pixels per second for every pixel the mouse is outside
+#define MULTI_CLICK_TIME 0.4 // max time between clicks to count as a double or triple click
+#define DROPDOWN_ROW_PADDING 6 // space above and below every suggestion
+
 typedef struct {
     int left;
     int right;
@@ -23,11 +34,54 @@ typedef struct {
     bool is_collapsed; // true when no text is selected
 } InputCursor;
 
+// positions where a word (or a run of spaces or punctuation) starts, built lazily
+// and only rescanned from the edited position after a change
+typedef struct {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+    size_t scanned; // the boundaries are up to date for text[0..scanned)
+} InputWordBounds;
+
+// x offset where every char starts, items[i] is the width of text[0..i) plus the
+// font spacing. Edits truncate it to the edited position and it's extended lazily,
+// only up to the positions that are measured
+typedef struct {
+    float *items;
+    size_t count;
+    size_t capacity;
+    int font_size; // font size the offsets were measured with
+    unsigned int font_version;
+} InputWidthIndex;
+
+// state that was drawn on the last frame, when it changes the input is damaged
+// so the renderer repaints it
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    bool focused;
+    bool is_collapsed;
+    bool cursor_visible;
+    size_t cursor_pos;
+    InputSelection selection;
+    float scroll;
+    size_t text_version;
+    Rectangle dropdown; // zero when hidden
+    size_t dropdown_highlighted;
+    Rectangle find_bar; // zero when hidden
+    size_t find_version;
+    size_t highlight_version;
+} InputDrawState;
+
 typedef struct {
     Vector2 pos;
     Vector2 size;
     String text;
-    Font font;
+    size_t text_version; // incremented on every change to the text
+    InputDrawState drawn;
+    InputWordBounds word_bounds;
+    InputWidthIndex width_index;
+    UIFont *font;
     int font_size;
     Color font_color;
     const char *placeholder;
@@ -35,24 +89,53 @@ typedef struct {
     bool focused;
     bool hovered;
     InputCursor cursor;
-    int scroll;
+    int click_count; // 1 for single, 2 for double and 3 for triple click
+    double last_click_time;
+    size_t last_click_pos;
+    bool dragging; // a selection is being made with the mouse
+    float scroll;
     Color border_color;
     Color bg_color;
+    bool read_only;
+    RingBuffer *stream; // text written here by another thread is appended to "text"
+    Autocomplete *autocomplete; // suggestions shown under the input, NULL when there are none
+    size_t completed_version;   // text version the suggestions were found for
+    TextFind find; // ctrl + f highlights the matches of a query, shown under the input
+    Highlighter *highlighter; // colors the tokens of the text, NULL when it's plain
 } Input;
 
 typedef struct {
     Vector2 pos;
     Vector2 size;
-    Font font;
+    UIFont *font;
     int font_size;
     Color font_color;
     const char *placeholder;
     Padding padding;
     Color border_color;
     Color bg_color;
+    bool read_only;
 } InputProps;
 
 Input *create_input(InputProps props);
 void handle_input(Input *input);
+// the input becomes the consumer of "stream", whatever is in it gets appended
+// to the text at the start of every handle_input call
+void input_attach_stream(Input *input, RingBuffer *stream);
+// shows the completions of the text from "index" in a dropdown, the arrows pick one
+// and tab or enter accept it
+void input_attach_autocomplete(Input *input, AutocompleteIndex *index);
+// colors the text with the tokens of "lexer", only the text around an edit is lexed again
+void input_attach_lexer(Input *input, Lexer *lexer);
+
+// shared with the other text widgets
+bool is_ctrl_down(void);
+// 0 for spaces, 1 for word characters (the bytes of multibyte chars too) and 2 for
+// everything else
+int get_chr_class(char c);
+// returns a selection where the start is always smaller than the end
+InputSelection get_corrected_selection(InputSelection selection);
+// "text" doesn't have to be null terminated
+void copy_to_clipboard(const char *text, size_t size);
 
 #endif // INPUT_H
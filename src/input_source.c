@@ -0,0 +1,359 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "input_source.h"
+
+#define INPUT_SOURCE_MAGIC "CUIR"
+#define INPUT_SOURCE_VERSION 2
+#define INPUT_SOURCE_KEY_COUNT 512
+#define INPUT_SOURCE_BUTTON_COUNT 3
+#define INPUT_SOURCE_NO_CLIPBOARD UINT32_MAX
+
+// flags of a key in the frame snapshot
+#define KEY_FLAG_DOWN 1
+#define KEY_FLAG_PRESSED 2
+#define KEY_FLAG_REPEAT 4
+
+typedef struct {
+    int *items;
+    size_t count;
+    size_t capacity;
+} InputChars;
+
+// Log layout, in native byte order:
+//   header: "CUIR", u32 version
+//   frame:  f64 time, f32 frame time, f32 mouse x, f32 mouse y, f32 wheel,
+//           u8 buttons down, u8 buttons pressed, u8 buttons released,
+//           u16 char count, u16 key count, u32 clipboard size or UINT32_MAX,
+//           i32 chars[], {u16 key, u8 flags} keys[], clipboard bytes
+typedef struct {
+    double time;
+    float frame_time;
+    Vector2 mouse;
+    float wheel;
+    uint8_t buttons_down;
+    uint8_t buttons_pressed;
+    uint8_t buttons_released;
+    InputChars chars;
+    size_t next_char;
+    uint8_t keys[INPUT_SOURCE_KEY_COUNT];
+    String clipboard; // null terminated
+    bool has_clipboard;
+} InputFrame;
+
+static struct {
+    InputSourceMode mode;
+    InputFrame frame;
+    FILE *log;
+    String buffer; // frame being written, or the whole log when replaying
+    size_t read_pos;
+} source = {0};
+
+static bool is_valid_key(int key)
+{
+    return key >= 0 && key < INPUT_SOURCE_KEY_COUNT;
+}
+
+static bool is_valid_button(int button)
+{
+    return button >= 0 && button < INPUT_SOURCE_BUTTON_COUNT;
+}
+
+bool input_source_record(const char *path)
+{
+    input_source_close();
+
+    source.log = fopen(path, "wb");
+    if(source.log == NULL) return false;
+
+    uint32_t version = INPUT_SOURCE_VERSION;
+    fwrite(INPUT_SOURCE_MAGIC, 1, 4, source.log);
+    fwrite(&version, sizeof(version), 1, source.log);
+
+    source.mode = INPUT_SOURCE_RECORD;
+    return true;
+}
+
+bool input_source_replay(const char *path)
+{
+    input_source_close();
+
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) return false;
+
+    char chunk[4096];
+    size_t size;
+    while((size = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        da_append_many(&source.buffer, chunk, size);
+    }
+    fclose(file);
+
+    uint32_t version = 0;
+    if(source.buffer.count < 8) return false;
+    memcpy(&version, source.buffer.items + 4, sizeof(version));
+    if(memcmp(source.buffer.items, INPUT_SOURCE_MAGIC, 4) != 0 || version != INPUT_SOURCE_VERSION) {
+        return false;
+    }
+
+    source.read_pos = 8;
+    source.mode = INPUT_SOURCE_REPLAY;
+    return true;
+}
+
+void input_source_close(void)
+{
+    if(source.log != NULL) fclose(source.log);
+    source.log = NULL;
+    source.mode = INPUT_SOURCE_LIVE;
+    source.buffer.count = 0;
+    source.read_pos = 0;
+}
+
+InputSourceMode input_source_get_mode(void)
+{
+    return source.mode;
+}
+
+static void capture_frame(InputFrame *frame)
+{
+    frame->time = GetTime();
+    frame->frame_time = GetFrameTime();
+    frame->mouse = GetMousePosition();
+    frame->wheel = GetMouseWheelMove();
+
+    for(int i = 0; i < INPUT_SOURCE_BUTTON_COUNT; i++) {
+        if(IsMouseButtonDown(i)) frame->buttons_down |= 1 << i;
+        if(IsMouseButtonPressed(i)) frame->buttons_pressed |= 1 << i;
+        if(IsMouseButtonReleased(i)) frame->buttons_released |= 1 << i;
+    }
+
+    int chr;
+    while((chr = GetCharPressed()) != 0) da_append(&frame->chars, chr);
+
+    // raylib ignores the key 0
+    for(int key = 1; key < INPUT_SOURCE_KEY_COUNT; key++) {
+        uint8_t flags = 0;
+        if(IsKeyDown(key)) flags |= KEY_FLAG_DOWN;
+        if(IsKeyPressed(key)) flags |= KEY_FLAG_PRESSED;
+        if(IsKeyPressedRepeat(key)) flags |= KEY_FLAG_REPEAT;
+        frame->keys[key] = flags;
+    }
+}
+
+#define write_value(buffer, value) da_append_many((buffer), (const char *)&(value), sizeof(value))
+
+static void write_frame(InputFrame *frame)
+{
+    String *buffer = &source.buffer;
+    buffer->count = 0;
+
+    uint16_t char_count = frame->chars.count;
+    uint16_t key_count = 0;
+    for(int key = 0; key < INPUT_SOURCE_KEY_COUNT; key++) {
+        if(frame->keys[key] != 0) key_count++;
+    }
+    uint32_t clipboard_size = INPUT_SOURCE_NO_CLIPBOARD;
+    if(frame->has_clipboard) clipboard_size = frame->clipboard.count - 1;
+
+    write_value(buffer, frame->time);
+    write_value(buffer, frame->frame_time);
+    write_value(buffer, frame->mouse.x);
+    write_value(buffer, frame->mouse.y);
+    write_value(buffer, frame->wheel);
+    write_value(buffer, frame->buttons_down);
+    write_value(buffer, frame->buttons_pressed);
+    write_value(buffer, frame->buttons_released);
+    write_value(buffer, char_count);
+    write_value(buffer, key_count);
+    write_value(buffer, clipboard_size);
+
+    for(size_t i = 0; i < char_count; i++) {
+        int32_t chr = frame->chars.items[i];
+        write_value(buffer, chr);
+    }
+
+    for(int i = 0; i < INPUT_SOURCE_KEY_COUNT; i++) {
+        if(frame->keys[i] == 0) continue;
+        uint16_t key = i;
+        write_value(buffer, key);
+        write_value(buffer, frame->keys[i]);
+    }
+
+    if(frame->has_clipboard) da_append_many(buffer, frame->clipboard.items, clipboard_size);
+
+    fwrite(buffer->items, 1, buffer->count, source.log);
+}
+
+#define read_value(value) read_bytes(&(value), sizeof(value))
+
+static bool read_bytes(void *dest, size_t size)
+{
+    if(source.read_pos + size > source.buffer.count) return false;
+
+    memcpy(dest, source.buffer.items + source.read_pos, size);
+    source.read_pos += size;
+    return true;
+}
+
+// a truncated frame ends the replay
+static bool read_frame(InputFrame *frame)
+{
+    uint16_t char_count;
+    uint16_t key_count;
+    uint32_t clipboard_size;
+
+    bool ok = read_value(frame->time)
+        && read_value(frame->frame_time)
+        && read_value(frame->mouse.x)
+        && read_value(frame->mouse.y)
+        && read_value(frame->wheel)
+        && read_value(frame->buttons_down)
+        && read_value(frame->buttons_pressed)
+        && read_value(frame->buttons_released)
+        && read_value(char_count)
+        && read_value(key_count)
+        && read_value(clipboard_size);
+    if(!ok) return false;
+
+    for(size_t i = 0; i < char_count; i++) {
+        int32_t chr;
+        if(!read_value(chr)) return false;
+        da_append(&frame->chars, chr);
+    }
+
+    for(size_t i = 0; i < key_count; i++) {
+        uint16_t key;
+        uint8_t flags;
+        if(!read_value(key) || !read_value(flags)) return false;
+        if(is_valid_key(key)) frame->keys[key] = flags;
+    }
+
+    if(clipboard_size != INPUT_SOURCE_NO_CLIPBOARD) {
+        if(source.read_pos + clipboard_size > source.buffer.count) return false;
+
+        da_append_many(&frame->clipboard, source.buffer.items + source.read_pos, clipboard_size);
+        da_append(&frame->clipboard, '\0');
+        source.read_pos += clipboard_size;
+        frame->has_clipboard = true;
+    }
+
+    return true;
+}
+
+bool input_source_begin_frame(void)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return true;
+
+    // the buffers of the last frame are reused
+    InputFrame *frame = &source.frame;
+    InputChars chars = frame->chars;
+    String clipboard = frame->clipboard;
+    memset(frame, 0, sizeof(*frame));
+    frame->chars = chars;
+    frame->chars.count = 0;
+    frame->clipboard = clipboard;
+    frame->clipboard.count = 0;
+
+    if(source.mode == INPUT_SOURCE_RECORD) {
+        capture_frame(frame);
+        return true;
+    }
+
+    return read_frame(frame);
+}
+
+void input_source_end_frame(void)
+{
+    if(source.mode == INPUT_SOURCE_RECORD) write_frame(&source.frame);
+}
+
+double input_source_get_time(void)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return GetTime();
+    return source.frame.time;
+}
+
+float input_source_get_frame_time(void)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return GetFrameTime();
+    return source.frame.frame_time;
+}
+
+int input_source_get_char(void)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return GetCharPressed();
+
+    InputFrame *frame = &source.frame;
+    if(frame->next_char == frame->chars.count) return 0;
+    return frame->chars.items[frame->next_char++];
+}
+
+bool input_source_is_key_down(int key)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return IsKeyDown(key);
+    return is_valid_key(key) && (source.frame.keys[key] & KEY_FLAG_DOWN);
+}
+
+bool input_source_is_key_pressed(int key)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return IsKeyPressed(key);
+    return is_valid_key(key) && (source.frame.keys[key] & KEY_FLAG_PRESSED);
+}
+
+bool input_source_is_key_pressed_repeat(int key)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return IsKeyPressedRepeat(key);
+    return is_valid_key(key) && (source.frame.keys[key] & KEY_FLAG_REPEAT);
+}
+
+Vector2 input_source_get_mouse_position(void)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return GetMousePosition();
+    return source.frame.mouse;
+}
+
+float input_source_get_mouse_wheel_move(void)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return GetMouseWheelMove();
+    return source.frame.wheel;
+}
+
+bool input_source_is_mouse_button_down(int button)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return IsMouseButtonDown(button);
+    return is_valid_button(button) && (source.frame.buttons_down & (1 << button));
+}
+
+bool input_source_is_mouse_button_pressed(int button)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return IsMouseButtonPressed(button);
+    return is_valid_button(button) && (source.frame.buttons_pressed & (1 << button));
+}
+
+bool input_source_is_mouse_button_released(int button)
+{
+    if(source.mode == INPUT_SOURCE_LIVE) return IsMouseButtonReleased(button);
+    return is_valid_button(button) && (source.frame.buttons_released & (1 << button));
+}
+
+const char *input_source_get_clipboard_text(void)
+{
+    InputFrame *frame = &source.frame;
+
+    if(source.mode == INPUT_SOURCE_LIVE) return GetClipboardText();
+
+    if(source.mode == INPUT_SOURCE_RECORD && !frame->has_clipboard) {
+        const char *text = GetClipboardText();
+        if(text == NULL) text = "";
+        da_append_many(&frame->clipboard, text, strlen(text) + 1);
+        frame->has_clipboard = true;
+    }
+
+    // the replay gets what was in the clipboard when it was recorded
+    return frame->has_clipboard ? frame->clipboard.items : "";
+}
+
+void input_source_set_clipboard_text(const char *text)
+{
+    if(source.mode != INPUT_SOURCE_REPLAY) SetClipboardText(text);
+}
@@ -0,0 +1,41 @@
+#ifndef INPUT_SOURCE_H
+#define INPUT_SOURCE_H
+
+#include "cTooling.h"
+#include "raylib.h"
+
+// Every event the widgets consume goes through here. In the live mode the calls
+// go straight to raylib. When recording, the whole input state is captured at the
+// start of the frame and written to a binary log, the replay reads it back with
+// no window so real sessions can be run at full speed
+typedef enum {
+    INPUT_SOURCE_LIVE,
+    INPUT_SOURCE_RECORD,
+    INPUT_SOURCE_REPLAY,
+} InputSourceMode;
+
+bool input_source_record(const char *path);
+bool input_source_replay(const char *path);
+void input_source_close(void);
+InputSourceMode input_source_get_mode(void);
+
+// have to wrap all the widgets of a frame, begin returns false when the replay ended
+bool input_source_begin_frame(void);
+void input_source_end_frame(void);
+
+double input_source_get_time(void);
+float input_source_get_frame_time(void);
+int input_source_get_char(void);
+bool input_source_is_key_down(int key);
+bool input_source_is_key_pressed(int key);
+bool input_source_is_key_pressed_repeat(int key);
+Vector2 input_source_get_mouse_position(void);
+float input_source_get_mouse_wheel_move(void);
+bool input_source_is_mouse_button_down(int button);
+bool input_source_is_mouse_button_pressed(int button);
+bool input_source_is_mouse_button_released(int button);
+// the clipboard is only recorded in the frames that read it
+const char *input_source_get_clipboard_text(void);
+void input_source_set_clipboard_text(const char *text);
+
+#endif // INPUT_SOURCE_H
@@ -0,0 +1,80 @@
+#include <stdio.h>
+
+#include "latency.h"
+#include "raylib.h"
+
+static struct {
+    bool enabled;
+    LatencyEvents events;
+    size_t pending;   // first event that wasn't presented yet
+    size_t frame;
+    double sampled;
+} latency = {0};
+
+void latency_enable(bool enabled)
+{
+    latency.enabled = enabled;
+}
+
+bool latency_is_enabled(void)
+{
+    return latency.enabled;
+}
+
+void latency_mark_sampled(void)
+{
+    if(!latency.enabled) return;
+    latency.sampled = GetTime();
+}
+
+void latency_mark_char(int codepoint)
+{
+    if(!latency.enabled) return;
+
+    LatencyEvent event = {
+        .codepoint = codepoint,
+        .sampled = latency.sampled,
+    };
+    da_append(&latency.events, event);
+}
+
+void latency_mark_presented(void)
+{
+    if(!latency.enabled) return;
+
+    double now = GetTime();
+    LatencyEvents *events = &latency.events;
+    for(; latency.pending < events->count; latency.pending++) {
+        events->items[latency.pending].frame = latency.frame;
+        events->items[latency.pending].presented = now;
+    }
+    latency.frame++;
+}
+
+const LatencyEvents *latency_get_events(void)
+{
+    return &latency.events;
+}
+
+void latency_reset(void)
+{
+    latency.events.count = 0;
+    latency.pending = 0;
+}
+
+bool latency_write_csv(const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if(out == NULL) return false;
+
+    fprintf(out, "codepoint,frame,sampled_ms,presented_ms,latency_ms\n");
+    for(size_t i = 0; i < latency.pending; i++) {
+        LatencyEvent *event = &latency.events.items[i];
+        fprintf(out, "%d,%zu,%.3f,%.3f,%.3f\n",
+            event->codepoint, event->frame, event->sampled*1000, event->presented*1000,
+            (event->presented - event->sampled)*1000);
+    }
+
+    fclose(out);
+    return true;
+}
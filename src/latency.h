@@ -0,0 +1,35 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include "cTooling.h"
+
+// Keystroke to photon instrumentation. Every typed character is timestamped
+// when the input is sampled and again when the frame that shows it is presented
+typedef struct {
+    int codepoint;
+    size_t frame;     // frame in which the character became visible
+    double sampled;   // seconds, when the input that contained it was polled
+    double presented; // seconds, when the buffer swap of that frame returned, 0 until then
+} LatencyEvent;
+
+typedef struct {
+    LatencyEvent *items;
+    size_t count;
+    size_t capacity;
+} LatencyEvents;
+
+// recording is off by default, so the marks cost a branch when not measuring
+void latency_enable(bool enabled);
+bool latency_is_enabled(void);
+
+void latency_mark_sampled(void);
+void latency_mark_char(int codepoint);
+void latency_mark_presented(void);
+
+const LatencyEvents *latency_get_events(void);
+void latency_reset(void);
+
+// one line per presented event: codepoint,frame,sampled_ms,presented_ms,latency_ms
+bool latency_write_csv(const char *path);
+
+#endif // LATENCY_H
@@ -0,0 +1,339 @@
+#include <math.h>
+
+#include "list.h"
+#include "input_source.h"
+#include "render.h"
+
+List *create_list(ListProps props)
+{
+    List *list = malloc(sizeof(List));
+    bzero(list, sizeof(List));
+
+    list->pos = props.pos;
+    list->size = props.size;
+    list->source = props.source;
+    list->font = props.font;
+    list->font_size = props.font_size;
+    list->font_color = props.font_color;
+    list->padding = props.padding;
+    list->row_height = props.row_height;
+    list->border_color = props.border_color;
+    list->bg_color = props.bg_color;
+    list->selection_color = props.selection_color;
+    list->selected = SIZE_MAX;
+
+    for(size_t i = 0; i < LIST_ROW_POOL_SIZE; i++) {
+        list->rows[i].index = SIZE_MAX;
+    }
+
+    return list;
+}
+
+static bool has_variable_heights(List *list)
+{
+    return list->source.get_height != NULL;
+}
+
+static bool is_measured(List *list, size_t row)
+{
+    return (list->measured.items[row / 64] >> (row % 64)) & 1;
+}
+
+// pulls the number of rows, the new ones start with the default height
+static void sync_count(List *list)
+{
+    size_t count = list->source.get_count(list->source.data);
+    list->count = count;
+    if(list->selected != SIZE_MAX && list->selected >= count) {
+        list->selected = count == 0 ? SIZE_MAX : count - 1;
+    }
+
+    if(!has_variable_heights(list)) return;
+
+    Fenwick *heights = &list->heights;
+    ListMeasured *measured = &list->measured;
+    size_t words = (count + 63) / 64;
+
+    if(count < heights->count) {
+        heights->count = count;
+        // the removed rows can come back with other heights
+        if(count % 64 != 0) measured->items[words - 1] &= ((uint64_t)1 << (count % 64)) - 1;
+        measured->count = words;
+    }
+
+    da_reserve(measured, words);
+    while(measured->count < words) measured->items[measured->count++] = 0;
+    while(heights->count < count) fenwick_push(heights, list->row_height);
+}
+
+static Rectangle get_list_box(List *list)
+{
+    return (Rectangle) {
+        list->pos.x + list->padding.left,
+        list->pos.y + list->padding.top,
+        list->size.x - list->padding.left - list->padding.right,
+        list->size.y - list->padding.top - list->padding.bottom,
+    };
+}
+
+// y of the top of the row from the top of the first one
+static double get_row_y(List *list, size_t row)
+{
+    if(has_variable_heights(list)) return fenwick_prefix(&list->heights, row);
+    return row * (double)list->row_height;
+}
+
+static double get_row_height(List *list, size_t row)
+{
+    if(!has_variable_heights(list)) return list->row_height;
+    return fenwick_prefix(&list->heights, row + 1) - fenwick_prefix(&list->heights, row);
+}
+
+// row at "y" from the top of the first one, the row count when it's past the last
+static size_t get_row_at_y(List *list, double y)
+{
+    if(y < 0) y = 0;
+    if(has_variable_heights(list)) return fenwick_search(&list->heights, y);
+
+    size_t row = y / list->row_height;
+    return row < list->count ? row : list->count;
+}
+
+static double clamp_scroll(List *list, double scroll)
+{
+    double max_scroll = get_row_y(list, list->count) - get_list_box(list).height;
+
+    if(scroll > max_scroll) scroll = max_scroll;
+    if(scroll < 0) scroll = 0;
+    return scroll;
+}
+
+// pulls the height of the row when it was never shown. The scroll and its target
+// move along with the rows after it, so they keep showing the same rows
+static void measure_row(List *list, size_t row)
+{
+    if(!has_variable_heights(list) || is_measured(list, row)) return;
+
+    float height = list->source.get_height(list->source.data, row);
+    size_t new_height = height < 1 ? 1 : height + 0.5;
+    size_t old_height = get_row_height(list, row);
+    fenwick_add(&list->heights, row, new_height - old_height);
+    list->measured.items[row / 64] |= (uint64_t)1 << (row % 64);
+
+    double y = get_row_y(list, row);
+    double delta = (double)new_height - old_height;
+    if(y < list->scroll) list->scroll += delta;
+    if(y < list->scroll_target) list->scroll_target += delta;
+}
+
+void list_scroll_to(List *list, size_t row)
+{
+    if(row >= list->count) return;
+
+    Rectangle box = get_list_box(list);
+    // the rows that can be shown above it are measured first, measuring them once
+    // they are drawn would push the row out of the view
+    double above = 0;
+    for(size_t i = row + 1; i > 0 && above < box.height; i--) {
+        measure_row(list, i - 1);
+        above += get_row_height(list, i - 1);
+    }
+
+    double y = get_row_y(list, row);
+    double height = get_row_height(list, row);
+
+    double target = list->scroll_target;
+    if(y < target) {
+        target = y;
+    } else if(y + height > target + box.height) {
+        target = y + height - box.height;
+    }
+
+    list->scroll_target = clamp_scroll(list, target);
+}
+
+void list_invalidate(List *list)
+{
+    list->version++;
+    // the heights are pulled again as the rows are shown
+    list->heights.count = 0;
+    list->measured.count = 0;
+}
+
+// text of the row, pulled from the source when the row gets visible
+static ListRow *get_row(List *list, size_t index)
+{
+    ListRow *row = &list->rows[index % LIST_ROW_POOL_SIZE];
+    if(row->index == index && row->version == list->version) return row;
+
+    // the slot of a row that left the viewport is recycled along with its buffer
+    row->index = index;
+    row->version = list->version;
+    row->text.count = 0;
+    list->source.get_text(list->source.data, index, &row->text);
+
+    return row;
+}
+
+// pulls the heights of the visible rows that were never shown, the rows before the
+// first visible one don't change so the scroll stays where it is
+static void measure_visible_rows(List *list)
+{
+    if(!has_variable_heights(list)) return;
+
+    Rectangle box = get_list_box(list);
+    size_t row = get_row_at_y(list, list->scroll);
+
+    for(size_t shown = 0; row < list->count && shown < LIST_ROW_POOL_SIZE; row++, shown++) {
+        if(get_row_y(list, row) >= list->scroll + box.height) break;
+        measure_row(list, row);
+    }
+}
+
+static bool is_key_active(int key)
+{
+    return input_source_is_key_pressed(key) || input_source_is_key_pressed_repeat(key);
+}
+
+static void handle_mouse(List *list)
+{
+    Vector2 mouse = input_source_get_mouse_position();
+    Rectangle rect = {list->pos.x, list->pos.y, list->size.x, list->size.y};
+    list->hovered = CheckCollisionPointRec(mouse, rect);
+
+    // the focus changes on press, like the other widgets
+    if(input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        list->focused = list->hovered;
+    }
+
+    float wheel = input_source_get_mouse_wheel_move();
+    if(list->hovered && wheel != 0) {
+        double scroll = list->scroll_target - wheel * LIST_WHEEL_ROWS * list->row_height;
+        list->scroll_target = clamp_scroll(list, scroll);
+    }
+
+    Rectangle box = get_list_box(list);
+    bool pressed = input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT);
+    if(pressed && CheckCollisionPointRec(mouse, box)) {
+        size_t row = get_row_at_y(list, mouse.y - box.y + list->scroll);
+        if(row < list->count) list->selected = row;
+    }
+}
+
+static void handle_keys(List *list)
+{
+    if(list->count == 0) return;
+
+    // a page is measured with the default height
+    size_t page = get_list_box(list).height / list->row_height;
+    size_t selected = list->selected;
+    bool none = selected == SIZE_MAX;
+
+    if(is_key_active(KEY_DOWN)) {
+        selected = none ? 0 : selected + 1;
+    } else if(is_key_active(KEY_UP)) {
+        selected = none || selected == 0 ? 0 : selected - 1;
+    } else if(is_key_active(KEY_PAGE_DOWN)) {
+        selected = none ? page : selected + page;
+    } else if(is_key_active(KEY_PAGE_UP)) {
+        selected = none || selected < page ? 0 : selected - page;
+    } else if(input_source_is_key_pressed(KEY_HOME)) {
+        selected = 0;
+    } else if(input_source_is_key_pressed(KEY_END)) {
+        selected = list->count - 1;
+    } else {
+        return;
+    }
+
+    if(selected >= list->count) selected = list->count - 1;
+    list->selected = selected;
+    list_scroll_to(list, selected);
+}
+
+// the scroll eases towards its target, so the wheel scrolls pixel by pixel
+static void update_scroll(List *list)
+{
+    float t = input_source_get_frame_time() * LIST_SCROLL_SPEED;
+    if(t > 1) t = 1;
+
+    list->scroll_target = clamp_scroll(list, list->scroll_target);
+    list->scroll += (list->scroll_target - list->scroll) * t;
+    if(fabs(list->scroll_target - list->scroll) < 0.5) list->scroll = list->scroll_target;
+}
+
+static void draw_rows(List *list)
+{
+    Rectangle box = get_list_box(list);
+    render_push_clip(box);
+
+    size_t index = get_row_at_y(list, list->scroll);
+    for(size_t shown = 0; index < list->count && shown < LIST_ROW_POOL_SIZE; index++, shown++) {
+        // only the offset from the scroll is small enough for a float
+        float y = box.y + (float)(get_row_y(list, index) - list->scroll);
+        if(y >= box.y + box.height) break;
+
+        float height = get_row_height(list, index);
+        if(index == list->selected) {
+            render_set_layer(RENDER_LAYER_HIGHLIGHT);
+            render_rect((Rectangle) {box.x, y, box.width, height}, list->selection_color);
+        }
+
+        ListRow *row = get_row(list, index);
+        render_set_layer(RENDER_LAYER_TEXT);
+        ui_font_draw(
+            list->font,
+            row->text.items,
+            row->text.count,
+            (Vector2) {box.x, y + (height - list->font_size) / 2},
+            list->font_size,
+            FONT_SPACING,
+            list->font_color
+        );
+    }
+
+    render_pop_clip();
+}
+
+// same as the damage of Input
+static void damage_changes(List *list)
+{
+    ListDrawState state;
+    memset(&state, 0, sizeof(state));
+    state.pos = list->pos;
+    state.size = list->size;
+    state.focused = list->focused;
+    state.selected = list->selected;
+    state.scroll = list->scroll;
+    state.count = list->count;
+    state.version = list->version;
+
+    ListDrawState *drawn = &list->drawn;
+    if(memcmp(&state, drawn, sizeof(state)) != 0) {
+        render_add_damage((Rectangle) {drawn->pos.x, drawn->pos.y, drawn->size.x, drawn->size.y});
+        render_add_damage((Rectangle) {list->pos.x, list->pos.y, list->size.x, list->size.y});
+    }
+
+    *drawn = state;
+}
+
+void handle_list(List *list)
+{
+    sync_count(list);
+    handle_mouse(list);
+    if(list->focused) handle_keys(list);
+    update_scroll(list);
+    measure_visible_rows(list);
+
+    damage_changes(list);
+
+    Rectangle rect = {list->pos.x, list->pos.y, list->size.x, list->size.y};
+    render_set_layer(RENDER_LAYER_BACKGROUND);
+    render_rect(rect, list->bg_color);
+
+    draw_rows(list);
+
+    if(list->focused) {
+        render_set_layer(RENDER_LAYER_OVERLAY);
+        render_rect_lines(rect, 2, list->border_color);
+    }
+}
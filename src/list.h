@@ -0,0 +1,100 @@
+#ifndef LIST_H
+#define LIST_H
+
+#include "cTooling.h"
+#include "font.h"
+#include "input.h"
+#include "raylib.h"
+
+#define LIST_ROW_POOL_SIZE 256 // max rows shown at once
+#define LIST_WHEEL_ROWS 3      // rows scrolled by every step of the mouse wheel
+#define LIST_SCROLL_SPEED 20   // fraction of the distance to the target scrolled per second
+
+// The rows are pulled from the source, only the visible ones are asked for, so the
+// cost of a frame doesn't depend on the number of rows
+typedef struct {
+    void *data;
+    size_t (*get_count)(void *data);
+    // height of the row in pixels, NULL when all the rows are "row_height" high
+    float (*get_height)(void *data, size_t row);
+    // appends the text of the row to "text", that is empty
+    void (*get_text)(void *data, size_t row, String *text);
+} ListSource;
+
+// slot of the pool, a row is kept in the slot "index % LIST_ROW_POOL_SIZE" so the
+// visible rows never take the same one
+typedef struct {
+    size_t index; // row in the slot, SIZE_MAX when it's empty
+    unsigned int version; // list version the text was pulled at
+    String text;
+} ListRow;
+
+// rows whose height was pulled, one bit per row
+typedef struct {
+    uint64_t *items;
+    size_t count;
+    size_t capacity;
+} ListMeasured;
+
+// state that was drawn on the last frame, like InputDrawState
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    bool focused;
+    size_t selected;
+    double scroll;
+    size_t count;
+    unsigned int version;
+} ListDrawState;
+
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    ListSource source;
+    size_t count;         // rows pulled at the start of the frame
+    unsigned int version; // incremented by list_invalidate
+    ListDrawState drawn;
+    ListRow rows[LIST_ROW_POOL_SIZE];
+    // with variable heights the heights of the rows that were never shown are
+    // "row_height", they are pulled when the row gets visible
+    Fenwick heights;
+    ListMeasured measured;
+    UIFont *font;
+    int font_size;
+    Color font_color;
+    Padding padding;
+    float row_height;
+    bool focused;
+    bool hovered;
+    size_t selected; // SIZE_MAX when no row is selected
+    // pixels, it moves towards "scroll_target" on every frame. They are doubles since
+    // millions of rows go past the pixels a float can address
+    double scroll;
+    double scroll_target;
+    Color border_color;
+    Color bg_color;
+    Color selection_color;
+} List;
+
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    ListSource source;
+    UIFont *font;
+    int font_size;
+    Color font_color;
+    Padding padding;
+    float row_height;
+    Color border_color;
+    Color bg_color;
+    Color selection_color;
+} ListProps;
+
+List *create_list(ListProps props);
+void handle_list(List *list);
+// the data of the source changed, the rows are pulled again
+void list_invalidate(List *list);
+// scrolls the least needed to show the whole row
+void list_scroll_to(List *list, size_t row);
+
+#endif // LIST_H
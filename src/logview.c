@@ -0,0 +1,564 @@
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "logview.h"
+#include "input_source.h"
+#include "render.h"
+
+// mapped ranges of the views, read by the SIGBUS handler from any thread
+static struct {
+    const char *volatile data;
+    volatile size_t size;
+} guarded_views[LOG_VIEW_MAX_VIEWS];
+static struct sigaction previous_sigbus;
+static size_t page_size;
+
+// read only pages of zeros over text[0..size), they replace the pages of the file
+static bool map_zero_pages(const char *text, size_t size)
+{
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+    return mmap((void *)text, size, PROT_READ, flags, -1, 0) != MAP_FAILED;
+}
+
+// a page past the end of a truncated file raises SIGBUS when it's read, by the UI
+// or by the indexer. The page is replaced with zeros and the read is retried, the
+// shrink is noticed by the next poll
+static void handle_sigbus(int sig, siginfo_t *info, void *context)
+{
+    const char *addr = info->si_addr;
+    for(size_t i = 0; i < LOG_VIEW_MAX_VIEWS; i++) {
+        const char *data = guarded_views[i].data;
+        if(data == NULL || addr < data || addr >= data + guarded_views[i].size) continue;
+
+        const char *page = data + (addr - data) / page_size * page_size;
+        if(map_zero_pages(page, page_size)) return;
+    }
+
+    // not a page of a view, the handler that was there before takes it
+    if(previous_sigbus.sa_flags & SA_SIGINFO) {
+        previous_sigbus.sa_sigaction(sig, info, context);
+    } else if(previous_sigbus.sa_handler != SIG_DFL && previous_sigbus.sa_handler != SIG_IGN) {
+        previous_sigbus.sa_handler(sig);
+    } else {
+        // the access is retried and raises it again with the default action
+        signal(SIGBUS, SIG_DFL);
+    }
+}
+
+static void guard_view(LogView *view)
+{
+    if(page_size == 0) {
+        page_size = sysconf(_SC_PAGESIZE);
+
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_sigaction = handle_sigbus;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &previous_sigbus);
+    }
+
+    for(size_t i = 0; i < LOG_VIEW_MAX_VIEWS; i++) {
+        if(guarded_views[i].data != NULL) continue;
+        guarded_views[i].size = view->reserved;
+        guarded_views[i].data = view->data;
+        return;
+    }
+    assert(false && "Too many log views");
+}
+
+static void unguard_view(LogView *view)
+{
+    for(size_t i = 0; i < LOG_VIEW_MAX_VIEWS; i++) {
+        if(guarded_views[i].data == view->data) guarded_views[i].data = NULL;
+    }
+}
+
+// maps the pages of the file up to "size" after the ones already mapped, false when
+// the file outgrew the reserved address space
+static bool map_pages(LogView *view, size_t size)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t end = (size + page - 1) / page * page;
+    if(end <= view->mapped) return true;
+    if(end > view->reserved) return false;
+
+    void *pages = mmap(
+        (char *)view->data + view->mapped, end - view->mapped,
+        PROT_READ, MAP_SHARED | MAP_FIXED, view->fd, view->mapped
+    );
+    if(pages == MAP_FAILED) return false;
+
+    view->mapped = end;
+    return true;
+}
+
+static void push_checkpoint(LogView *view, size_t offset)
+{
+    size_t block = view->checkpoint_count / LOG_VIEW_BLOCK_SIZE;
+    assert(block < LOG_VIEW_MAX_BLOCKS && "Too many lines");
+
+    if(view->blocks[block] == NULL) {
+        view->blocks[block] = malloc(LOG_VIEW_BLOCK_SIZE*sizeof(uint64_t));
+        assert(view->blocks[block] != NULL && "No enough ram");
+    }
+
+    view->blocks[block][view->checkpoint_count % LOG_VIEW_BLOCK_SIZE] = offset;
+    view->checkpoint_count++;
+}
+
+// indexes the file a few MB at a time and waits for it to grow once it's done
+static void *run_indexer(void *arg)
+{
+    LogView *view = arg;
+    size_t indexed = 0;
+    size_t newline_count = 0;
+    size_t last_line_start = 0;
+
+    pthread_mutex_lock(&view->lock);
+    while(!view->quit) {
+        size_t size = view->file_size;
+        if(indexed == size) {
+            pthread_cond_wait(&view->wake, &view->lock);
+            continue;
+        }
+        pthread_mutex_unlock(&view->lock);
+
+        size_t end = size - indexed > LOG_VIEW_SCAN_SIZE ? indexed + LOG_VIEW_SCAN_SIZE : size;
+        const char *c = view->data + indexed;
+        const char *scan_end = view->data + end;
+        while(c < scan_end && (c = memchr(c, '\n', scan_end - c)) != NULL) {
+            c++;
+            newline_count++;
+            last_line_start = c - view->data;
+            if(newline_count % LOG_VIEW_CHECKPOINT_LINES == 0) {
+                push_checkpoint(view, last_line_start);
+            }
+        }
+        indexed = end;
+
+        pthread_mutex_lock(&view->lock);
+        view->indexed = indexed;
+        view->newline_count = newline_count;
+        view->last_line_start = last_line_start;
+    }
+    pthread_mutex_unlock(&view->lock);
+
+    return NULL;
+}
+
+LogView *create_log_view(InputProps props, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) return NULL;
+
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // only address space, the pages of the file are mapped over it
+    size_t reserved = st.st_size + LOG_VIEW_RESERVE;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+    void *data = mmap(NULL, reserved, PROT_NONE, flags, -1, 0);
+    if(data == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+
+    LogView *view = malloc(sizeof(LogView));
+    assert(view != NULL && "No enough ram");
+    bzero(view, sizeof(LogView));
+
+    view->pos = props.pos;
+    view->size = props.size;
+    view->font = props.font;
+    view->font_size = props.font_size;
+    view->font_color = props.font_color;
+    view->padding = props.padding;
+    view->border_color = props.border_color;
+    view->bg_color = props.bg_color;
+    view->follow = true;
+
+    view->fd = fd;
+    view->data = data;
+    view->reserved = reserved;
+    if(!map_pages(view, st.st_size)) {
+        munmap(data, reserved);
+        close(fd);
+        free(view);
+        return NULL;
+    }
+    view->file_size = st.st_size;
+    view->last_poll_time = input_source_get_time();
+    guard_view(view);
+
+    // the first line starts at the start of the file
+    push_checkpoint(view, 0);
+
+    pthread_mutex_init(&view->lock, NULL);
+    pthread_cond_init(&view->wake, NULL);
+    pthread_create(&view->indexer, NULL, run_indexer, view);
+
+    return view;
+}
+
+void destroy_log_view(LogView *view)
+{
+    pthread_mutex_lock(&view->lock);
+    view->quit = true;
+    pthread_cond_signal(&view->wake);
+    pthread_mutex_unlock(&view->lock);
+    pthread_join(view->indexer, NULL);
+
+    pthread_mutex_destroy(&view->lock);
+    pthread_cond_destroy(&view->wake);
+
+    unguard_view(view);
+    munmap((void *)view->data, view->reserved);
+    close(view->fd);
+    for(size_t i = 0; i < LOG_VIEW_MAX_BLOCKS && view->blocks[i] != NULL; i++) {
+        free(view->blocks[i]);
+    }
+    free(view);
+}
+
+// the new pages are mapped right away, the indexer learns about them when the lock
+// is free, otherwise on the next poll
+static void poll_file(LogView *view)
+{
+    double time = input_source_get_time();
+    if(view->truncated || time - view->last_poll_time < LOG_VIEW_POLL_INTERVAL) return;
+    view->last_poll_time = time;
+
+    struct stat st;
+    if(fstat(view->fd, &st) != 0) return;
+
+    size_t size = st.st_size;
+    if(size < view->file_size) {
+        // the pages past the new end are replaced before they are read
+        size_t end = (size + page_size - 1) / page_size * page_size;
+        if(end < view->mapped) map_zero_pages(view->data + end, view->mapped - end);
+        view->truncated = true;
+        return;
+    }
+    if(size == view->file_size || !map_pages(view, size)) return;
+    if(pthread_mutex_trylock(&view->lock) != 0) return;
+
+    view->file_size = size;
+    pthread_cond_signal(&view->wake);
+    pthread_mutex_unlock(&view->lock);
+}
+
+// the frame keeps the last progress when the indexer holds the lock
+static void pull_progress(LogView *view)
+{
+    if(pthread_mutex_trylock(&view->lock) != 0) return;
+
+    view->shown_indexed = view->indexed;
+    view->shown_newline_count = view->newline_count;
+    view->shown_last_line_start = view->last_line_start;
+
+    pthread_mutex_unlock(&view->lock);
+}
+
+size_t log_view_line_count(LogView *view)
+{
+    // the last line doesn't need a new line
+    bool has_last_line = view->shown_indexed > view->shown_last_line_start;
+    return view->shown_newline_count + has_last_line;
+}
+
+// offset of the new line that ends the line starting at "start", or the end of the
+// indexed bytes. The lines of a truncated file can be gone from the zeros mapped
+// over it, so "start" can be past that end and the line is empty
+static size_t get_line_end(LogView *view, size_t start)
+{
+    if(start >= view->shown_indexed) return start;
+    const char *end = memchr(view->data + start, '\n', view->shown_indexed - start);
+    return end == NULL ? view->shown_indexed : (size_t)(end - view->data);
+}
+
+// starts from the closest checkpoint, at most LOG_VIEW_CHECKPOINT_LINES - 1 lines
+// are skipped with memchr
+static size_t get_line_start(LogView *view, size_t line)
+{
+    size_t checkpoint = line / LOG_VIEW_CHECKPOINT_LINES;
+    uint64_t *block = view->blocks[checkpoint / LOG_VIEW_BLOCK_SIZE];
+    size_t start = block[checkpoint % LOG_VIEW_BLOCK_SIZE];
+
+    for(size_t i = checkpoint * LOG_VIEW_CHECKPOINT_LINES; i < line; i++) {
+        start = get_line_end(view, start) + 1;
+    }
+
+    return start < view->shown_indexed ? start : view->shown_indexed;
+}
+
+static Rectangle get_log_view_box(LogView *view)
+{
+    return (Rectangle) {
+        view->pos.x + view->padding.left,
+        view->pos.y + view->padding.top,
+        view->size.x - view->padding.left - view->padding.right,
+        view->size.y - view->padding.top - view->padding.bottom,
+    };
+}
+
+static float get_line_height(LogView *view)
+{
+    return view->font_size + LOG_VIEW_LINE_SPACING;
+}
+
+// lines that fit whole in the view
+static size_t get_page_size(LogView *view)
+{
+    size_t page = get_log_view_box(view).height / get_line_height(view);
+    return page > 0 ? page : 1;
+}
+
+static size_t get_max_top_line(LogView *view)
+{
+    size_t count = log_view_line_count(view);
+    size_t page = get_page_size(view);
+    return count > page ? count - page : 0;
+}
+
+// the view follows the file while the last line is shown
+static void scroll_to_line(LogView *view, size_t line)
+{
+    size_t max_top_line = get_max_top_line(view);
+    view->top_line = line < max_top_line ? line : max_top_line;
+    view->follow = view->top_line == max_top_line;
+}
+
+// drawn bytes of the line, the carriage return of CRLF files is left out
+static size_t get_drawn_end(LogView *view, size_t start, size_t end)
+{
+    if(end > start && view->data[end - 1] == '\r') end--;
+    if(end - start > LOG_VIEW_MAX_LINE_SIZE) end = start + LOG_VIEW_MAX_LINE_SIZE;
+    return end;
+}
+
+// offset of the char under the mouse, same as get_pos_at_x of TextArea
+static size_t get_offset_at(LogView *view, Vector2 mouse)
+{
+    size_t count = log_view_line_count(view);
+    if(count == 0) return 0;
+
+    Rectangle box = get_log_view_box(view);
+    float y = (mouse.y - box.y) / get_line_height(view);
+    size_t line = view->top_line + (y > 0 ? (size_t)y : 0);
+    if(line >= count) return view->shown_indexed;
+
+    size_t pos = get_line_start(view, line);
+    size_t end = get_drawn_end(view, pos, get_line_end(view, pos));
+    float x = mouse.x - box.x;
+    float offset = 0;
+
+    while(pos < end) {
+        int size;
+        int codepoint = utf8_decode(view->data + pos, end - pos, &size);
+        int glyph = ui_font_glyph_index(view->font, codepoint);
+        float advance = ui_font_glyph_advance(view->font, glyph, view->font_size);
+        if(offset + advance / 1.5 > x) break;
+
+        offset += advance + FONT_SPACING;
+        pos += size;
+    }
+
+    return pos;
+}
+
+static void handle_mouse(LogView *view)
+{
+    Vector2 mouse = input_source_get_mouse_position();
+    Rectangle rect = {view->pos.x, view->pos.y, view->size.x, view->size.y};
+    view->hovered = CheckCollisionPointRec(mouse, rect);
+
+    // the focus changes on press, so a drag selection released outside keeps it
+    if(input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        view->focused = view->hovered;
+    }
+
+    float wheel = input_source_get_mouse_wheel_move();
+    if(view->hovered && wheel != 0) {
+        long lines = -wheel * LOG_VIEW_WHEEL_LINES;
+        size_t line = lines < 0 && (size_t)-lines > view->top_line ? 0 : view->top_line + lines;
+        scroll_to_line(view, line);
+    }
+
+    if(view->hovered && input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        size_t offset = get_offset_at(view, mouse);
+        view->selection = (InputSelection) {offset, offset};
+        view->dragging = true;
+    }
+
+    if(!view->dragging) return;
+
+    // scrolls a line per frame while the selection is dragged past the edges
+    Rectangle box = get_log_view_box(view);
+    if(mouse.y < box.y && view->top_line > 0) {
+        scroll_to_line(view, view->top_line - 1);
+    } else if(mouse.y > box.y + box.height) {
+        scroll_to_line(view, view->top_line + 1);
+    }
+
+    view->selection.end = get_offset_at(view, mouse);
+    if(input_source_is_mouse_button_released(MOUSE_BUTTON_LEFT)) view->dragging = false;
+}
+
+static bool is_key_active(int key)
+{
+    return input_source_is_key_pressed(key) || input_source_is_key_pressed_repeat(key);
+}
+
+static void handle_keys(LogView *view)
+{
+    size_t page = get_page_size(view);
+    size_t top_line = view->top_line;
+
+    if(is_ctrl_down() && input_source_is_key_pressed(KEY_C)) {
+        InputSelection selection = get_corrected_selection(view->selection);
+        size_t size = selection.end - selection.start;
+        if(size > LOG_VIEW_MAX_COPY_SIZE) size = LOG_VIEW_MAX_COPY_SIZE;
+        if(size > 0) copy_to_clipboard(view->data + selection.start, size);
+    } else if(is_ctrl_down() && input_source_is_key_pressed(KEY_A)) {
+        view->selection = (InputSelection) {0, view->shown_indexed};
+    } else if(is_key_active(KEY_DOWN)) {
+        scroll_to_line(view, top_line + 1);
+    } else if(is_key_active(KEY_UP)) {
+        scroll_to_line(view, top_line > 0 ? top_line - 1 : 0);
+    } else if(is_key_active(KEY_PAGE_DOWN)) {
+        scroll_to_line(view, top_line + page);
+    } else if(is_key_active(KEY_PAGE_UP)) {
+        scroll_to_line(view, top_line > page ? top_line - page : 0);
+    } else if(input_source_is_key_pressed(KEY_HOME)) {
+        scroll_to_line(view, 0);
+    } else if(input_source_is_key_pressed(KEY_END)) {
+        scroll_to_line(view, SIZE_MAX);
+    }
+}
+
+// offset where the last visible line ends, the view is repainted when it changes
+static size_t get_visible_end(LogView *view)
+{
+    size_t count = log_view_line_count(view);
+    if(count == 0) return 0;
+
+    size_t last = view->top_line + get_page_size(view);
+    if(last >= count) last = count - 1;
+    return get_line_end(view, get_line_start(view, last));
+}
+
+// same as the damage of Input
+static void damage_changes(LogView *view)
+{
+    LogViewDrawState state;
+    memset(&state, 0, sizeof(state));
+    state.pos = view->pos;
+    state.size = view->size;
+    state.focused = view->focused;
+    state.top_line = view->top_line;
+    state.visible_end = get_visible_end(view);
+    state.selection = get_corrected_selection(view->selection);
+
+    LogViewDrawState *drawn = &view->drawn;
+    if(memcmp(&state, drawn, sizeof(state)) != 0) {
+        render_add_damage((Rectangle) {drawn->pos.x, drawn->pos.y, drawn->size.x, drawn->size.y});
+        render_add_damage((Rectangle) {view->pos.x, view->pos.y, view->size.x, view->size.y});
+    }
+
+    *drawn = state;
+}
+
+static void draw_selection(LogView *view, size_t start, size_t end, float y)
+{
+    InputSelection sel = get_corrected_selection(view->selection);
+    if(sel.start == sel.end || sel.end < start || sel.start > end) return;
+
+    size_t from = sel.start > start ? sel.start : start;
+    size_t to = sel.end < end ? sel.end : end;
+    size_t drawn_end = get_drawn_end(view, start, end);
+    if(from > drawn_end) from = drawn_end;
+    if(to > drawn_end) to = drawn_end;
+
+    const char *text = view->data + start;
+    float from_x = ui_font_measure(view->font, text, from - start, view->font_size, FONT_SPACING).x;
+    float to_x = ui_font_measure(view->font, text, to - start, view->font_size, FONT_SPACING).x;
+    // same as the selection of TextArea
+    if(sel.end > end && end < view->shown_indexed) to_x += view->font_size / 2;
+    if(from > start) from_x += FONT_SPACING;
+    if(to_x <= from_x) return;
+
+    Rectangle box = get_log_view_box(view);
+    render_set_layer(RENDER_LAYER_HIGHLIGHT);
+    render_rect((Rectangle) {
+        .x = box.x + from_x,
+        .y = y - 1,
+        .width = to_x - from_x,
+        .height = view->font_size + 2,
+    }, ColorAlpha(view->font_color, 0.4));
+}
+
+// the text is drawn from the mapped pages, nothing is copied
+static void draw_lines(LogView *view)
+{
+    size_t count = log_view_line_count(view);
+    if(count == 0) return;
+
+    Rectangle box = get_log_view_box(view);
+    float line_height = get_line_height(view);
+    render_push_clip(box);
+
+    size_t start = get_line_start(view, view->top_line);
+    for(size_t line = view->top_line; line < count; line++) {
+        float y = box.y + (line - view->top_line) * line_height;
+        if(y >= box.y + box.height) break;
+
+        size_t end = get_line_end(view, start);
+        draw_selection(view, start, end, y);
+
+        render_set_layer(RENDER_LAYER_TEXT);
+        ui_font_draw(
+            view->font,
+            view->data + start,
+            get_drawn_end(view, start, end) - start,
+            (Vector2) {box.x, y},
+            view->font_size,
+            FONT_SPACING,
+            view->font_color
+        );
+
+        start = end + 1;
+    }
+
+    render_pop_clip();
+}
+
+void handle_log_view(LogView *view)
+{
+    poll_file(view);
+    pull_progress(view);
+
+    handle_mouse(view);
+    if(view->focused) handle_keys(view);
+    // new lines scroll the view only while it shows the last one
+    if(view->follow) scroll_to_line(view, SIZE_MAX);
+
+    damage_changes(view);
+
+    Rectangle rect = {view->pos.x, view->pos.y, view->size.x, view->size.y};
+    render_set_layer(RENDER_LAYER_BACKGROUND);
+    render_rect(rect, view->bg_color);
+
+    draw_lines(view);
+
+    if(view->focused) {
+        render_set_layer(RENDER_LAYER_OVERLAY);
+        render_rect_lines(rect, 2, view->border_color);
+    }
+}
@@ -0,0 +1,95 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <pthread.h>
+
+#include "cTooling.h"
+#include "font.h"
+#include "input.h"
+#include "raylib.h"
+
+#define LOG_VIEW_CHECKPOINT_LINES 64          // lines between two offsets of the index
+#define LOG_VIEW_BLOCK_SIZE 65536             // offsets per block of the index
+#define LOG_VIEW_MAX_BLOCKS 4096
+#define LOG_VIEW_SCAN_SIZE (4*1024*1024)      // bytes indexed between two updates of the progress
+#define LOG_VIEW_RESERVE ((size_t)1 << 40)    // address space the mapped file can grow into
+#define LOG_VIEW_POLL_INTERVAL 0.25           // seconds between two checks of the file size
+#define LOG_VIEW_MAX_LINE_SIZE 4096           // bytes of a line that are drawn
+#define LOG_VIEW_MAX_COPY_SIZE (64*1024*1024) // bigger selections are copied truncated
+#define LOG_VIEW_LINE_SPACING 4
+#define LOG_VIEW_WHEEL_LINES 3
+#define LOG_VIEW_MAX_VIEWS 16                 // views guarded against SIGBUS at once
+
+// state that was drawn on the last frame, like InputDrawState
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    bool focused;
+    size_t top_line;
+    size_t visible_end; // offset where the last visible line ends
+    InputSelection selection;
+} LogViewDrawState;
+
+// Read only view of a file that can be bigger than the ram. The file is mapped and
+// the visible lines are drawn straight from the mapped pages. A thread indexes the
+// lines in the background, keeping the offset of one line every
+// LOG_VIEW_CHECKPOINT_LINES, the lines in between are found with memchr when
+// they are shown. The lines are shown as soon as they are indexed.
+//
+// The file is mapped in a reserved range of address space, so when it grows the
+// new pages are mapped after the old ones and the mapping never moves under the
+// indexer. Pages past the end of a truncated file raise SIGBUS when they are read,
+// a handler maps zeros over them so the truncated part reads as zeros. A file
+// that shrinks isn't followed anymore
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    LogViewDrawState drawn;
+    int fd;
+    const char *data;
+    size_t reserved;
+    size_t mapped; // bytes mapped, a multiple of the page size
+    bool truncated;
+    double last_poll_time;
+
+    // offset of every LOG_VIEW_CHECKPOINT_LINES line, checkpoint i is in
+    // blocks[i / LOG_VIEW_BLOCK_SIZE]. The blocks never move, the indexer fills
+    // them before publishing the progress that covers them
+    uint64_t *blocks[LOG_VIEW_MAX_BLOCKS];
+    size_t checkpoint_count;
+    pthread_t indexer;
+    pthread_mutex_t lock; // protects the fields below, the UI only tries to take it
+    pthread_cond_t wake;
+    size_t file_size;       // bytes the indexer can read
+    size_t indexed;         // bytes indexed
+    size_t newline_count;
+    size_t last_line_start; // offset after the last indexed new line
+    bool quit;
+
+    // copy of the progress of the indexer taken at the start of the frame
+    size_t shown_indexed;
+    size_t shown_newline_count;
+    size_t shown_last_line_start;
+
+    UIFont *font;
+    int font_size;
+    Color font_color;
+    Padding padding;
+    bool focused;
+    bool hovered;
+    size_t top_line;
+    bool follow; // scrolls to the last line as the file grows
+    InputSelection selection; // offsets in the file
+    bool dragging;
+    Color border_color;
+    Color bg_color;
+} LogView;
+
+// NULL when the file can't be opened
+LogView *create_log_view(InputProps props, const char *path);
+void destroy_log_view(LogView *view);
+void handle_log_view(LogView *view);
+// lines indexed so far
+size_t log_view_line_count(LogView *view);
+
+#endif // LOGVIEW_H
@@ -1,29 +1,267 @@
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 
 #include "raylib.h"
+#include "console.h"
 #include "input.h"
+#include "finder.h"
+#include "input_source.h"
+#include "latency.h"
+#include "list.h"
+#include "logview.h"
+#include "render.h"
+#include "textarea.h"
+
+#ifdef BAKED_FONT
+// generated by tools/bake_font.c, see build.sh
+extern const BakedFont baked_font;
+#endif
 
 #define COLOR_BG CLITERAL(Color) { 22, 20, 31, 255 }
 #define COLOR_INPUT_FONT CLITERAL(Color) { 224, 222, 244, 255 }
 #define COLOR_INPUT_BORDER CLITERAL(Color) { 157, 207, 216, 255 }
 #define COLOR_INPUT_BG CLITERAL(Color) { 33, 32, 46, 255 }
+#define COLOR_SELECTION CLITERAL(Color) { 62, 60, 88, 255 }
+
+// rows of the demo list, they are generated when they are shown
+#define RESULT_COUNT 10000000
+
+// lines kept by the demo console and lines its thread writes per second
+#define CONSOLE_CAPACITY 100000
+#define CONSOLE_DEMO_RATE 100000
+
+// time left between the late input sampling and the vblank, on top of the
+// slowest recent frame
+#define LATE_SAMPLING_MARGIN 0.002
+// how fast the frame time estimate forgets a slow frame
+#define FRAME_TIME_DECAY 0.95
+
+// raylib polls the events inside of EndDrawing, right after the swap. Calling
+// PollInputEvents again would reset the keys and chars queued by that poll, glfw
+// only appends the new events to them
+extern void glfwPollEvents(void);
+
+// With vsync EndDrawing returns on the vblank, so the input polled there waits
+// a whole frame before it's drawn. Instead sleep until the frame has to start
+// being built to make the next vblank, then poll again and render
+static void sample_input_late(double frame_start, double period, double frame_time)
+{
+    double wake = frame_start + period - frame_time - LATE_SAMPLING_MARGIN;
+    double wait = wake - GetTime();
+    if(wait > 0) WaitTime(wait);
+
+    glfwPollEvents();
+}
+
+static size_t get_result_count(void *data)
+{
+    (void)data;
+    return RESULT_COUNT;
+}
+
+static float get_result_height(void *data, size_t row)
+{
+    (void)data;
+    return row % 5 == 0 ? 48 : 28;
+}
+
+static void get_result_text(void *data, size_t row, String *text)
+{
+    (void)data;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "Result %zu", row);
+    string_append_text(text, buffer);
+}
+
+typedef struct {
+    const char **items;
+    size_t count;
+    size_t capacity;
+} Lines;
+
+// reads the non empty lines of a text file, they are split in place in "text"
+static bool read_lines(const char *path, String *text, Lines *lines)
+{
+    FILE *file = fopen(path, "rb");
+    if(file == NULL) return false;
+
+    char chunk[4096];
+    size_t size;
+    while((size = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        da_append_many(text, chunk, size);
+    }
+    fclose(file);
+    da_append(text, '\0');
+
+    char *line = text->items;
+    for(char *c = text->items; *c != '\0'; c++) {
+        if(*c != '\n') continue;
+
+        *c = '\0';
+        if(c > line && c[-1] == '\r') c[-1] = '\0';
+        if(*line != '\0') da_append(lines, line);
+        line = c + 1;
+    }
+    if(*line != '\0') da_append(lines, line);
+
+    return true;
+}
+
+// "path" is either an index written by autocomplete_index_write, that is mapped,
+// or a text file with a suggestion per line
+static AutocompleteIndex *load_suggestions(const char *path)
+{
+    AutocompleteIndex *index = autocomplete_index_map(path);
+    if(index != NULL) return index;
+
+    String text = {0};
+    Lines lines = {0};
+    if(read_lines(path, &text, &lines)) {
+        index = autocomplete_index_build(lines.items, NULL, lines.count);
+    }
+
+    da_free(&lines);
+    string_free(&text);
+    return index;
+}
+
+typedef struct {
+    Console *console;
+    atomic_bool quit;
+} ConsoleDemo;
+
+// writes CONSOLE_DEMO_RATE lines per second to the console, in steps of 1ms
+static void *write_console_demo(void *data)
+{
+    ConsoleDemo *demo = data;
+    ConsoleWriter writer = { .console = demo->console };
+    char line[128];
+    size_t seq = 0;
+    while(!atomic_load(&demo->quit)) {
+        for(int i = 0; i < CONSOLE_DEMO_RATE / 1000; i++, seq++) {
+            int size = snprintf(line, sizeof(line), "[%zu] worker %zu: processed item %zu\n",
+                seq, seq % 8, seq * 7919 % 1000003);
+            console_writer_write(&writer, line, size);
+        }
+        console_writer_flush(&writer);
+        nanosleep(&(struct timespec) { .tv_nsec = 1000000 }, NULL);
+    }
+
+    console_writer_free(&writer);
+    return NULL;
+}
+
+static void print_usage(const char *program)
+{
+    fprintf(stderr,
+        "Usage: %s [options] [font.ttf]\n"
+        "  --low-latency              sample the input late in the frame\n"
+        "  --latency-log <file>       write the latency of every typed char\n"
+        "  --record <file>            log the input of the session\n"
+        "  --replay <file>            play back a logged session\n"
+        "  --suggestions <file>       autocomplete the input\n"
+        "  --finder <file>            fuzzy finder over the lines of the file\n"
+        "  --log <file>               follow the file in place of the text area\n"
+        "  --console                  console flooded with lines by a thread\n"
+        "  --syntax <sql|jsonpath>    highlight the input and the text area\n"
+        "  --sdf                      render the font with distance fields\n",
+        program);
+}
 
-int main(void)
+int main(int argc, char **argv)
 {
+    // the options are listed by print_usage
+    bool low_latency = false;
+    const char *latency_log = NULL;
+    const char *record_log = NULL;
+    const char *replay_log = NULL;
+    const char *suggestions = NULL;
+    const char *finder_file = NULL;
+    const char *log_file = NULL;
+    bool console_demo = false;
+    const char *syntax = NULL;
+    bool sdf = false;
+    const char *font_file = NULL;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--low-latency") == 0) {
+            low_latency = true;
+        } else if(strcmp(argv[i], "--latency-log") == 0 && i + 1 < argc) {
+            latency_log = argv[++i];
+        } else if(strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_log = argv[++i];
+        } else if(strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_log = argv[++i];
+        } else if(strcmp(argv[i], "--suggestions") == 0 && i + 1 < argc) {
+            suggestions = argv[++i];
+        } else if(strcmp(argv[i], "--finder") == 0 && i + 1 < argc) {
+            finder_file = argv[++i];
+        } else if(strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_file = argv[++i];
+        } else if(strcmp(argv[i], "--console") == 0) {
+            console_demo = true;
+        } else if(strcmp(argv[i], "--syntax") == 0 && i + 1 < argc) {
+            syntax = argv[++i];
+        } else if(strcmp(argv[i], "--sdf") == 0) {
+            sdf = true;
+        } else if(strncmp(argv[i], "--", 2) != 0 && font_file == NULL) {
+            font_file = argv[i];
+        } else {
+            // mistyped flags and the ones missing their value aren't taken as the font
+            fprintf(stderr, "Invalid argument %s\n", argv[i]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(low_latency) SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(1280, 720, "cUI");
-    SetTargetFPS(60);
+    // escape closes dropdowns instead of the window
+    SetExitKey(KEY_NULL);
+    // in low latency mode the swap already waits for the vblank
+    SetTargetFPS(low_latency ? 0 : 60);
+    latency_enable(latency_log != NULL);
+
+    if(record_log != NULL && !input_source_record(record_log)) {
+        fprintf(stderr, "Couldn't write %s\n", record_log);
+    }
+    if(replay_log != NULL && !input_source_replay(replay_log)) {
+        fprintf(stderr, "Couldn't replay %s\n", replay_log);
+    }
+
+    int refresh_rate = GetMonitorRefreshRate(GetCurrentMonitor());
+    double period = 1.0 / (refresh_rate > 0 ? refresh_rate : 60);
+    double frame_time = 0;
 
     Vector2 input_size = { 600, 60 };
     Vector2 input_pos = {
         .x = GetScreenWidth() / 2 - input_size.x / 2,
-        .y = GetScreenHeight() / 2 - input_size.y / 2,
+        .y = 60,
+    };
+    Vector2 text_area_size = { 600, 500 };
+    Vector2 text_area_pos = {
+        .x = input_pos.x,
+        .y = input_pos.y + input_size.y + 40,
     };
 
+    // a TTF file can be passed to rasterize its glyphs as they are typed, with
+    // "--sdf" to render it with distance fields
+    UIFont *font;
+    if(font_file != NULL) {
+        font = load_ui_font_dynamic(font_file, 32, sdf ? UI_FONT_SDF : UI_FONT_BITMAP);
+    } else {
+#ifdef BAKED_FONT
+        font = load_ui_font_baked(&baked_font);
+#else
+        font = create_ui_font(GetFontDefault());
+#endif
+    }
+
     Input *input = create_input((InputProps) {
         .pos = input_pos,
         .size = input_size,
         .placeholder = "This is an input",
-        .font = GetFontDefault(),
+        .font = font,
         .font_size = 20,
         .font_color = COLOR_INPUT_FONT,
         .padding = { 20, 20, 20, 20 },
@@ -31,13 +269,154 @@ int main(void)
         .bg_color = COLOR_INPUT_BG,
     });
 
+    if(suggestions != NULL) {
+        AutocompleteIndex *index = load_suggestions(suggestions);
+        if(index != NULL) {
+            input_attach_autocomplete(input, index);
+        } else {
+            fprintf(stderr, "Couldn't load %s\n", suggestions);
+        }
+    }
+
+    TextArea *text_area = create_text_area((InputProps) {
+        .pos = text_area_pos,
+        .size = text_area_size,
+        .placeholder = "This is a text area",
+        .font = font,
+        .font_size = 20,
+        .font_color = COLOR_INPUT_FONT,
+        .padding = { 20, 20, 20, 20 },
+        .border_color = COLOR_INPUT_BORDER,
+        .bg_color = COLOR_INPUT_BG,
+    });
+    text_area_set_wrap(text_area, true);
+
+    // the widgets share the lexer
+    Lexer *lexer = NULL;
+    if(syntax != NULL && strcmp(syntax, "sql") == 0) {
+        lexer = create_sql_lexer();
+    } else if(syntax != NULL && strcmp(syntax, "jsonpath") == 0) {
+        lexer = create_jsonpath_lexer();
+    } else if(syntax != NULL) {
+        fprintf(stderr, "Unknown syntax %s\n", syntax);
+    }
+    if(lexer != NULL) {
+        input_attach_lexer(input, lexer);
+        text_area_attach_lexer(text_area, lexer);
+    }
+
+    LogView *log_view = NULL;
+    if(log_file != NULL) {
+        log_view = create_log_view((InputProps) {
+            .pos = text_area_pos,
+            .size = text_area_size,
+            .font = font,
+            .font_size = 20,
+            .font_color = COLOR_INPUT_FONT,
+            .padding = { 20, 20, 20, 20 },
+            .border_color = COLOR_INPUT_BORDER,
+            .bg_color = COLOR_INPUT_BG,
+        }, log_file);
+        if(log_view == NULL) fprintf(stderr, "Couldn't open %s\n", log_file);
+    }
+
+    ConsoleDemo demo = {0};
+    pthread_t demo_writer;
+    if(console_demo && log_view == NULL) {
+        demo.console = create_console((InputProps) {
+            .pos = text_area_pos,
+            .size = text_area_size,
+            .font = font,
+            .font_size = 20,
+            .font_color = COLOR_INPUT_FONT,
+            .padding = { 20, 20, 20, 20 },
+            .border_color = COLOR_INPUT_BORDER,
+            .bg_color = COLOR_INPUT_BG,
+        }, CONSOLE_CAPACITY);
+        pthread_create(&demo_writer, NULL, write_console_demo, &demo);
+    }
+
+    List *list = create_list((ListProps) {
+        .pos = { input_pos.x + input_size.x + 40, input_pos.y },
+        .size = { 260, text_area_pos.y + text_area_size.y - input_pos.y },
+        .source = {
+            .get_count = get_result_count,
+            .get_height = get_result_height,
+            .get_text = get_result_text,
+        },
+        .font = font,
+        .font_size = 20,
+        .font_color = COLOR_INPUT_FONT,
+        .padding = { 10, 10, 10, 10 },
+        .row_height = 28,
+        .border_color = COLOR_INPUT_BORDER,
+        .bg_color = COLOR_INPUT_BG,
+        .selection_color = COLOR_SELECTION,
+    });
+
+    // the lines are kept for the whole session, the finder borrows them
+    String finder_text = {0};
+    Lines finder_lines = {0};
+    Finder *finder = NULL;
+    if(finder_file != NULL && read_lines(finder_file, &finder_text, &finder_lines)) {
+        finder = create_finder((FinderProps) {
+            .pos = { 20, input_pos.y },
+            .size = { input_pos.x - 40, text_area_pos.y + text_area_size.y - input_pos.y },
+            .candidates = finder_lines.items,
+            .count = finder_lines.count,
+            .font = font,
+            .font_size = 20,
+            .font_color = COLOR_INPUT_FONT,
+            .border_color = COLOR_INPUT_BORDER,
+            .bg_color = COLOR_INPUT_BG,
+            .selection_color = COLOR_SELECTION,
+        });
+    } else if(finder_file != NULL) {
+        fprintf(stderr, "Couldn't read %s\n", finder_file);
+    }
+
     while(!WindowShouldClose()) {
+        double frame_start = GetTime();
+        if(low_latency) sample_input_late(frame_start, period, frame_time);
+        latency_mark_sampled();
+        if(!input_source_begin_frame()) break;
+
+        double build_start = GetTime();
         BeginDrawing();
-        ClearBackground(COLOR_BG);
+        render_begin_frame();
         handle_input(input);
+        if(log_view != NULL) {
+            handle_log_view(log_view);
+        } else if(demo.console != NULL) {
+            handle_console(demo.console);
+        } else {
+            handle_text_area(text_area);
+        }
+        handle_list(list);
+        if(finder != NULL) handle_finder(finder);
+        render_end_frame(COLOR_BG);
+        input_source_end_frame();
+
+        // a slow frame raises the estimate at once, it goes back down slowly
+        double elapsed = GetTime() - build_start;
+        frame_time = elapsed > frame_time ? elapsed : frame_time*FRAME_TIME_DECAY;
+
         EndDrawing();
+        latency_mark_presented();
     }
 
+    if(latency_log != NULL && !latency_write_csv(latency_log)) {
+        fprintf(stderr, "Couldn't write %s\n", latency_log);
+    }
+
+    if(log_view != NULL) destroy_log_view(log_view);
+    if(demo.console != NULL) {
+        atomic_store(&demo.quit, true);
+        pthread_join(demo_writer, NULL);
+        destroy_console(demo.console);
+    }
+    input_source_close();
+    destroy_ui_font(font);
     CloseWindow();
     return 0;
 }
@@ -0,0 +1,312 @@
+#include <math.h>
+
+#include "font.h"
+#include "render.h"
+#include "rlgl.h"
+
+static struct {
+    RenderCommands commands;
+    RenderClips clips;
+    RenderClipStack clip_stack;
+    int layer;
+    int clip;
+    Shader shader;
+    Texture2D shapes_texture;
+    Rectangle shapes_rec;
+    RenderTexture2D target; // persistent framebuffer, only the damaged part is repainted
+    Rectangle damage;       // bounding box of everything that changed this frame
+    bool has_damage;
+    size_t draw_calls;
+    size_t command_count;
+    size_t clip_flushes;
+    float damage_area;
+    float fill_area;
+} renderer = { .clip = -1 };
+
+void render_begin_frame(void)
+{
+    renderer.commands.count = 0;
+    renderer.clips.count = 0;
+    renderer.clip_stack.count = 0;
+    renderer.layer = RENDER_LAYER_BACKGROUND;
+    renderer.clip = -1;
+    renderer.shader = (Shader) {0};
+
+    // rectangles are drawn with raylib's shapes texture, so they go in the same
+    // batches as the rest of the quads that use it
+    renderer.shapes_texture = GetShapesTexture();
+    renderer.shapes_rec = GetShapesTextureRectangle();
+}
+
+void render_set_layer(int layer)
+{
+    renderer.layer = layer;
+}
+
+static bool rects_equal(Rectangle a, Rectangle b)
+{
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+void render_push_clip(Rectangle clip)
+{
+    if(renderer.clip >= 0) {
+        clip = GetCollisionRec(clip, renderer.clips.items[renderer.clip]);
+    }
+
+    da_append(&renderer.clip_stack, renderer.clip);
+
+    // consecutive identical clips share the index, so their commands are sorted
+    // together and submitted with a single scissor
+    RenderClips *clips = &renderer.clips;
+    if(clips->count == 0 || !rects_equal(clips->items[clips->count - 1], clip)) {
+        da_append(clips, clip);
+    }
+
+    renderer.clip = clips->count - 1;
+}
+
+void render_pop_clip(void)
+{
+    assert(renderer.clip_stack.count > 0 && "Clip stack underflow");
+    renderer.clip = renderer.clip_stack.items[--renderer.clip_stack.count];
+}
+
+void render_set_shader(Shader shader)
+{
+    renderer.shader = shader;
+}
+
+void render_clear_shader(void)
+{
+    renderer.shader = (Shader) {0};
+}
+
+static bool is_rect_inside(Rectangle inner, Rectangle outer)
+{
+    return inner.x >= outer.x
+        && inner.y >= outer.y
+        && inner.x + inner.width <= outer.x + outer.width
+        && inner.y + inner.height <= outer.y + outer.height;
+}
+
+void render_texture(const Texture2D *texture, Rectangle src, Rectangle dst, Color color)
+{
+    int clip = renderer.clip;
+
+    if(clip >= 0) {
+        Rectangle clip_rec = renderer.clips.items[clip];
+
+        if(is_rect_inside(dst, clip_rec)) {
+            clip = -1;
+        } else if(!CheckCollisionRecs(dst, clip_rec)) {
+            return;
+        } else if(texture == &renderer.shapes_texture) {
+            // the shapes texture is a single texel so the source stays the same
+            dst = GetCollisionRec(dst, clip_rec);
+            clip = -1;
+        }
+    }
+
+    RenderCommand command = {
+        .texture = texture,
+        .shader = renderer.shader,
+        .src = src,
+        .dst = dst,
+        .color = color,
+        .layer = renderer.layer,
+        .clip = clip,
+        .seq = renderer.commands.count,
+    };
+
+    da_append(&renderer.commands, command);
+}
+
+void render_rect(Rectangle rec, Color color)
+{
+    render_texture(&renderer.shapes_texture, renderer.shapes_rec, rec, color);
+}
+
+void render_rect_lines(Rectangle rec, float thickness, Color color)
+{
+    // same layout as DrawRectangleLinesEx
+    render_rect((Rectangle) {rec.x, rec.y, rec.width, thickness}, color);
+    render_rect((Rectangle) {rec.x, rec.y + rec.height - thickness, rec.width, thickness}, color);
+    render_rect((Rectangle) {
+        rec.x, rec.y + thickness, thickness, rec.height - thickness*2
+    }, color);
+    render_rect((Rectangle) {
+        rec.x + rec.width - thickness, rec.y + thickness, thickness, rec.height - thickness*2
+    }, color);
+}
+
+static int compare_commands(const void *a, const void *b)
+{
+    const RenderCommand *x = a;
+    const RenderCommand *y = b;
+
+    if(x->layer != y->layer) return x->layer < y->layer ? -1 : 1;
+    if(x->clip != y->clip) return x->clip < y->clip ? -1 : 1;
+    if(x->shader.id != y->shader.id) return x->shader.id < y->shader.id ? -1 : 1;
+    if(x->texture->id != y->texture->id) return x->texture->id < y->texture->id ? -1 : 1;
+    return x->seq < y->seq ? -1 : 1;
+}
+
+void render_add_damage(Rectangle rec)
+{
+    if(rec.width <= 0 || rec.height <= 0) return;
+
+    if(!renderer.has_damage) {
+        renderer.damage = rec;
+        renderer.has_damage = true;
+        return;
+    }
+
+    Rectangle *damage = &renderer.damage;
+    float right = fmaxf(damage->x + damage->width, rec.x + rec.width);
+    float bottom = fmaxf(damage->y + damage->height, rec.y + rec.height);
+    damage->x = fminf(damage->x, rec.x);
+    damage->y = fminf(damage->y, rec.y);
+    damage->width = right - damage->x;
+    damage->height = bottom - damage->y;
+}
+
+void render_damage_all(void)
+{
+    render_add_damage((Rectangle) {0, 0, GetScreenWidth(), GetScreenHeight()});
+}
+
+// every scissor is intersected with the damage, so nothing outside of it is touched
+static void begin_clip(int clip, Rectangle damage)
+{
+    Rectangle rec = damage;
+    if(clip >= 0) rec = GetCollisionRec(renderer.clips.items[clip], damage);
+    BeginScissorMode(rec.x, rec.y, rec.width, rec.height);
+}
+
+static void submit_commands(Rectangle damage)
+{
+    RenderCommands *commands = &renderer.commands;
+    qsort(commands->items, commands->count, sizeof(RenderCommand), compare_commands);
+
+    begin_clip(-1, damage);
+
+    int clip = -1;
+    unsigned int shader = 0;
+    unsigned int texture = 0;
+    size_t draw_calls = 0;
+    size_t clip_flushes = 0;
+
+    for(size_t i = 0; i < commands->count; i++) {
+        RenderCommand *command = &commands->items[i];
+
+        if(!CheckCollisionRecs(command->dst, damage)) continue;
+
+        // scissor and shader changes flush the raylib batch, a texture change
+        // starts a new draw call inside of it
+        if(command->clip != clip) {
+            begin_clip(command->clip, damage);
+            clip_flushes++;
+            clip = command->clip;
+            texture = 0;
+        }
+
+        if(command->shader.id != shader) {
+            if(shader != 0) EndShaderMode();
+            if(command->shader.id != 0) BeginShaderMode(command->shader);
+            shader = command->shader.id;
+            texture = 0;
+        }
+
+        if(command->texture->id != texture) {
+            texture = command->texture->id;
+            draw_calls++;
+        }
+
+        DrawTexturePro(
+            *command->texture, command->src, command->dst, (Vector2) {0, 0}, 0, command->color
+        );
+    }
+
+    if(shader != 0) EndShaderMode();
+    EndScissorMode();
+
+    renderer.draw_calls = draw_calls;
+    renderer.clip_flushes = clip_flushes;
+}
+
+void render_end_frame(Color background)
+{
+    // the glyphs rasterized by the widgets of this frame are uploaded before the
+    // commands that use them are submitted, a new glyph damages the whole screen
+    ui_font_flush_all();
+
+    int width = GetScreenWidth();
+    int height = GetScreenHeight();
+
+    if(renderer.target.id == 0 || renderer.target.texture.width != width
+        || renderer.target.texture.height != height) {
+        if(renderer.target.id != 0) UnloadRenderTexture(renderer.target);
+        renderer.target = LoadRenderTexture(width, height);
+        render_damage_all();
+    }
+
+    renderer.command_count = renderer.commands.count;
+    renderer.draw_calls = 0;
+    renderer.clip_flushes = 0;
+    renderer.damage_area = 0;
+    renderer.fill_area = 0;
+
+    if(renderer.has_damage) {
+        Rectangle damage = GetCollisionRec(renderer.damage, (Rectangle) {0, 0, width, height});
+        renderer.damage_area = damage.width * damage.height;
+
+        BeginTextureMode(renderer.target);
+        // the scissor also limits the clear to the damaged area
+        BeginScissorMode(damage.x, damage.y, damage.width, damage.height);
+        ClearBackground(background);
+        EndScissorMode();
+        submit_commands(damage);
+        EndTextureMode();
+
+        renderer.has_damage = false;
+        renderer.fill_area = renderer.damage_area;
+    }
+
+    // EndDrawing swaps on every frame and the back buffer is undefined after a swap,
+    // so the framebuffer is copied to the screen even when nothing changed
+    renderer.fill_area += width * height;
+
+    // the framebuffer is copied as it is, without blending it with the screen
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM);
+    // render textures are flipped vertically
+    Rectangle src = {0, 0, width, -height};
+    DrawTextureRec(renderer.target.texture, src, (Vector2) {0, 0}, WHITE);
+    EndBlendMode();
+}
+
+size_t render_get_draw_calls(void)
+{
+    return renderer.draw_calls;
+}
+
+size_t render_get_command_count(void)
+{
+    return renderer.command_count;
+}
+
+size_t render_get_clip_flushes(void)
+{
+    return renderer.clip_flushes;
+}
+
+float render_get_damage_area(void)
+{
+    return renderer.damage_area;
+}
+
+float render_get_fill_area(void)
+{
+    return renderer.fill_area;
+}
@@ -0,0 +1,86 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "cTooling.h"
+#include "raylib.h"
+
+// Draw order between commands of different layers is kept, inside of a layer the
+// commands are reordered to group the ones with the same clip, shader and texture
+typedef enum {
+    RENDER_LAYER_BACKGROUND,
+    RENDER_LAYER_HIGHLIGHT, // selections and other marks behind the text
+    RENDER_LAYER_TEXT,
+    RENDER_LAYER_OVERLAY,   // cursors and borders
+    RENDER_LAYER_POPUP,     // dropdowns drawn over the other widgets
+    RENDER_LAYER_POPUP_TEXT,
+    RENDER_LAYER_COUNT,
+} RenderLayer;
+
+typedef struct {
+    const Texture2D *texture; // read when submitting, so the texture can be recreated
+    Shader shader;
+    Rectangle src;
+    Rectangle dst;
+    Color color;
+    int layer;
+    int clip; // index in the frame clip rects or -1 when there's no clip
+    unsigned int seq; // recording order, keeps the sort stable
+} RenderCommand;
+
+typedef struct {
+    RenderCommand *items;
+    size_t count;
+    size_t capacity;
+} RenderCommands;
+
+typedef struct {
+    Rectangle *items;
+    size_t count;
+    size_t capacity;
+} RenderClips;
+
+typedef struct {
+    int *items; // indices in the frame clip rects
+    size_t count;
+    size_t capacity;
+} RenderClipStack;
+
+// Command buffer renderer. Widgets record rectangles and textured quads during the
+// frame and everything is submitted at once by render_end_frame, sorted so that
+// raylib can draw it with the minimum number of draw calls.
+//
+// The frame is kept in a persistent framebuffer and only the area damaged with
+// render_add_damage is cleared with "background" and repainted. Widgets record
+// all their commands every frame, the ones outside of the damage are skipped.
+// When nothing is damaged the screen isn't drawn either
+void render_begin_frame(void);
+void render_end_frame(Color background);
+
+void render_add_damage(Rectangle rec);
+void render_damage_all(void);
+
+void render_set_layer(int layer);
+// the pushed clip is intersected with the current one. Rectangles are clipped on
+// the CPU and so are quads that end up fully inside or outside of the clip, only
+// quads crossing its edges are drawn with a scissor
+void render_push_clip(Rectangle clip);
+void render_pop_clip(void);
+void render_set_shader(Shader shader);
+void render_clear_shader(void);
+
+void render_rect(Rectangle rec, Color color);
+void render_rect_lines(Rectangle rec, float thickness, Color color);
+void render_texture(const Texture2D *texture, Rectangle src, Rectangle dst, Color color);
+
+// draw calls, commands and scissor changes (each one flushes the raylib batch)
+// submitted on the last frame
+size_t render_get_draw_calls(void);
+size_t render_get_command_count(void);
+size_t render_get_clip_flushes(void);
+// repainted pixels on the last frame
+float render_get_damage_area(void);
+// pixels written on the last frame, the repainted ones and the ones copied to the
+// screen. Frames with no damage only copy the screen
+float render_get_fill_area(void);
+
+#endif // RENDER_H
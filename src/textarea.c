@@ -0,0 +1,1258 @@
+#include <math.h>
+
+#include "textarea.h"
+#include "input_source.h"
+#include "latency.h"
+#include "render.h"
+
+TextArea *create_text_area(InputProps props)
+{
+    TextArea *area = malloc(sizeof(TextArea));
+    bzero(area, sizeof(TextArea));
+
+    area->pos = props.pos;
+    area->size = props.size;
+    area->font = props.font;
+    area->font_size = props.font_size;
+    area->font_color = props.font_color;
+    area->placeholder = props.placeholder;
+    area->padding = props.padding;
+    area->border_color = props.border_color;
+    area->bg_color = props.bg_color;
+    area->read_only = props.read_only;
+    area->cursor.is_collapsed = true;
+    area->goal_x = -1;
+    text_wrap_init(&area->wrap, props.font, props.font_size, FONT_SPACING);
+
+    // the first line always starts at 0
+    da_append(&area->lines, 0);
+    area->lines.delta_line = 1;
+
+    return area;
+}
+
+size_t text_area_line_count(TextArea *area)
+{
+    return area->lines.count;
+}
+
+size_t text_area_line_start(TextArea *area, size_t line)
+{
+    TextAreaLines *lines = &area->lines;
+    if(line >= lines->delta_line) return lines->items[line] + lines->delta;
+    return lines->items[line];
+}
+
+size_t text_area_line_end(TextArea *area, size_t line)
+{
+    if(line + 1 < area->lines.count) return text_area_line_start(area, line + 1) - 1;
+    return area->text.count;
+}
+
+size_t text_area_line_at(TextArea *area, size_t pos)
+{
+    // first line that starts after "pos", the one before contains it
+    size_t lo = 1, hi = area->lines.count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(text_area_line_start(area, mid) <= pos) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo - 1;
+}
+
+// shifts the start of the lines from "from" on by "shift"
+static void shift_lines(TextAreaLines *lines, size_t from, size_t shift)
+{
+    // the pending delta is moved to start at "from", only one of the loops runs and
+    // only over the lines between the last edit and this one
+    for(size_t i = lines->delta_line; i < from && i < lines->count; i++) {
+        lines->items[i] += lines->delta;
+    }
+    for(size_t i = from; i < lines->delta_line && i < lines->count; i++) {
+        lines->items[i] -= lines->delta;
+    }
+
+    lines->delta_line = from;
+    lines->delta += shift;
+}
+
+// the x of "line" are measured again after it's edited, and the ones of the lines
+// after it too when lines were added or removed since they are renumbered
+static void invalidate_x_index(TextArea *area, size_t line, bool renumbered)
+{
+    for(size_t i = 0; i < TEXT_AREA_X_CACHE_LINES; i++) {
+        TextAreaXIndex *index = &area->x_index[i];
+        if(index->line == line || (renumbered && index->line > line)) index->count = 0;
+    }
+}
+
+static void insert_text(TextArea *area, size_t pos, const char *text, size_t size)
+{
+    if(size == 0) return;
+
+    String *str = &area->text;
+    da_reserve(str, str->count + size);
+    memmove(str->items + pos + size, str->items + pos, str->count - pos);
+    memcpy(str->items + pos, text, size);
+    str->count += size;
+
+    TextAreaLines *lines = &area->lines;
+    size_t line = text_area_line_at(area, pos);
+    shift_lines(lines, line + 1, size);
+
+    size_t new_lines = 0;
+    for(size_t i = 0; i < size; i++) {
+        if(text[i] == '\n') new_lines++;
+    }
+
+    if(new_lines > 0) {
+        size_t at = line + 1;
+        da_reserve(lines, lines->count + new_lines);
+        memmove(
+            lines->items + at + new_lines,
+            lines->items + at,
+            (lines->count - at)*sizeof(*lines->items)
+        );
+        lines->count += new_lines;
+
+        // they are after the edit, so they are stored without the pending delta
+        for(size_t i = 0; i < size; i++) {
+            if(text[i] == '\n') lines->items[at++] = pos + i + 1 - lines->delta;
+        }
+    }
+
+    // only the edited line is rewrapped, the new ones after it are wrapped when seen
+    if(area->wrap_enabled && new_lines > 0) {
+        text_wrap_splice(&area->wrap, line, 1, new_lines + 1);
+    } else if(area->wrap_enabled) {
+        text_wrap_invalidate(&area->wrap, line);
+    }
+
+    invalidate_x_index(area, line, new_lines > 0);
+    text_find_edit(&area->find, str->items, str->count, pos, 0, size);
+    if(area->highlighter != NULL) highlighter_edit(area->highlighter, pos, 0, size);
+    area->text_version++;
+}
+
+static void remove_text(TextArea *area, size_t start, size_t end)
+{
+    if(start >= end) return;
+
+    TextAreaLines *lines = &area->lines;
+    size_t line = text_area_line_at(area, start);
+    size_t last = text_area_line_at(area, end);
+
+    string_remove_slice(&area->text, start, end);
+    shift_lines(lines, line + 1, 0 - (end - start));
+
+    // the lines that started inside of the removed text are merged into "line"
+    size_t removed = last - line;
+    if(removed > 0) {
+        memmove(
+            lines->items + line + 1,
+            lines->items + last + 1,
+            (lines->count - last - 1)*sizeof(*lines->items)
+        );
+        lines->count -= removed;
+    }
+
+    if(area->wrap_enabled && removed > 0) {
+        text_wrap_splice(&area->wrap, line, removed + 1, 1);
+    } else if(area->wrap_enabled) {
+        text_wrap_invalidate(&area->wrap, line);
+    }
+
+    invalidate_x_index(area, line, removed > 0);
+    text_find_edit(&area->find, area->text.items, area->text.count, start, end - start, 0);
+    if(area->highlighter != NULL) highlighter_edit(area->highlighter, start, end - start, 0);
+    area->text_version++;
+}
+
+// rebuilds the line index of the whole text in a single pass
+static void index_lines(TextArea *area)
+{
+    TextAreaLines *lines = &area->lines;
+    lines->count = 0;
+    da_append(lines, 0);
+
+    const char *text = area->text.items;
+    if(area->text.count > 0) {
+        const char *end = text + area->text.count;
+        const char *newline = text;
+        while((newline = memchr(newline, '\n', end - newline)) != NULL) {
+            newline++;
+            da_append(lines, newline - text);
+        }
+    }
+
+    lines->delta = 0;
+    lines->delta_line = lines->count;
+    if(area->wrap_enabled) text_wrap_reset(&area->wrap, lines->count);
+    invalidate_x_index(area, 0, true);
+}
+
+void text_area_set_text(TextArea *area, const char *text, size_t size)
+{
+    if(area->highlighter != NULL) highlighter_edit(area->highlighter, 0, area->text.count, size);
+    area->text.count = 0;
+    da_append_many(&area->text, text, size);
+    index_lines(area);
+
+    area->cursor = (InputCursor) {.is_collapsed = true};
+    area->scroll = (TextAreaScroll) {0, 0};
+    area->goal_x = -1;
+    text_find_truncate(&area->find, 0);
+    area->text_version++;
+}
+
+void text_area_attach_lexer(TextArea *area, Lexer *lexer)
+{
+    area->highlighter = malloc(sizeof(Highlighter));
+    assert(area->highlighter != NULL && "No enough ram");
+
+    highlighter_init(area->highlighter, lexer);
+    highlighter_edit(area->highlighter, 0, 0, area->text.count);
+}
+
+// a double, the rows are multiplied by it to get their y
+static double get_line_height(TextArea *area)
+{
+    return area->font_size + TEXT_AREA_LINE_SPACING;
+}
+
+// insides of the text area
+static Rectangle get_text_area_box(TextArea *area)
+{
+    return (Rectangle) {
+        area->pos.x + area->padding.left,
+        area->pos.y + area->padding.top,
+        area->size.x - area->padding.left - area->padding.right,
+        area->size.y - area->padding.top - area->padding.bottom,
+    };
+}
+
+// advance of the char at "pos", "size" gets its length in bytes
+static float get_chr_advance(TextArea *area, size_t pos, size_t end, int *size)
+{
+    int codepoint = utf8_decode(area->text.items + pos, end - pos, size);
+    int glyph = ui_font_glyph_index(area->font, codepoint);
+    return ui_font_glyph_advance(area->font, glyph, area->font_size);
+}
+
+// the index of "line", emptied when the slot had another line or the font changed
+static TextAreaXIndex *get_x_index(TextArea *area, size_t line)
+{
+    TextAreaXIndex *index = &area->x_index[line % TEXT_AREA_X_CACHE_LINES];
+    if(index->line != line || index->font_version != area->font->widths_version) index->count = 0;
+    index->line = line;
+    index->font_version = area->font->widths_version;
+
+    if(index->count == 0) da_append(index, ((TextAreaXMark) {0, 0}));
+    return index;
+}
+
+// last saved x of "line" that is at or before both "pos" and "x", the line is
+// measured up to them first. The x of a mark includes the spacing after every
+// char before it, like the offsets of the drawing
+static TextAreaXMark find_x_mark(TextArea *area, size_t line, size_t pos, float x)
+{
+    TextAreaXIndex *index = get_x_index(area, line);
+    size_t start = text_area_line_start(area, line);
+    size_t end = text_area_line_end(area, line);
+
+    TextAreaXMark mark = index->items[index->count - 1];
+    while(mark.pos + TEXT_AREA_X_STEP <= pos && mark.x <= x && start + mark.pos < end) {
+        size_t next = mark.pos + TEXT_AREA_X_STEP;
+        while(mark.pos < next && start + mark.pos < end) {
+            int size;
+            mark.x += get_chr_advance(area, start + mark.pos, end, &size) + FONT_SPACING;
+            mark.pos += size;
+        }
+        da_append(index, mark);
+    }
+
+    // items[0] is the start of the line, it's returned even when "x" is left of it
+    size_t lo = 1, hi = index->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(index->items[mid].pos <= pos && index->items[mid].x <= x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return index->items[lo - 1];
+}
+
+// x of "pos" from the start of "row", only the chars before it are measured. The
+// rows of long lines start from their index, wrapped rows are never wider than the box
+static float get_x_in_row(TextArea *area, size_t row, size_t row_start, size_t pos)
+{
+    if(pos == row_start) return 0;
+
+    TextAreaXMark mark = {0, 0};
+    if(!area->wrap_enabled) mark = find_x_mark(area, row, pos - row_start, INFINITY);
+
+    size_t from = row_start + mark.pos;
+    if(from == pos) return mark.x - FONT_SPACING;
+
+    return mark.x + ui_font_measure(
+        area->font, area->text.items + from, pos - from, area->font_size, FONT_SPACING
+    ).x;
+}
+
+// first char of the row text[start..end) that isn't fully left of "x", "offset"
+// gets where it starts
+static size_t get_first_pos_right_of(
+    TextArea *area,
+    size_t row,
+    size_t start,
+    size_t end,
+    float x,
+    float *offset
+)
+{
+    TextAreaXMark mark = {0, 0};
+    if(!area->wrap_enabled) mark = find_x_mark(area, row, SIZE_MAX, x);
+
+    size_t pos = start + mark.pos;
+    *offset = mark.x;
+    while(pos < end) {
+        int size;
+        float advance = get_chr_advance(area, pos, end, &size);
+        if(*offset + advance > x) break;
+
+        *offset += advance + FONT_SPACING;
+        pos += size;
+    }
+
+    return pos;
+}
+
+static size_t get_next_chr_pos(TextArea *area, size_t pos)
+{
+    if(pos < area->text.count) pos++;
+    while(pos < area->text.count && utf8_is_continuation(area->text.items[pos])) pos++;
+    return pos;
+}
+
+static size_t get_prev_chr_pos(TextArea *area, size_t pos)
+{
+    if(pos > 0) pos--;
+    while(pos > 0 && utf8_is_continuation(area->text.items[pos])) pos--;
+    return pos;
+}
+
+// the lines are wrapped on demand, so the rows of a line are up to date whenever
+// they are looked at
+static void wrap_line(TextArea *area, size_t line)
+{
+    if(!text_wrap_is_stale(&area->wrap, line)) return;
+
+    size_t start = text_area_line_start(area, line);
+    size_t end = text_area_line_end(area, line);
+    text_wrap_paragraph(&area->wrap, line, area->text.items + start, end - start);
+}
+
+static size_t get_row_count(TextArea *area)
+{
+    if(!area->wrap_enabled) return area->lines.count;
+    return text_wrap_row_count(&area->wrap);
+}
+
+// offsets where "row" starts and ends, a wrapped row ends where the next one starts
+static void get_row_range(TextArea *area, size_t row, size_t *start, size_t *end)
+{
+    if(!area->wrap_enabled) {
+        *start = text_area_line_start(area, row);
+        *end = text_area_line_end(area, row);
+        return;
+    }
+
+    // wrapping a stale line changes its number of rows, so the line of the row is
+    // looked for again after that
+    TextWrap *wrap = &area->wrap;
+    size_t line = text_wrap_paragraph_at_row(wrap, row);
+    while(text_wrap_is_stale(wrap, line)) {
+        wrap_line(area, line);
+        line = text_wrap_paragraph_at_row(wrap, row);
+    }
+
+    size_t line_start = text_area_line_start(area, line);
+    size_t size = text_area_line_end(area, line) - line_start;
+    text_wrap_row_span(wrap, line, row - text_wrap_first_row(wrap, line), size, start, end);
+    *start += line_start;
+    *end += line_start;
+}
+
+// row of the char at "pos", the end of a wrapped row is at the start of the next one
+static size_t get_row_at(TextArea *area, size_t pos)
+{
+    size_t line = text_area_line_at(area, pos);
+    if(!area->wrap_enabled) return line;
+
+    wrap_line(area, line);
+    size_t offset = pos - text_area_line_start(area, line);
+    return text_wrap_first_row(&area->wrap, line) + text_wrap_row_at(&area->wrap, line, offset);
+}
+
+// position in "row" closest to "x", with the same threshold as Input
+static size_t get_pos_at_x(TextArea *area, size_t row, float x)
+{
+    size_t pos, end;
+    get_row_range(area, row, &pos, &end);
+
+    // the measuring starts from the last saved x before "x" on long lines
+    TextAreaXMark mark = {0, 0};
+    if(!area->wrap_enabled) mark = find_x_mark(area, row, SIZE_MAX, x);
+    pos += mark.pos;
+    float offset = mark.x;
+
+    while(pos < end) {
+        int size;
+        float advance = get_chr_advance(area, pos, end, &size);
+        if(offset + advance / 1.5 > x) break;
+
+        offset += advance + FONT_SPACING;
+        pos += size;
+    }
+
+    // the cursor at the end of a wrapped row would be drawn at the start of the next one
+    if(pos == end && end < area->text.count && area->text.items[end] != '\n') {
+        pos = get_prev_chr_pos(area, end);
+    }
+
+    return pos;
+}
+
+static void get_visible_rows(TextArea *area, size_t *first, size_t *last)
+{
+    Rectangle box = get_text_area_box(area);
+    double line_height = get_line_height(area);
+    size_t row_count = get_row_count(area);
+
+    *first = area->scroll.y / line_height;
+    *last = (area->scroll.y + box.height) / line_height + 1;
+    if(*last > row_count) *last = row_count;
+    if(*first > *last) *first = *last;
+}
+
+static void clamp_scroll(TextArea *area)
+{
+    Rectangle box = get_text_area_box(area);
+    double max_scroll = get_row_count(area) * get_line_height(area) - box.height;
+
+    if(area->scroll.y > max_scroll) area->scroll.y = max_scroll;
+    if(area->scroll.y < 0) area->scroll.y = 0;
+    if(area->scroll.x < 0 || area->wrap_enabled) area->scroll.x = 0;
+}
+
+// text position of the first visible row, "offset" gets how much of it is scrolled
+static size_t get_scroll_anchor(TextArea *area, float *offset)
+{
+    double line_height = get_line_height(area);
+    size_t row = area->scroll.y / line_height;
+    *offset = area->scroll.y - row * line_height;
+
+    size_t start, end;
+    get_row_range(area, row, &start, &end);
+    return start;
+}
+
+// scrolls back to the anchor after the rows above it changed
+static void restore_scroll_anchor(TextArea *area, size_t anchor, float offset)
+{
+    area->scroll.y = get_row_at(area, anchor) * get_line_height(area) + offset;
+    clamp_scroll(area);
+}
+
+void text_area_set_wrap(TextArea *area, bool enabled)
+{
+    if(enabled == area->wrap_enabled) return;
+
+    float offset;
+    size_t anchor = get_scroll_anchor(area, &offset);
+
+    area->wrap_enabled = enabled;
+    text_wrap_reset(&area->wrap, enabled ? area->lines.count : 0);
+    if(enabled) text_wrap_set_width(&area->wrap, get_text_area_box(area).width);
+
+    restore_scroll_anchor(area, anchor, offset);
+}
+
+// a change of the width or of the glyph widths makes every line stale, the first
+// visible row is wrapped right away so it stays at the top and the rest of the
+// visible rows are wrapped when they are drawn
+static void update_wrap_width(TextArea *area)
+{
+    if(!area->wrap_enabled) return;
+
+    float offset;
+    size_t anchor = get_scroll_anchor(area, &offset);
+
+    if(text_wrap_set_width(&area->wrap, get_text_area_box(area).width)) {
+        restore_scroll_anchor(area, anchor, offset);
+    }
+}
+
+// the hidden stale lines are wrapped a few at a time after drawing, so a resize or a
+// big paste never blocks a frame
+static void wrap_hidden_lines(TextArea *area)
+{
+    TextWrap *wrap = &area->wrap;
+    if(!area->wrap_enabled || wrap->stale_count == 0) return;
+
+    float offset;
+    size_t anchor = get_scroll_anchor(area, &offset);
+
+    size_t budget = TEXT_AREA_WRAP_BUDGET;
+    size_t line;
+    while(budget > 0 && (line = text_wrap_next_stale(wrap)) < area->lines.count) {
+        size_t size = text_area_line_end(area, line) - text_area_line_start(area, line) + 1;
+        wrap_line(area, line);
+        budget -= size < budget ? size : budget;
+    }
+
+    restore_scroll_anchor(area, anchor, offset);
+}
+
+// updates the scroll if "pos" is not visible to make it visible
+static void update_scroll_to(TextArea *area, size_t pos)
+{
+    Rectangle box = get_text_area_box(area);
+    double line_height = get_line_height(area);
+    size_t row = get_row_at(area, pos);
+    size_t row_start, row_end;
+    get_row_range(area, row, &row_start, &row_end);
+
+    double y = row * line_height;
+    if(y < area->scroll.y) {
+        area->scroll.y = y;
+    } else if(y + line_height > area->scroll.y + box.height) {
+        area->scroll.y = y + line_height - box.height;
+    }
+
+    float x = get_x_in_row(area, row, row_start, pos);
+    if(x < area->scroll.x) {
+        area->scroll.x = x;
+    } else if(x + CURSOR_LINE_WIDTH > area->scroll.x + box.width) {
+        area->scroll.x = x + CURSOR_LINE_WIDTH - box.width;
+    }
+
+    clamp_scroll(area);
+}
+
+static void set_cursor_pos(TextArea *area, size_t pos)
+{
+    area->cursor.pos = pos;
+    area->cursor.blink_t = 0;
+    area->cursor.is_collapsed = true;
+    area->goal_x = -1;
+
+    update_scroll_to(area, pos);
+}
+
+static void set_cursor_selection(TextArea *area, size_t start, size_t end)
+{
+    if(start != area->cursor.selection.start) {
+        update_scroll_to(area, start);
+    } else if(end != area->cursor.selection.end) {
+        update_scroll_to(area, end);
+    }
+
+    area->goal_x = -1;
+
+    if(start != end) {
+        area->cursor.is_collapsed = false;
+        area->cursor.selection.start = start;
+        area->cursor.selection.end = end;
+    } else {
+        area->cursor.is_collapsed = true;
+        area->cursor.pos = start;
+        area->cursor.blink_t = 0;
+    }
+}
+
+static void remove_selected_text(TextArea *area)
+{
+    InputCursor *cursor = &area->cursor;
+    if(cursor->is_collapsed) return;
+
+    InputSelection sel = get_corrected_selection(cursor->selection);
+    remove_text(area, sel.start, sel.end);
+    set_cursor_pos(area, sel.start);
+}
+
+// the word is looked for only inside of the line of "pos"
+static InputSelection get_word_at(TextArea *area, size_t pos)
+{
+    String *text = &area->text;
+    if(text->count == 0) return (InputSelection) {0, 0};
+    if(pos >= text->count) pos = text->count - 1;
+
+    int chr_class = get_chr_class(text->items[pos]);
+    size_t start = pos, end = pos;
+    while(start > 0 && text->items[start - 1] != '\n'
+        && get_chr_class(text->items[start - 1]) == chr_class) start--;
+    while(end < text->count && text->items[end] != '\n'
+        && get_chr_class(text->items[end]) == chr_class) end++;
+
+    return (InputSelection) {start, end};
+}
+
+static size_t get_pos_pointed_by_mouse(TextArea *area)
+{
+    Rectangle box = get_text_area_box(area);
+    Vector2 mouse = input_source_get_mouse_position();
+
+    // while dragging outside of the box the closest visible char is the one pointed
+    if(mouse.x < box.x) mouse.x = box.x;
+    if(mouse.x > box.x + box.width) mouse.x = box.x + box.width;
+    if(mouse.y < box.y) mouse.y = box.y;
+    if(mouse.y > box.y + box.height - 1) mouse.y = box.y + box.height - 1;
+
+    size_t row = (mouse.y - box.y + area->scroll.y) / get_line_height(area);
+    size_t row_count = get_row_count(area);
+    if(row >= row_count) row = row_count - 1;
+
+    return get_pos_at_x(area, row, mouse.x - box.x + area->scroll.x);
+}
+
+// scrolls while dragging a selection past the sides of the text area, the further
+// away the mouse is the faster it scrolls
+static void auto_scroll(TextArea *area, Vector2 mouse)
+{
+    Rectangle box = get_text_area_box(area);
+    float dt = input_source_get_frame_time();
+
+    if(mouse.x < box.x) {
+        area->scroll.x -= (box.x - mouse.x) * AUTO_SCROLL_SPEED * dt;
+    } else if(mouse.x > box.x + box.width) {
+        area->scroll.x += (mouse.x - box.x - box.width) * AUTO_SCROLL_SPEED * dt;
+    }
+
+    if(mouse.y < box.y) {
+        area->scroll.y -= (box.y - mouse.y) * AUTO_SCROLL_SPEED * dt;
+    } else if(mouse.y > box.y + box.height) {
+        area->scroll.y += (mouse.y - box.y - box.height) * AUTO_SCROLL_SPEED * dt;
+    }
+
+    clamp_scroll(area);
+}
+
+static void handle_mouse(TextArea *area)
+{
+    Vector2 mouse_pos = input_source_get_mouse_position();
+    Rectangle rect = {area->pos.x, area->pos.y, area->size.x, area->size.y};
+    area->hovered = CheckCollisionPointRec(mouse_pos, rect);
+
+    // the focus changes on press, so a drag selection released outside keeps it
+    if(input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        area->focused = area->hovered;
+        area->cursor.blink_t = 0;
+    }
+
+    float wheel = input_source_get_mouse_wheel_move();
+    if(area->hovered && wheel != 0) {
+        area->scroll.y -= wheel * TEXT_AREA_WHEEL_LINES * get_line_height(area);
+        clamp_scroll(area);
+    }
+
+    if(area->hovered && input_source_is_mouse_button_pressed(MOUSE_BUTTON_LEFT)) {
+        size_t pos = get_pos_pointed_by_mouse(area);
+        double time = input_source_get_time();
+
+        bool is_multi_click = time - area->last_click_time < MULTI_CLICK_TIME
+            && pos == area->last_click_pos;
+        area->click_count = is_multi_click ? area->click_count % 3 + 1 : 1;
+        area->last_click_time = time;
+        area->last_click_pos = pos;
+
+        if(area->click_count == 1) {
+            set_cursor_pos(area, pos);
+        } else if(area->click_count == 2) {
+            InputSelection word = get_word_at(area, pos);
+            set_cursor_selection(area, word.start, word.end);
+        } else {
+            size_t line = text_area_line_at(area, pos);
+            set_cursor_selection(
+                area, text_area_line_start(area, line), text_area_line_end(area, line)
+            );
+        }
+
+        area->drag_start = pos;
+        // double and triple clicks select on press, dragging only applies to single clicks
+        area->dragging = area->click_count == 1;
+    }
+
+    if(!area->dragging) return;
+
+    if(input_source_is_mouse_button_down(MOUSE_BUTTON_LEFT)) {
+        auto_scroll(area, mouse_pos);
+        size_t pos = get_pos_pointed_by_mouse(area);
+
+        bool moved = area->cursor.is_collapsed ? pos != area->cursor.pos
+            : pos != area->cursor.selection.end;
+        if(moved) set_cursor_selection(area, area->drag_start, pos);
+    }
+
+    if(input_source_is_mouse_button_released(MOUSE_BUTTON_LEFT)) {
+        set_cursor_selection(area, area->drag_start, get_pos_pointed_by_mouse(area));
+        area->dragging = false;
+    }
+}
+
+static bool is_key_active(int key)
+{
+    return input_source_is_key_pressed(key) || input_source_is_key_pressed_repeat(key);
+}
+
+static void insert_at_cursor(TextArea *area, const char *text, size_t size)
+{
+    remove_selected_text(area);
+    insert_text(area, area->cursor.pos, text, size);
+    // the glyphs of new codepoints are rasterized here by dynamic fonts
+    set_cursor_pos(area, area->cursor.pos + size);
+}
+
+static void handle_editing(TextArea *area)
+{
+    int chr;
+    while((chr = input_source_get_char()) != 0) {
+        latency_mark_char(chr);
+
+        char bytes[4];
+        int size = utf8_encode(chr, bytes);
+        insert_at_cursor(area, bytes, size);
+    }
+
+    if(is_key_active(KEY_ENTER) || is_key_active(KEY_KP_ENTER)) {
+        insert_at_cursor(area, "\n", 1);
+    }
+
+    if(!is_key_active(KEY_BACKSPACE)) return;
+
+    InputCursor *cursor = &area->cursor;
+    if(!cursor->is_collapsed) {
+        remove_selected_text(area);
+    } else if(cursor->pos > 0) {
+        size_t start = get_prev_chr_pos(area, cursor->pos);
+        // ctrl removes the whole word, or the run of spaces, before the cursor
+        if(is_ctrl_down()) start = get_word_at(area, start).start;
+
+        remove_text(area, start, cursor->pos);
+        set_cursor_pos(area, start);
+    }
+}
+
+static void copy_selected_text_to_clipboard(TextArea *area)
+{
+    InputSelection selection = get_corrected_selection(area->cursor.selection);
+    copy_to_clipboard(area->text.items + selection.start, selection.end - selection.start);
+}
+
+static void handle_clipboard(TextArea *area)
+{
+    if(!is_ctrl_down()) return;
+
+    InputCursor *cursor = &area->cursor;
+    if(input_source_is_key_pressed(KEY_V) && !area->read_only) {
+        // PASTE, the new lines are kept but '\r' is dropped
+        const char *raw = input_source_get_clipboard_text();
+        size_t size = strlen(raw);
+        if(size == 0) return;
+
+        char *text = malloc(size);
+        assert(text != NULL && "No enough ram");
+        size_t j = 0;
+        for(size_t i = 0; i < size; i++) {
+            if(raw[i] != '\r') text[j++] = raw[i];
+        }
+
+        insert_at_cursor(area, text, j);
+        free(text);
+    } else if(input_source_is_key_pressed(KEY_C) && !cursor->is_collapsed) {
+        copy_selected_text_to_clipboard(area);
+    } else if(input_source_is_key_pressed(KEY_X) && !cursor->is_collapsed && !area->read_only) {
+        // CUT
+        copy_selected_text_to_clipboard(area);
+        remove_selected_text(area);
+    } else if(input_source_is_key_pressed(KEY_A)) {
+        // SELECT ALL
+        set_cursor_selection(area, 0, area->text.count);
+    }
+}
+
+// moves the cursor, or the end of the selection, one row up or down keeping its x
+static void move_vertically(TextArea *area, bool down, bool select)
+{
+    InputCursor *cursor = &area->cursor;
+    size_t from = cursor->is_collapsed ? cursor->pos : cursor->selection.end;
+    size_t row = get_row_at(area, from);
+    size_t row_start, row_end;
+    get_row_range(area, row, &row_start, &row_end);
+
+    float goal_x = area->goal_x;
+    if(goal_x < 0) goal_x = get_x_in_row(area, row, row_start, from);
+
+    size_t to;
+    if(!down && row == 0) {
+        to = 0;
+    } else if(down && row + 1 == get_row_count(area)) {
+        to = area->text.count;
+    } else {
+        to = get_pos_at_x(area, down ? row + 1 : row - 1, goal_x);
+    }
+
+    if(select) {
+        set_cursor_selection(area, cursor->is_collapsed ? cursor->pos : cursor->selection.start, to);
+    } else {
+        set_cursor_pos(area, to);
+    }
+
+    area->goal_x = goal_x;
+}
+
+static void handle_arrow_keys(TextArea *area)
+{
+    InputCursor *cursor = &area->cursor;
+    bool shift = input_source_is_key_down(KEY_LEFT_SHIFT) || input_source_is_key_down(KEY_RIGHT_SHIFT);
+
+    if(is_key_active(KEY_UP)) {
+        move_vertically(area, false, shift);
+    } else if(is_key_active(KEY_DOWN)) {
+        move_vertically(area, true, shift);
+    } else if(is_key_active(KEY_RIGHT)) {
+        if(shift) {
+            size_t from = cursor->is_collapsed ? cursor->pos : cursor->selection.start;
+            size_t end = cursor->is_collapsed ? cursor->pos : cursor->selection.end;
+            set_cursor_selection(area, from, get_next_chr_pos(area, end));
+        } else if(!cursor->is_collapsed) {
+            // removes the selection and sets the cursor at the end of it
+            set_cursor_pos(area, get_corrected_selection(cursor->selection).end);
+        } else {
+            set_cursor_pos(area, get_next_chr_pos(area, cursor->pos));
+        }
+    } else if(is_key_active(KEY_LEFT)) {
+        if(shift) {
+            size_t from = cursor->is_collapsed ? cursor->pos : cursor->selection.start;
+            size_t end = cursor->is_collapsed ? cursor->pos : cursor->selection.end;
+            set_cursor_selection(area, from, get_prev_chr_pos(area, end));
+        } else if(!cursor->is_collapsed) {
+            // removes the selection and sets the cursor at the start of it
+            set_cursor_pos(area, get_corrected_selection(cursor->selection).start);
+        } else {
+            set_cursor_pos(area, get_prev_chr_pos(area, cursor->pos));
+        }
+    }
+}
+
+static void draw_text(TextArea *area)
+{
+    Rectangle box = get_text_area_box(area);
+    render_set_layer(RENDER_LAYER_TEXT);
+    render_push_clip(box);
+
+    if(area->text.count == 0) {
+        ui_font_draw(
+            area->font,
+            area->placeholder,
+            strlen(area->placeholder),
+            (Vector2) {box.x, box.y},
+            area->font_size,
+            FONT_SPACING,
+            ColorAlpha(area->font_color, 0.5)
+        );
+    }
+
+    double line_height = get_line_height(area);
+    size_t first, last;
+    get_visible_rows(area, &first, &last);
+
+    for(size_t row = first; row < last && area->text.count > 0; row++) {
+        // wrapping the visible lines can change the number of rows while drawing
+        if(row >= get_row_count(area)) break;
+
+        size_t start, end;
+        get_row_range(area, row, &start, &end);
+
+        // skips the chars that are left of the box
+        float offset;
+        size_t pos = get_first_pos_right_of(area, row, start, end, area->scroll.x, &offset);
+
+        // and stops at the first one right of it
+        size_t visible_end = pos;
+        float visible_offset = offset;
+        while(visible_end < end && visible_offset < area->scroll.x + box.width) {
+            int size;
+            visible_offset += get_chr_advance(area, visible_end, end, &size) + FONT_SPACING;
+            visible_end += size;
+        }
+
+        Vector2 text_pos = {
+            .x = box.x + offset - area->scroll.x,
+            .y = box.y + row * line_height - area->scroll.y,
+        };
+        if(area->highlighter != NULL) {
+            highlighter_draw(
+                area->highlighter,
+                area->font,
+                area->text.items,
+                pos,
+                visible_end,
+                text_pos,
+                area->font_size,
+                area->font_color
+            );
+        } else {
+            ui_font_draw(
+                area->font,
+                area->text.items + pos,
+                visible_end - pos,
+                text_pos,
+                area->font_size,
+                FONT_SPACING,
+                area->font_color
+            );
+        }
+    }
+
+    render_pop_clip();
+
+    if(area->focused) {
+        int border_size = 2;
+        Rectangle rect = {area->pos.x, area->pos.y, area->size.x, area->size.y};
+        render_set_layer(RENDER_LAYER_OVERLAY);
+        render_rect_lines(rect, border_size, area->border_color);
+    }
+}
+
+// highlights the part of "range" inside of the row that ends at "end", from
+// "from_x" to "to_x"
+static void highlight_span(
+    TextArea *area,
+    size_t row,
+    size_t end,
+    InputSelection range,
+    float from_x,
+    float to_x,
+    Color color
+)
+{
+    Rectangle box = get_text_area_box(area);
+    // a selected new line is shown as a space at the end of the line
+    bool ends_line = end < area->text.count && area->text.items[end] == '\n';
+    if(range.end > end && ends_line) to_x += area->font_size / 2;
+    if(to_x <= from_x) return;
+
+    render_rect((Rectangle) {
+        .x = box.x + from_x - area->scroll.x,
+        .y = box.y + row * get_line_height(area) - area->scroll.y - 1,
+        .width = to_x - from_x,
+        .height = area->font_size + 2,
+    }, color);
+}
+
+// highlights the part of "range" that is inside of "row", that spans text[start..end)
+static void highlight_in_row(
+    TextArea *area,
+    size_t row,
+    size_t start,
+    size_t end,
+    InputSelection range,
+    Color color
+)
+{
+    if(range.end < start || range.start > end) return;
+
+    size_t from = range.start > start ? range.start : start;
+    size_t to = range.end < end ? range.end : end;
+    float from_x = get_x_in_row(area, row, start, from);
+    float to_x = get_x_in_row(area, row, start, to);
+
+    // same offset as Input when the selection doesn't start at the first char
+    if(from > start) from_x += FONT_SPACING;
+    highlight_span(area, row, end, range, from_x, to_x, color);
+}
+
+static void draw_selection(TextArea *area)
+{
+    InputSelection sel = get_corrected_selection(area->cursor.selection);
+    Color color = ColorAlpha(area->font_color, 0.4);
+
+    size_t first, last;
+    get_visible_rows(area, &first, &last);
+
+    render_set_layer(RENDER_LAYER_HIGHLIGHT);
+    render_push_clip(get_text_area_box(area));
+
+    for(size_t row = first; row < last && row < get_row_count(area); row++) {
+        size_t start, end;
+        get_row_range(area, row, &start, &end);
+        highlight_in_row(area, row, start, end, sel, color);
+    }
+
+    render_pop_clip();
+}
+
+// the matches of every visible row are found with a binary search. They are
+// measured from the first visible char, that is found with the index of the line,
+// and x moves on from one match to the next, the ones right of the box are skipped
+static void draw_find_matches(TextArea *area)
+{
+    TextFind *find = &area->find;
+    Rectangle box = get_text_area_box(area);
+    Color color = ColorAlpha(area->font_color, 0.2);
+
+    size_t first, last;
+    get_visible_rows(area, &first, &last);
+
+    float right = area->scroll.x + box.width;
+    render_set_layer(RENDER_LAYER_HIGHLIGHT);
+    render_push_clip(box);
+
+    for(size_t row = first; row < last && row < get_row_count(area); row++) {
+        size_t start, end;
+        get_row_range(area, row, &start, &end);
+
+        float offset;
+        size_t pos = get_first_pos_right_of(area, row, start, end, area->scroll.x, &offset);
+
+        for(size_t i = text_find_first_after(find, pos); i < find->matches.count; i++) {
+            InputSelection match;
+            text_find_match(find, i, &match.start, &match.end);
+            if(match.start >= end) break;
+
+            while(pos < match.start && offset <= right) {
+                int size;
+                offset += get_chr_advance(area, pos, end, &size) + FONT_SPACING;
+                pos += size;
+            }
+            if(offset > right) break;
+
+            // the ones that start left of the first visible char are rare
+            if(pos != match.start) {
+                highlight_in_row(area, row, start, end, match, color);
+                continue;
+            }
+
+            size_t to = match.end < end ? match.end : end;
+            size_t to_pos = pos;
+            float to_offset = offset;
+            while(to_pos < to) {
+                int size;
+                to_offset += get_chr_advance(area, to_pos, end, &size) + FONT_SPACING;
+                to_pos += size;
+            }
+
+            float to_x = to_pos > pos ? to_offset - FONT_SPACING : offset;
+            highlight_span(area, row, end, match, offset, to_x, color);
+        }
+    }
+
+    render_pop_clip();
+}
+
+static void update_cursor_blink(TextArea *area)
+{
+    InputCursor *cursor = &area->cursor;
+    if(!cursor->is_collapsed || !area->focused) return;
+
+    cursor->blink_t += input_source_get_frame_time();
+
+    if(cursor->blink_t > CURSOR_BLINK_RATE * 2) {
+        cursor->blink_t = 0;
+    }
+}
+
+static bool is_cursor_visible(TextArea *area)
+{
+    InputCursor *cursor = &area->cursor;
+    return cursor->is_collapsed && area->focused && cursor->blink_t < CURSOR_BLINK_RATE;
+}
+
+static Rectangle get_cursor_rect(TextArea *area)
+{
+    Rectangle box = get_text_area_box(area);
+    size_t row = get_row_at(area, area->cursor.pos);
+    size_t row_start, row_end;
+    get_row_range(area, row, &row_start, &row_end);
+    float x = get_x_in_row(area, row, row_start, area->cursor.pos);
+
+    return (Rectangle) {
+        .x = box.x + x - area->scroll.x,
+        .y = box.y + row * get_line_height(area) - area->scroll.y - 1,
+        .width = CURSOR_LINE_WIDTH,
+        .height = area->font_size + 2,
+    };
+}
+
+static void draw_cursor(TextArea *area)
+{
+    render_set_layer(RENDER_LAYER_OVERLAY);
+    render_push_clip(get_text_area_box(area));
+    render_rect(get_cursor_rect(area), area->font_color);
+    render_pop_clip();
+}
+
+// same as the damage of Input, only the cursor is repainted when it just blinked
+static void damage_changes(TextArea *area)
+{
+    TextAreaDrawState state;
+    memset(&state, 0, sizeof(state));
+    state.pos = area->pos;
+    state.size = area->size;
+    state.focused = area->focused;
+    state.is_collapsed = area->cursor.is_collapsed;
+    state.cursor_visible = is_cursor_visible(area);
+    state.cursor_pos = area->cursor.pos;
+    state.selection = area->cursor.selection;
+    // field by field, the padding of the struct has to stay zero
+    state.scroll.x = area->scroll.x;
+    state.scroll.y = area->scroll.y;
+    state.text_version = area->text_version;
+    state.wrap_enabled = area->wrap_enabled;
+    state.find_version = area->find.version;
+    if(area->highlighter != NULL) state.highlight_version = area->highlighter->version;
+
+    TextAreaDrawState *drawn = &area->drawn;
+    bool cursor_toggled = state.cursor_visible != drawn->cursor_visible;
+    drawn->cursor_visible = state.cursor_visible;
+
+    if(memcmp(&state, drawn, sizeof(state)) != 0) {
+        render_add_damage((Rectangle) {drawn->pos.x, drawn->pos.y, drawn->size.x, drawn->size.y});
+        render_add_damage((Rectangle) {area->pos.x, area->pos.y, area->size.x, area->size.y});
+    } else if(cursor_toggled) {
+        render_add_damage(get_cursor_rect(area));
+    }
+
+    *drawn = state;
+}
+
+// over the top right corner of the text area
+static Rectangle get_find_bar_rect(TextArea *area)
+{
+    return (Rectangle) {
+        .x = area->pos.x + area->size.x / 2,
+        .y = area->pos.y,
+        .width = area->size.x / 2,
+        .height = text_find_bar_height(&area->find, area->font_size),
+    };
+}
+
+// the new text is built in a single pass instead of splicing every match, then
+// the lines are indexed again
+static void replace_all(TextArea *area)
+{
+    InputCursor *cursor = &area->cursor;
+    InputSelection selection = get_corrected_selection(cursor->selection);
+    size_t pos = cursor->is_collapsed ? cursor->pos : selection.start;
+
+    String replaced = {0};
+    size_t count = text_find_replace_all(
+        &area->find, area->text.items, area->text.count, &replaced, &pos
+    );
+    if(count == 0) return;
+
+    if(area->highlighter != NULL) {
+        highlighter_edit(area->highlighter, 0, area->text.count, replaced.count);
+    }
+    string_free(&area->text);
+    area->text = replaced;
+    index_lines(area);
+    area->text_version++;
+    set_cursor_pos(area, pos);
+}
+
+// same as the find keys of Input
+static void handle_find_keys(TextArea *area)
+{
+    TextFind *find = &area->find;
+    String *text = &area->text;
+    TextFindAction action = text_find_handle_keys(find, text->items, text->count);
+
+    InputCursor *cursor = &area->cursor;
+    InputSelection selection = get_corrected_selection(cursor->selection);
+    bool found = false;
+    if(action == TEXT_FIND_NEXT) {
+        size_t pos = cursor->is_collapsed ? cursor->pos : selection.start + 1;
+        found = text_find_next(find, text->items, text->count, pos);
+    } else if(action == TEXT_FIND_PREVIOUS) {
+        size_t pos = cursor->is_collapsed ? cursor->pos : selection.start;
+        found = text_find_previous(find, text->items, text->count, pos);
+    } else if(action == TEXT_FIND_REPLACE_ALL && !area->read_only) {
+        replace_all(area);
+    }
+
+    if(found) {
+        size_t start, end;
+        text_find_match(find, find->current, &start, &end);
+        set_cursor_selection(area, start, end);
+    }
+}
+
+void handle_text_area(TextArea *area)
+{
+    update_wrap_width(area);
+    handle_mouse(area);
+    if(area->focused) {
+        // while the find bar is open the typed chars and enter go to it
+        bool finding = area->find.active;
+        handle_find_keys(area);
+        if(!finding && !area->find.active && !area->read_only) handle_editing(area);
+        handle_arrow_keys(area);
+        handle_clipboard(area);
+    }
+
+    TextFind *find = &area->find;
+    if(find->active) text_find_update(find, area->text.items, area->text.count, TEXT_FIND_BUDGET);
+
+    // same as in Input, the edits are lexed again before drawing
+    Highlighter *highlighter = area->highlighter;
+    if(highlighter != NULL && !highlighter_is_done(highlighter, area->text.count)) {
+        highlighter_update(highlighter, area->text.items, area->text.count, HIGHLIGHT_BUDGET);
+    }
+
+    update_cursor_blink(area);
+    damage_changes(area);
+
+    render_set_layer(RENDER_LAYER_BACKGROUND);
+    render_rect((Rectangle) {
+        area->pos.x, area->pos.y, area->size.x, area->size.y
+    }, area->bg_color);
+
+    if(find->active && area->text.count > 0) {
+        draw_find_matches(area);
+    }
+
+    if(!area->cursor.is_collapsed && area->focused) {
+        draw_selection(area);
+    }
+
+    draw_text(area);
+
+    if(is_cursor_visible(area)) {
+        draw_cursor(area);
+    }
+
+    if(find->active) {
+        text_find_draw_bar(
+            find,
+            area->text.count,
+            get_find_bar_rect(area),
+            area->font,
+            area->font_size,
+            area->font_color,
+            area->bg_color,
+            area->border_color
+        );
+    }
+
+    wrap_hidden_lines(area);
+}
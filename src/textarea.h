@@ -0,0 +1,122 @@
+#ifndef TEXTAREA_H
+#define TEXTAREA_H
+
+#include "cTooling.h"
+#include "font.h"
+#include "input.h"
+#include "raylib.h"
+#include "wrap.h"
+
+#define TEXT_AREA_LINE_SPACING 4 // extra pixels between two lines
+#define TEXT_AREA_WHEEL_LINES 3  // lines scrolled by every step of the mouse wheel
+#define TEXT_AREA_WRAP_BUDGET (64*1024) // bytes of hidden paragraphs rewrapped per frame
+#define TEXT_AREA_X_STEP 256       // bytes of a line measured between two saved x
+#define TEXT_AREA_X_CACHE_LINES 64 // lines whose x are kept, more than the visible ones
+
+// offsets where every line starts, items[0] is always 0. An edit shifts all the
+// lines after it, so the shift is kept pending in "delta" for the lines from
+// "delta_line" on. It's only applied to the lines between two edits when the next
+// edit is on another line, typing on the same line doesn't touch the rest
+typedef struct {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+    size_t delta_line;
+    size_t delta; // wraps around when the text shrinks, the sums still work
+} TextAreaLines;
+
+// x where the char at "pos" of a line starts, "pos" is from the start of the line
+typedef struct {
+    size_t pos;
+    float x;
+} TextAreaXMark;
+
+// x of a line every TEXT_AREA_X_STEP bytes, so the chars of a long line that is
+// scrolled right are found without measuring it from its start. It's extended
+// lazily up to where the line is looked at, and cleared when the line is edited
+// or when the font changes the glyph of a codepoint
+typedef struct {
+    TextAreaXMark *items;
+    size_t count;
+    size_t capacity;
+    size_t line;
+    unsigned int font_version;
+} TextAreaXIndex;
+
+// the vertical scroll is a double, a float can't address the rows of a document
+// of a few MB to the pixel
+typedef struct {
+    float x;
+    double y;
+} TextAreaScroll;
+
+// state that was drawn on the last frame, like InputDrawState
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    bool focused;
+    bool is_collapsed;
+    bool cursor_visible;
+    size_t cursor_pos;
+    InputSelection selection;
+    TextAreaScroll scroll;
+    size_t text_version;
+    bool wrap_enabled;
+    size_t find_version;
+    size_t highlight_version;
+} TextAreaDrawState;
+
+// multi-line version of Input, only the visible lines are measured and drawn.
+// The layout is made of rows, that are the lines themselves unless wrapping is on
+typedef struct {
+    Vector2 pos;
+    Vector2 size;
+    String text;
+    size_t text_version; // incremented on every change to the text
+    TextAreaDrawState drawn;
+    TextAreaLines lines;
+    // rows of every line when wrapping, the visible lines are rewrapped when they
+    // are drawn and the hidden ones a few at a time on every frame
+    TextWrap wrap;
+    bool wrap_enabled;
+    UIFont *font;
+    int font_size;
+    Color font_color;
+    const char *placeholder;
+    Padding padding;
+    bool focused;
+    bool hovered;
+    InputCursor cursor;
+    float goal_x; // x kept by the cursor while it moves up and down, -1 when unset
+    int click_count;
+    double last_click_time;
+    size_t last_click_pos;
+    bool dragging;
+    size_t drag_start;
+    TextAreaScroll scroll;
+    // used when there's no wrapping, the line of an index is the one stored in it
+    TextAreaXIndex x_index[TEXT_AREA_X_CACHE_LINES];
+    Color border_color;
+    Color bg_color;
+    bool read_only;
+    TextFind find; // ctrl + f highlights the matches of a query, shown on the top right
+    Highlighter *highlighter; // colors the tokens of the text, NULL when it's plain
+} TextArea;
+
+TextArea *create_text_area(InputProps props);
+void handle_text_area(TextArea *area);
+// replaces the whole text, the line index is rebuilt in a single pass
+void text_area_set_text(TextArea *area, const char *text, size_t size);
+// soft wraps the lines at the width of the text area, there's no horizontal scroll
+void text_area_set_wrap(TextArea *area, bool enabled);
+// colors the text with the tokens of "lexer", like input_attach_lexer
+void text_area_attach_lexer(TextArea *area, Lexer *lexer);
+
+size_t text_area_line_count(TextArea *area);
+size_t text_area_line_start(TextArea *area, size_t line);
+// offset of the '\n' that ends the line, or the end of the text for the last one
+size_t text_area_line_end(TextArea *area, size_t line);
+// line of the char at "pos", O(log n) on the number of lines
+size_t text_area_line_at(TextArea *area, size_t pos);
+
+#endif // TEXTAREA_H
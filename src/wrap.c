@@ -0,0 +1,339 @@
+#include "wrap.h"
+
+void text_wrap_init(TextWrap *wrap, UIFont *font, int font_size, float spacing)
+{
+    bzero(wrap, sizeof(TextWrap));
+    wrap->font = font;
+    wrap->font_size = font_size;
+    wrap->spacing = spacing;
+    wrap->version = 1;
+    wrap->rows_dirty = true;
+    wrap->font_version = font->widths_version;
+
+    for(int i = 0; i < WRAP_ADVANCE_CACHE_SIZE; i++) wrap->advances[i] = -1;
+}
+
+// rewrapping measures every char of the paragraph, the font lookups of the common
+// chars are skipped
+static float get_advance(TextWrap *wrap, int codepoint)
+{
+    bool cached = codepoint >= 0 && codepoint < WRAP_ADVANCE_CACHE_SIZE;
+    if(cached && wrap->advances[codepoint] >= 0) return wrap->advances[codepoint];
+
+    int glyph = ui_font_glyph_index(wrap->font, codepoint);
+    float advance = ui_font_glyph_advance(wrap->font, glyph, wrap->font_size);
+    if(cached) wrap->advances[codepoint] = advance;
+
+    return advance;
+}
+
+static void free_paragraphs(TextWrap *wrap, size_t from, size_t to)
+{
+    for(size_t i = from; i < to; i++) {
+        WrapRows *rows = &wrap->paragraphs.items[i];
+        if(rows->version != wrap->version) wrap->stale_count--;
+        da_free(rows);
+    }
+}
+
+void text_wrap_free(TextWrap *wrap)
+{
+    free_paragraphs(wrap, 0, wrap->paragraphs.count);
+    da_free(&wrap->paragraphs);
+    da_free(&wrap->counts);
+    da_free(&wrap->blocks);
+    fenwick_free(&wrap->block_rows);
+    fenwick_free(&wrap->block_paragraphs);
+    bzero(wrap, sizeof(TextWrap));
+}
+
+bool text_wrap_set_width(TextWrap *wrap, float width)
+{
+    if(width == wrap->width && wrap->font_version == wrap->font->widths_version) return false;
+
+    // a codepoint that fell back to '?' got its glyph
+    if(wrap->font_version != wrap->font->widths_version) {
+        wrap->font_version = wrap->font->widths_version;
+        for(int i = 0; i < WRAP_ADVANCE_CACHE_SIZE; i++) wrap->advances[i] = -1;
+    }
+
+    // the rows of the old width are kept as the estimate of the new ones
+    wrap->width = width;
+    wrap->version++;
+    wrap->stale_count = wrap->paragraphs.count;
+    return true;
+}
+
+static size_t get_paragraph_rows(TextWrap *wrap, size_t paragraph)
+{
+    return wrap->paragraphs.items[paragraph].count + 1;
+}
+
+// the trees are built again from the blocks in O(blocks)
+static void build_block_trees(TextWrap *wrap)
+{
+    WrapBlocks *blocks = &wrap->blocks;
+    WrapCounts *counts = &wrap->counts;
+    da_reserve(counts, blocks->count);
+
+    for(size_t i = 0; i < blocks->count; i++) counts->items[i] = blocks->items[i].paragraphs;
+    fenwick_build(&wrap->block_paragraphs, counts->items, blocks->count);
+    for(size_t i = 0; i < blocks->count; i++) counts->items[i] = blocks->items[i].rows;
+    fenwick_build(&wrap->block_rows, counts->items, blocks->count);
+}
+
+// blocks of WRAP_BLOCK_SIZE paragraphs, there's always one even when the text is empty
+static void rebuild_rows(TextWrap *wrap)
+{
+    if(!wrap->rows_dirty) return;
+
+    WrapBlocks *blocks = &wrap->blocks;
+    blocks->count = 0;
+    size_t count = wrap->paragraphs.count;
+    for(size_t first = 0; first < count || blocks->count == 0; first += WRAP_BLOCK_SIZE) {
+        WrapBlock block = {0, 0};
+        for(size_t i = first; i < count && i < first + WRAP_BLOCK_SIZE; i++) {
+            block.paragraphs++;
+            block.rows += get_paragraph_rows(wrap, i);
+        }
+        da_append(blocks, block);
+    }
+
+    build_block_trees(wrap);
+    wrap->rows_dirty = false;
+}
+
+// block of "paragraph", "first" gets its first paragraph. The end of the text is
+// in the last block
+static size_t find_block(TextWrap *wrap, size_t paragraph, size_t *first)
+{
+    size_t block = fenwick_search(&wrap->block_paragraphs, paragraph);
+    if(block == wrap->blocks.count) block--;
+    *first = fenwick_prefix(&wrap->block_paragraphs, block);
+    return block;
+}
+
+// negative deltas wrap around, like with fenwick_add
+static void add_to_block(TextWrap *wrap, size_t block, size_t paragraphs, size_t rows)
+{
+    wrap->blocks.items[block].paragraphs += paragraphs;
+    wrap->blocks.items[block].rows += rows;
+    fenwick_add(&wrap->block_paragraphs, block, paragraphs);
+    fenwick_add(&wrap->block_rows, block, rows);
+}
+
+// a block that grew past twice WRAP_BLOCK_SIZE is cut in two halves
+static void split_block(TextWrap *wrap, size_t block, size_t first)
+{
+    WrapBlocks *blocks = &wrap->blocks;
+    WrapBlock *old = &blocks->items[block];
+    if(old->paragraphs <= 2*WRAP_BLOCK_SIZE) return;
+
+    WrapBlock head = {old->paragraphs / 2, 0};
+    for(size_t i = first; i < first + head.paragraphs; i++) head.rows += get_paragraph_rows(wrap, i);
+    WrapBlock tail = {old->paragraphs - head.paragraphs, old->rows - head.rows};
+
+    da_reserve(blocks, blocks->count + 1);
+    memmove(
+        blocks->items + block + 2,
+        blocks->items + block + 1,
+        (blocks->count - block - 1)*sizeof(WrapBlock)
+    );
+    blocks->items[block] = head;
+    blocks->items[block + 1] = tail;
+    blocks->count++;
+    build_block_trees(wrap);
+}
+
+void text_wrap_reset(TextWrap *wrap, size_t count)
+{
+    text_wrap_splice(wrap, 0, wrap->paragraphs.count, count);
+    wrap->stale_cursor = 0;
+}
+
+void text_wrap_splice(TextWrap *wrap, size_t at, size_t removed, size_t inserted)
+{
+    WrapParagraphs *paragraphs = &wrap->paragraphs;
+    assert(at + removed <= paragraphs->count);
+
+    // the paragraphs of a small splice leave their blocks one at a time, before they
+    // are removed. The trees are behind the paragraphs by the ones already removed,
+    // so the next one is always at "at"
+    bool bulk = wrap->rows_dirty || removed + inserted > WRAP_BLOCK_SIZE;
+    for(size_t i = 0; !bulk && i < removed; i++) {
+        size_t first;
+        size_t block = find_block(wrap, at, &first);
+        add_to_block(wrap, block, -1, -get_paragraph_rows(wrap, at + i));
+    }
+
+    free_paragraphs(wrap, at, at + removed);
+
+    da_reserve(paragraphs, paragraphs->count - removed + inserted);
+    memmove(
+        paragraphs->items + at + inserted,
+        paragraphs->items + at + removed,
+        (paragraphs->count - at - removed)*sizeof(WrapRows)
+    );
+    memset(paragraphs->items + at, 0, inserted*sizeof(WrapRows));
+    paragraphs->count = paragraphs->count - removed + inserted;
+
+    wrap->stale_count += inserted;
+    // the blocks of a bulk splice are rebuilt in O(n) the next time they are read
+    if(bulk) {
+        wrap->rows_dirty = true;
+        return;
+    }
+
+    // the new paragraphs have a single row until they are wrapped
+    size_t first;
+    size_t block = find_block(wrap, at, &first);
+    add_to_block(wrap, block, inserted, inserted);
+    split_block(wrap, block, first);
+}
+
+void text_wrap_invalidate(TextWrap *wrap, size_t paragraph)
+{
+    WrapRows *rows = &wrap->paragraphs.items[paragraph];
+    if(rows->version == wrap->version) wrap->stale_count++;
+    rows->version = 0;
+}
+
+bool text_wrap_is_stale(TextWrap *wrap, size_t paragraph)
+{
+    return wrap->paragraphs.items[paragraph].version != wrap->version;
+}
+
+size_t text_wrap_next_stale(TextWrap *wrap)
+{
+    size_t count = wrap->paragraphs.count;
+    if(wrap->stale_count == 0) return count;
+
+    // the search goes around once, the paragraphs before the cursor can be stale
+    // again because of edits
+    for(size_t i = 0; i < count; i++) {
+        if(wrap->stale_cursor >= count) wrap->stale_cursor = 0;
+        if(text_wrap_is_stale(wrap, wrap->stale_cursor)) return wrap->stale_cursor;
+        wrap->stale_cursor++;
+    }
+
+    return count;
+}
+
+void text_wrap_paragraph(TextWrap *wrap, size_t paragraph, const char *text, size_t size)
+{
+    WrapRows *rows = &wrap->paragraphs.items[paragraph];
+    if(rows->version == wrap->version) return;
+
+    size_t old_count = rows->count;
+    rows->count = 0;
+
+    size_t pos = 0;
+    size_t row_start = 0;
+    size_t space_pos = 0; // the row can be broken after the last space
+    float space_x = 0;
+    float x = 0;
+
+    while(pos < size) {
+        int chr_size = 1;
+        int codepoint = (unsigned char)text[pos];
+        if(codepoint >= 0x80) codepoint = utf8_decode(text + pos, size - pos, &chr_size);
+        float advance = get_advance(wrap, codepoint);
+
+        // spaces hang past the end of the row and every row keeps at least a char
+        if(x + advance > wrap->width && pos > row_start && codepoint != ' ') {
+            if(space_pos > row_start) {
+                // the word moves to the next row
+                row_start = space_pos;
+                x -= space_x;
+            } else {
+                // words longer than the row are broken at the char
+                row_start = pos;
+                x = 0;
+            }
+
+            da_append(rows, row_start);
+            continue;
+        }
+
+        x += advance + wrap->spacing;
+        pos += chr_size;
+
+        if(codepoint == ' ') {
+            space_pos = pos;
+            space_x = x;
+        }
+    }
+
+    rows->version = wrap->version;
+    wrap->stale_count--;
+    if(!wrap->rows_dirty) {
+        size_t first;
+        add_to_block(wrap, find_block(wrap, paragraph, &first), 0, rows->count - old_count);
+    }
+}
+
+size_t text_wrap_row_count(TextWrap *wrap)
+{
+    rebuild_rows(wrap);
+    return fenwick_prefix(&wrap->block_rows, wrap->blocks.count);
+}
+
+// the rows of the blocks before it, then the ones of the paragraphs of its block
+size_t text_wrap_first_row(TextWrap *wrap, size_t paragraph)
+{
+    rebuild_rows(wrap);
+
+    size_t first;
+    size_t block = find_block(wrap, paragraph, &first);
+    size_t row = fenwick_prefix(&wrap->block_rows, block);
+    for(size_t i = first; i < paragraph; i++) row += get_paragraph_rows(wrap, i);
+
+    return row;
+}
+
+size_t text_wrap_paragraph_at_row(TextWrap *wrap, size_t row)
+{
+    rebuild_rows(wrap);
+
+    size_t block = fenwick_search(&wrap->block_rows, row);
+    if(block == wrap->blocks.count) return wrap->paragraphs.count - 1;
+
+    row -= fenwick_prefix(&wrap->block_rows, block);
+    size_t paragraph = fenwick_prefix(&wrap->block_paragraphs, block);
+    size_t end = paragraph + wrap->blocks.items[block].paragraphs;
+    for(; paragraph < end - 1; paragraph++) {
+        size_t rows = get_paragraph_rows(wrap, paragraph);
+        if(row < rows) break;
+        row -= rows;
+    }
+
+    return paragraph;
+}
+
+size_t text_wrap_row_at(TextWrap *wrap, size_t paragraph, size_t offset)
+{
+    // number of rows that start at or before "offset" after the first one
+    WrapRows *rows = &wrap->paragraphs.items[paragraph];
+    size_t lo = 0, hi = rows->count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(rows->items[mid] <= offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+void text_wrap_row_span(
+    TextWrap *wrap, size_t paragraph, size_t row, size_t size, size_t *start, size_t *end
+)
+{
+    WrapRows *rows = &wrap->paragraphs.items[paragraph];
+    if(row > rows->count) row = rows->count;
+
+    *start = row == 0 ? 0 : rows->items[row - 1];
+    *end = row < rows->count ? rows->items[row] : size;
+}
@@ -0,0 +1,93 @@
+#ifndef WRAP_H
+#define WRAP_H
+
+#include "cTooling.h"
+#include "font.h"
+
+#define WRAP_ADVANCE_CACHE_SIZE 128 // advances of the ASCII chars are kept by the wrap
+#define WRAP_BLOCK_SIZE 64          // paragraphs of a block when the blocks are rebuilt
+
+// offsets from the start of a paragraph where its rows after the first one start
+typedef struct {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+    unsigned int version; // wrap version the rows were made for, 0 when they are stale
+} WrapRows;
+
+typedef struct {
+    WrapRows *items;
+    size_t count;
+    size_t capacity;
+} WrapParagraphs;
+
+typedef struct {
+    size_t *items;
+    size_t count;
+    size_t capacity;
+} WrapCounts;
+
+// consecutive paragraphs, a splice only changes the blocks it touches. A block
+// is split when it grows past twice WRAP_BLOCK_SIZE paragraphs
+typedef struct {
+    size_t paragraphs;
+    size_t rows;
+} WrapBlock;
+
+typedef struct {
+    WrapBlock *items;
+    size_t count;
+    size_t capacity;
+} WrapBlocks;
+
+// Soft wrap of the paragraphs of a text into rows that fit in "width". The rows of
+// every paragraph are cached and only the stale ones are rewrapped, a stale
+// paragraph keeps its old rows as an estimate until then. A change of the width
+// makes all of them stale, so the caller can rewrap the visible ones first and the
+// rest over the next frames
+typedef struct {
+    WrapParagraphs paragraphs;
+    WrapBlocks blocks;
+    Fenwick block_rows;       // rows of every block
+    Fenwick block_paragraphs; // paragraphs of every block
+    WrapCounts counts;        // scratch used to build the trees of the blocks
+    bool rows_dirty;          // the blocks are rebuilt from the paragraphs, after bulk splices
+    size_t stale_count;
+    size_t stale_cursor; // where the search for the next stale paragraph continues
+    unsigned int version;
+    float width;
+    UIFont *font;
+    int font_size;
+    float spacing;
+    float advances[WRAP_ADVANCE_CACHE_SIZE]; // negative until the char is measured
+    unsigned int font_version; // version of the font the rows were measured with
+} TextWrap;
+
+void text_wrap_init(TextWrap *wrap, UIFont *font, int font_size, float spacing);
+void text_wrap_free(TextWrap *wrap);
+// returns true when the width or the glyphs of the font changed, every paragraph is
+// stale after that
+bool text_wrap_set_width(TextWrap *wrap, float width);
+// the text now has "count" stale paragraphs
+void text_wrap_reset(TextWrap *wrap, size_t count);
+// replaces "removed" paragraphs from "at" with "inserted" stale ones
+void text_wrap_splice(TextWrap *wrap, size_t at, size_t removed, size_t inserted);
+// the text of the paragraph changed
+void text_wrap_invalidate(TextWrap *wrap, size_t paragraph);
+bool text_wrap_is_stale(TextWrap *wrap, size_t paragraph);
+// next stale paragraph, or the paragraph count when there are none
+size_t text_wrap_next_stale(TextWrap *wrap);
+// rewraps the paragraph if it's stale, "text" is its content without the '\n'
+void text_wrap_paragraph(TextWrap *wrap, size_t paragraph, const char *text, size_t size);
+
+size_t text_wrap_row_count(TextWrap *wrap);
+size_t text_wrap_first_row(TextWrap *wrap, size_t paragraph);
+size_t text_wrap_paragraph_at_row(TextWrap *wrap, size_t row);
+// row of the paragraph that contains "offset", a row starts at its first char
+size_t text_wrap_row_at(TextWrap *wrap, size_t paragraph, size_t offset);
+// offsets in the paragraph of "row", "size" is the size of the paragraph
+void text_wrap_row_span(
+    TextWrap *wrap, size_t paragraph, size_t row, size_t size, size_t *start, size_t *end
+);
+
+#endif // WRAP_H
@@ -0,0 +1,172 @@
+// Rasterizes a TTF font into an atlas and writes it as C source with the glyph
+// metrics, the atlas pixels and the codepoint lookup table, so the font can be
+// linked into the executable and loaded with load_ui_font_baked.
+//
+// Usage: bake_font <font.ttf> <size> <output.c> [first-last]...
+// Codepoint ranges can be decimal or hex (0x4E00-0x9FFF), the default is ASCII.
+#include <stdio.h>
+
+#include "raylib.h"
+#include "cTooling.h"
+
+#define BAKE_GLYPH_PADDING 4
+#define VALUES_PER_LINE 16
+
+typedef struct {
+    int *items;
+    size_t count;
+    size_t capacity;
+} Codepoints;
+
+static bool parse_range(const char *arg, int *first, int *last)
+{
+    char *end;
+    *first = strtol(arg, &end, 0);
+    if(*end != '-') return false;
+    *last = strtol(end + 1, &end, 0);
+    return *end == '\0' && *first <= *last;
+}
+
+static void write_int_array(FILE *out, const char *name, const int *items, size_t count)
+{
+    fprintf(out, "static const int %s[] = {", name);
+    for(size_t i = 0; i < count; i++) {
+        if(i % VALUES_PER_LINE == 0) fprintf(out, "\n   ");
+        fprintf(out, " %d,", items[i]);
+    }
+    // arrays can't be empty in C
+    if(count == 0) fprintf(out, " 0");
+    fprintf(out, "\n};\n\n");
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 4) {
+        fprintf(stderr, "Usage: %s <font.ttf> <size> <output.c> [first-last]...\n", argv[0]);
+        return 1;
+    }
+
+    int size = atoi(argv[2]);
+    Codepoints codepoints = {0};
+
+    if(argc == 4) {
+        for(int c = 32; c <= 126; c++) da_append(&codepoints, c);
+    }
+
+    for(int i = 4; i < argc; i++) {
+        int first, last;
+        if(!parse_range(argv[i], &first, &last)) {
+            fprintf(stderr, "Invalid codepoint range: %s\n", argv[i]);
+            return 1;
+        }
+        for(int c = first; c <= last; c++) da_append(&codepoints, c);
+    }
+
+    int file_size;
+    unsigned char *file_data = LoadFileData(argv[1], &file_size);
+    if(file_data == NULL) return 1;
+
+    GlyphInfo *glyphs = LoadFontData(
+        file_data, file_size, size, codepoints.items, codepoints.count, FONT_DEFAULT
+    );
+
+    // codepoints that are not in the font are dropped, '?' is always kept as fallback
+    int count = 0;
+    for(size_t i = 0; i < codepoints.count; i++) {
+        bool missing = glyphs[i].advanceX == 0 && glyphs[i].image.data == NULL;
+        if(missing && glyphs[i].value != '?') {
+            UnloadImage(glyphs[i].image);
+            continue;
+        }
+        glyphs[count++] = glyphs[i];
+    }
+
+    Rectangle *recs;
+    Image atlas = GenImageFontAtlas(glyphs, &recs, count, size, BAKE_GLYPH_PADDING, 0);
+    ImageFormat(&atlas, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+
+    int fallback = 0;
+    int bmp_size = 0;
+    Codepoints astral = {0};
+
+    for(int i = 0; i < count; i++) {
+        int c = glyphs[i].value;
+        if(c == '?') fallback = i;
+        if(c < 0x10000 && c + 1 > bmp_size) bmp_size = c + 1;
+        if(c >= 0x10000) {
+            da_append(&astral, c);
+            da_append(&astral, i);
+        }
+    }
+
+    int *bmp = malloc(bmp_size*sizeof(int));
+    for(int i = 0; i < bmp_size; i++) bmp[i] = fallback;
+    // backwards so the first glyph of a repeated codepoint wins
+    for(int i = count - 1; i >= 0; i--) {
+        if(glyphs[i].value < bmp_size) bmp[glyphs[i].value] = i;
+    }
+
+    FILE *out = fopen(argv[3], "w");
+    if(out == NULL) {
+        fprintf(stderr, "Couldn't open %s\n", argv[3]);
+        return 1;
+    }
+
+    fprintf(out, "// Generated by tools/bake_font.c from %s, do not edit.\n", argv[1]);
+    fprintf(out, "#include \"font.h\"\n\n");
+
+    fprintf(out, "static GlyphInfo glyphs[] = {\n");
+    for(int i = 0; i < count; i++) {
+        fprintf(out, "    {%d, %d, %d, %d, {0}},\n",
+                glyphs[i].value, glyphs[i].offsetX, glyphs[i].offsetY, glyphs[i].advanceX);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "static Rectangle recs[] = {\n");
+    for(int i = 0; i < count; i++) {
+        fprintf(out, "    {%g, %g, %g, %g},\n", recs[i].x, recs[i].y, recs[i].width, recs[i].height);
+    }
+    fprintf(out, "};\n\n");
+
+    size_t pixels_size = atlas.width*atlas.height*2;
+    unsigned char *pixels = atlas.data;
+    fprintf(out, "static const unsigned char pixels[] = {");
+    for(size_t i = 0; i < pixels_size; i++) {
+        if(i % VALUES_PER_LINE == 0) fprintf(out, "\n   ");
+        fprintf(out, " 0x%02x,", pixels[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    write_int_array(out, "bmp", bmp, bmp_size);
+    write_int_array(out, "astral", astral.items, astral.count);
+
+    fprintf(out, "const BakedFont baked_font = {\n");
+    fprintf(out, "    .base_size = %d,\n", size);
+    fprintf(out, "    .glyph_padding = %d,\n", BAKE_GLYPH_PADDING);
+    fprintf(out, "    .glyph_count = %d,\n", count);
+    fprintf(out, "    .glyphs = glyphs,\n");
+    fprintf(out, "    .recs = recs,\n");
+    fprintf(out, "    .atlas_width = %d,\n", atlas.width);
+    fprintf(out, "    .atlas_height = %d,\n", atlas.height);
+    fprintf(out, "    .pixels = pixels,\n");
+    fprintf(out, "    .bmp = bmp,\n");
+    fprintf(out, "    .bmp_size = %d,\n", bmp_size);
+    fprintf(out, "    .astral = astral,\n");
+    fprintf(out, "    .astral_count = %zu,\n", astral.count / 2);
+    fprintf(out, "    .fallback = %d,\n", fallback);
+    fprintf(out, "};\n");
+
+    fclose(out);
+
+    printf("Baked %d glyphs into a %dx%d atlas\n", count, atlas.width, atlas.height);
+
+    free(bmp);
+    da_free(&astral);
+    da_free(&codepoints);
+    UnloadImage(atlas);
+    MemFree(recs);
+    UnloadFontData(glyphs, count);
+    UnloadFileData(file_data);
+
+    return 0;
+}
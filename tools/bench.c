@@ -0,0 +1,608 @@
+// Micro benchmarks for the data structures in cTooling.
+// Build with "./build.sh bench" and run "./build/bench [name]".
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include "autocomplete.h"
+#include "cTooling.h"
+#include "find.h"
+#include "font.h"
+#include "fuzzy.h"
+
+#define LLIST_BENCH_NODES 1000000
+
+static double now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, double start, size_t ops)
+{
+    double elapsed = now() - start;
+    printf("%-40s %10.3f ms %10.2f ns/op\n", name, elapsed * 1e3, elapsed * 1e9 / ops);
+}
+
+// keeps the compiler from removing the loops whose result is not used
+static volatile size_t sink;
+
+typedef struct {
+    size_t value;
+    IListNode node;
+} IntItem;
+
+static void bench_llist()
+{
+    size_t n = LLIST_BENCH_NODES;
+    double start;
+
+    // malloc per node
+    start = now();
+    LList *list = llist_create();
+    for(size_t i = 0; i < n; i++) {
+        llist_append_node(list, llist_create_node(0, (void *)i));
+    }
+    report("llist malloc: append", start, n);
+
+    start = now();
+    size_t sum = 0;
+    for(LNode *node = list->head; node != NULL; node = node->next) sum += (size_t)node->data;
+    sink = sum;
+    report("llist malloc: iterate", start, n);
+
+    // churn: pops the head and appends a new node at the tail
+    start = now();
+    for(size_t i = 0; i < n; i++) {
+        free(llist_remove_after(list, NULL));
+        llist_append_node(list, llist_create_node(0, (void *)i));
+    }
+    report("llist malloc: churn", start, n);
+
+    start = now();
+    sum = 0;
+    for(LNode *node = list->head; node != NULL; node = node->next) sum += (size_t)node->data;
+    sink = sum;
+    report("llist malloc: iterate after churn", start, n);
+    llist_destroy(list);
+
+    // pooled nodes
+    LNodePool pool = {0};
+    start = now();
+    list = llist_create();
+    for(size_t i = 0; i < n; i++) {
+        llist_append_node(list, lnode_pool_alloc(&pool, 0, (void *)i));
+    }
+    report("llist pool: append", start, n);
+
+    start = now();
+    sum = 0;
+    for(LNode *node = list->head; node != NULL; node = node->next) sum += (size_t)node->data;
+    sink = sum;
+    report("llist pool: iterate", start, n);
+
+    start = now();
+    for(size_t i = 0; i < n; i++) {
+        lnode_pool_release(&pool, llist_remove_after(list, NULL));
+        llist_append_node(list, lnode_pool_alloc(&pool, 0, (void *)i));
+    }
+    report("llist pool: churn", start, n);
+
+    start = now();
+    sum = 0;
+    for(LNode *node = list->head; node != NULL; node = node->next) sum += (size_t)node->data;
+    sink = sum;
+    report("llist pool: iterate after churn", start, n);
+    llist_destroy_pooled(list, &pool);
+    lnode_pool_free(&pool);
+
+    // intrusive, the items live in a single array
+    IntItem *items = malloc(n*sizeof(IntItem));
+    IList ilist;
+    ilist_init(&ilist);
+    start = now();
+    for(size_t i = 0; i < n; i++) {
+        items[i].value = i;
+        ilist_push_back(&ilist, &items[i].node);
+    }
+    report("ilist: append", start, n);
+
+    start = now();
+    sum = 0;
+    ilist_foreach(&ilist, it) sum += ilist_entry(it, IntItem, node)->value;
+    sink = sum;
+    report("ilist: iterate", start, n);
+
+    start = now();
+    for(size_t i = 0; i < n; i++) {
+        IListNode *first = ilist_first(&ilist);
+        ilist_remove(&ilist, first);
+        ilist_push_back(&ilist, first);
+    }
+    report("ilist: churn", start, n);
+    free(items);
+}
+
+HASHMAP_DECLARE(BenchMap, uint64_t, uint64_t)
+HASHMAP_DEFINE(BenchMap, uint64_t, uint64_t, hash_u64, hashmap_eq)
+
+static void bench_hashmap_size(size_t n)
+{
+    // small maps are filled several times so the timings are measurable
+    size_t rounds = n < 1000000 ? 1000000 / n : 1;
+    size_t ops = n * rounds;
+    double insert_t = 0, lookup_t = 0, miss_t = 0, delete_t = 0;
+    char name[64];
+
+    for(size_t r = 0; r < rounds; r++) {
+        BenchMap map = {0};
+        double start = now();
+        for(uint64_t i = 0; i < n; i++) BenchMap_put(&map, i * 7919, i);
+        insert_t += now() - start;
+
+        start = now();
+        size_t sum = 0;
+        for(uint64_t i = 0; i < n; i++) sum += *BenchMap_get(&map, i * 7919);
+        lookup_t += now() - start;
+
+        start = now();
+        for(uint64_t i = 0; i < n; i++) sum += BenchMap_get(&map, i * 7919 + 1) != NULL;
+        miss_t += now() - start;
+        sink = sum;
+
+        start = now();
+        for(uint64_t i = 0; i < n; i++) BenchMap_remove(&map, i * 7919);
+        delete_t += now() - start;
+        BenchMap_free(&map);
+    }
+
+    const char *labels[] = {"insert", "lookup", "lookup miss", "delete"};
+    double times[] = {insert_t, lookup_t, miss_t, delete_t};
+    for(size_t i = 0; i < 4; i++) {
+        snprintf(name, sizeof(name), "hashmap %zu: %s", n, labels[i]);
+        printf("%-40s %10.3f ms %10.2f ns/op\n", name, times[i] * 1e3, times[i] * 1e9 / ops);
+    }
+}
+
+static void bench_hashmap()
+{
+    bench_hashmap_size(1000);
+    bench_hashmap_size(1000000);
+    bench_hashmap_size(10000000);
+}
+
+#define RING_BENCH_BYTES (1024ULL*1024*1024)
+#define RING_BENCH_CAPACITY (64*1024)
+
+// pins the calling thread to "cpu", does nothing if the cpu is not available
+static void pin_to_cpu(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+static void *ring_producer(void *arg)
+{
+    RingBuffer *rb = arg;
+    char chunk[256];
+    memset(chunk, 'a', sizeof(chunk));
+
+    pin_to_cpu(1);
+
+    size_t written = 0;
+    while(written < RING_BENCH_BYTES) {
+        size_t n = ring_buffer_write(rb, chunk, sizeof(chunk));
+        // only matters when both threads end up on the same core
+        if(n == 0) sched_yield();
+        written += n;
+    }
+
+    return NULL;
+}
+
+static void bench_ring_buffer()
+{
+    RingBuffer *rb = ring_buffer_create(RING_BENCH_CAPACITY);
+    char dest[4096];
+    pthread_t producer;
+
+    pin_to_cpu(0);
+
+    double start = now();
+    pthread_create(&producer, NULL, ring_producer, rb);
+
+    size_t read = 0;
+    while(read < RING_BENCH_BYTES) {
+        size_t n = ring_buffer_read(rb, dest, sizeof(dest));
+        if(n == 0) sched_yield();
+        read += n;
+    }
+
+    pthread_join(producer, NULL);
+    double elapsed = now() - start;
+
+    printf("%-40s %10.3f ms %10.2f GB/s\n", "ring buffer: 1GB spsc",
+           elapsed * 1e3, RING_BENCH_BYTES / elapsed / 1e9);
+    ring_buffer_destroy(rb);
+}
+
+#define GLYPH_BENCH_GLYPHS 3000
+#define GLYPH_BENCH_LOOKUPS 10000000
+
+static void bench_glyph_lookup()
+{
+    // font with ascii, a few thousand CJK glyphs and some emojis, no texture is
+    // needed to look up glyphs
+    Font font = {0};
+    font.baseSize = 16;
+    font.glyphCount = GLYPH_BENCH_GLYPHS;
+    font.glyphs = calloc(font.glyphCount, sizeof(GlyphInfo));
+    font.recs = calloc(font.glyphCount, sizeof(Rectangle));
+
+    for(int i = 0; i < font.glyphCount; i++) {
+        if(i < 95) font.glyphs[i].value = 32 + i;
+        else if(i < font.glyphCount - 100) font.glyphs[i].value = 0x4E00 + i;
+        else font.glyphs[i].value = 0x1F600 + i;
+    }
+
+    int *codepoints = malloc(GLYPH_BENCH_LOOKUPS*sizeof(int));
+    for(size_t i = 0; i < GLYPH_BENCH_LOOKUPS; i++) {
+        codepoints[i] = font.glyphs[hash_u64(i) % font.glyphCount].value;
+    }
+
+    size_t sum = 0;
+    size_t raylib_lookups = GLYPH_BENCH_LOOKUPS / 100;
+    double start = now();
+    for(size_t i = 0; i < raylib_lookups; i++) sum += GetGlyphIndex(font, codepoints[i]);
+    report("glyph lookup: GetGlyphIndex", start, raylib_lookups);
+
+    start = now();
+    UIFont *ui_font = create_ui_font(font);
+    report("glyph lookup: create_ui_font", start, 1);
+
+    start = now();
+    for(size_t i = 0; i < GLYPH_BENCH_LOOKUPS; i++) sum += ui_font_glyph_index(ui_font, codepoints[i]);
+    report("glyph lookup: ui_font_glyph_index", start, GLYPH_BENCH_LOOKUPS);
+    sink = sum;
+
+    destroy_ui_font(ui_font);
+    free(codepoints);
+    free(font.glyphs);
+    free(font.recs);
+}
+
+#define AUTOCOMPLETE_BENCH_ENTRIES 2000000
+#define AUTOCOMPLETE_BENCH_QUERIES 10000
+#define AUTOCOMPLETE_BENCH_PATH "/tmp/cui_autocomplete_bench.idx"
+
+// types "count" random entries a byte at a time, "incremental" reuses the ranges
+// of the last prefix like the input does. Returns the number of keystrokes
+static size_t type_entries(
+    AutocompleteIndex *index, const char **entries, size_t count, bool incremental
+)
+{
+    Autocomplete ac;
+    autocomplete_init(&ac, index);
+    size_t keystrokes = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        const char *entry = entries[hash_u64(i) % AUTOCOMPLETE_BENCH_ENTRIES];
+        size_t size = strlen(entry);
+
+        for(size_t j = 1; j <= size; j++) {
+            if(!incremental) {
+                autocomplete_free(&ac);
+                autocomplete_init(&ac, index);
+            }
+            autocomplete_update(&ac, entry, j);
+            sink += ac.result_count;
+            keystrokes++;
+        }
+    }
+
+    autocomplete_free(&ac);
+    return keystrokes;
+}
+
+static void bench_autocomplete()
+{
+    // SKUs and host names with random weights
+    size_t n = AUTOCOMPLETE_BENCH_ENTRIES;
+    const char **entries = malloc(n*sizeof(char *));
+    uint32_t *weights = malloc(n*sizeof(uint32_t));
+    size_t raw_size = 0;
+    for(size_t i = 0; i < n; i++) {
+        char buffer[64];
+        uint64_t h = hash_u64(i);
+        char a = 'A' + h % 26;
+        char b = 'A' + h / 26 % 26;
+        if(i % 2 == 0) {
+            snprintf(buffer, sizeof(buffer), "SKU-%07zu-%c%c", i / 2, a, b);
+        } else {
+            snprintf(buffer, sizeof(buffer), "host-%zu.dc%zu.example.com", i / 2, (size_t)(h % 16));
+        }
+        entries[i] = strdup(buffer);
+        weights[i] = h >> 40;
+        raw_size += strlen(buffer);
+    }
+
+    double start = now();
+    AutocompleteIndex *index = autocomplete_index_build(entries, weights, n);
+    report("autocomplete: build 2M", start, n);
+    printf("%-40s %10.2f MB %10.2f B/entry (text %.2f B/entry)\n", "autocomplete: index size",
+        index->block_size / 1e6, (double)index->block_size / n, (double)raw_size / n);
+
+    start = now();
+    size_t keystrokes = type_entries(index, entries, AUTOCOMPLETE_BENCH_QUERIES, true);
+    report("autocomplete: keystroke incremental", start, keystrokes);
+
+    start = now();
+    keystrokes = type_entries(index, entries, AUTOCOMPLETE_BENCH_QUERIES, false);
+    report("autocomplete: keystroke from scratch", start, keystrokes);
+
+    // the mapped index reads the pages on demand
+    autocomplete_index_write(index, AUTOCOMPLETE_BENCH_PATH);
+    start = now();
+    AutocompleteIndex *mapped = autocomplete_index_map(AUTOCOMPLETE_BENCH_PATH);
+    report("autocomplete: map", start, 1);
+
+    start = now();
+    keystrokes = type_entries(mapped, entries, AUTOCOMPLETE_BENCH_QUERIES, true);
+    report("autocomplete: keystroke mapped", start, keystrokes);
+
+    autocomplete_index_free(mapped);
+    autocomplete_index_free(index);
+    remove(AUTOCOMPLETE_BENCH_PATH);
+    for(size_t i = 0; i < n; i++) free((char *)entries[i]);
+    free(entries);
+    free(weights);
+}
+
+#define FUZZY_BENCH_CANDIDATES 5000000
+#define FUZZY_BENCH_POLL_NS 20000 // the UI thread polls the results this often
+
+static const char *fuzzy_queries[] = {
+    "main", "srcrender", "mod42util", "testhash", "docsreadme", "lib7parser", "zzqx",
+};
+
+// polls like the UI thread until the query "generation" is done, the times are
+// measured from "start"
+static void wait_query(
+    FuzzyMatcher *matcher, FuzzySnapshot *snapshot, unsigned int generation,
+    double start, double *first_result, double *done
+)
+{
+    struct timespec wait = {0, FUZZY_BENCH_POLL_NS};
+    *first_result = -1;
+    while(true) {
+        fuzzy_matcher_poll(matcher, snapshot);
+        if(snapshot->generation == generation) {
+            if(*first_result < 0) *first_result = now() - start;
+            if(snapshot->done) break;
+        }
+        nanosleep(&wait, NULL);
+    }
+    *done = now() - start;
+}
+
+static void run_fuzzy_queries(const char **candidates, size_t thread_count)
+{
+    FuzzyMatcher *matcher = fuzzy_matcher_create(candidates, FUZZY_BENCH_CANDIDATES, thread_count);
+    FuzzySnapshot snapshot = {0};
+    size_t query_count = sizeof(fuzzy_queries)/sizeof(fuzzy_queries[0]);
+    char name[64];
+
+    double total = 0, first_total = 0;
+    for(size_t i = 0; i < query_count; i++) {
+        const char *query = fuzzy_queries[i];
+        double start = now(), first_result, done;
+        unsigned int generation = fuzzy_matcher_submit(matcher, query, strlen(query));
+        wait_query(matcher, &snapshot, generation, start, &first_result, &done);
+        total += done;
+        first_total += first_result;
+        sink += snapshot.matched;
+    }
+    snprintf(name, sizeof(name), "fuzzy: %zu threads, query", matcher->thread_count);
+    printf("%-40s %10.2f qps %10.3f ms to first result\n",
+        name, query_count / total, first_total / query_count * 1e3);
+
+    // a query typed a char at a time, every keystroke cancels the last query
+    const char *typed = fuzzy_queries[2];
+    size_t size = strlen(typed);
+    double start = now(), first_result, done;
+    unsigned int generation = 0;
+    for(size_t i = 1; i <= size; i++) {
+        generation = fuzzy_matcher_submit(matcher, typed, i);
+    }
+    wait_query(matcher, &snapshot, generation, start, &first_result, &done);
+    snprintf(name, sizeof(name), "fuzzy: %zu threads, typed %zu chars", matcher->thread_count, size);
+    printf("%-40s %10.3f ms %10.3f ms to first result\n", name, done * 1e3, first_result * 1e3);
+
+    fuzzy_matcher_destroy(matcher);
+    da_free(&snapshot.matches);
+}
+
+static void bench_fuzzy()
+{
+    // paths of a big source tree
+    static const char *dirs[] = {"src", "lib", "test", "docs", "tools", "include"};
+    static const char *names[] = {"main", "render", "util", "parser", "hash", "readme", "config"};
+    static const char *exts[] = {"c", "h", "md", "txt"};
+
+    size_t n = FUZZY_BENCH_CANDIDATES;
+    const char **candidates = malloc(n*sizeof(char *));
+    for(size_t i = 0; i < n; i++) {
+        char buffer[96];
+        uint64_t h = hash_u64(i);
+        snprintf(buffer, sizeof(buffer), "%s/mod%zu/%s_%zu.%s",
+            dirs[h % 6], (size_t)(h >> 8) % 1000, names[(h >> 20) % 7], i, exts[(h >> 28) % 4]);
+        candidates[i] = strdup(buffer);
+    }
+
+    double start = now();
+    FuzzyMatcher *matcher = fuzzy_matcher_create(candidates, n, 1);
+    report("fuzzy: create 5M", start, n);
+    fuzzy_matcher_destroy(matcher);
+
+    run_fuzzy_queries(candidates, 1);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if(cores > 1) run_fuzzy_queries(candidates, 0);
+
+    for(size_t i = 0; i < n; i++) free((char *)candidates[i]);
+    free(candidates);
+}
+
+#define FIND_BENCH_SIZE (100*1024*1024)
+#define FIND_BENCH_EDITS 1000
+
+static const char *find_words[] = {
+    "the", "request", "handler", "returned", "error", "while", "parsing", "config",
+    "worker", "thread", "started", "connection", "closed", "timeout", "retrying", "cache",
+};
+
+// 100MB of log like lines, the query is searched as the find bar does it
+static void bench_find()
+{
+    String text = {0};
+    da_reserve(&text, FIND_BENCH_SIZE + 128);
+    for(size_t i = 0; text.count < FIND_BENCH_SIZE; i++) {
+        uint64_t h = hash_u64(i);
+        char line[128];
+        int size = snprintf(line, sizeof(line), "%zu %s %s %s %s %zu\n", i,
+            find_words[h % 16], find_words[(h >> 8) % 16], find_words[(h >> 16) % 16],
+            find_words[(h >> 24) % 16], (size_t)(h >> 32) % 100000);
+        da_append_many(&text, line, size);
+    }
+    size_t size = text.count;
+    char name[64];
+
+    // a query that is never found measures the raw scan
+    double start = now();
+    sink += (size_t)find_substring(text.items, size, "zzqx", 4);
+    double elapsed = now() - start;
+    printf("%-40s %10.3f ms %10.2f GB/s\n", "find: substring, no match", elapsed * 1e3,
+        size / elapsed / 1e9);
+
+    start = now();
+    sink += (size_t)memmem(text.items, size, "zzqx", 4);
+    elapsed = now() - start;
+    printf("%-40s %10.3f ms %10.2f GB/s\n", "find: memmem, no match", elapsed * 1e3,
+        size / elapsed / 1e9);
+
+    // typed a char at a time like in the find bar, every char searches one budget
+    // of bytes as a frame would and then the search is finished
+    TextFind find = {0};
+    const char *typed = "connection closed";
+    for(size_t i = 1; i <= strlen(typed); i++) {
+        start = now();
+        text_find_set_query(&find, text.items, size, typed, i);
+        text_find_update(&find, text.items, size, TEXT_FIND_BUDGET);
+        double first_frame = now() - start;
+        while(!text_find_update(&find, text.items, size, TEXT_FIND_BUDGET));
+        elapsed = now() - start;
+
+        snprintf(name, sizeof(name), "find: query \"%.*s\"", (int)i, typed);
+        printf("%-40s %10.3f ms %10.3f ms first frame %8zu matches\n",
+            name, elapsed * 1e3, first_frame * 1e3, find.matches.count);
+    }
+
+    // the matches after an edit are shifted, only the bytes around it are searched
+    start = now();
+    for(size_t i = 0; i < FIND_BENCH_EDITS; i++) {
+        size_t pos = hash_u64(i) % size;
+        text.items[pos] = 'c';
+        text_find_edit(&find, text.items, size, pos, 1, 1);
+    }
+    report("find: edit", start, FIND_BENCH_EDITS);
+
+    text_find_free(&find);
+    string_free(&text);
+}
+
+#define REPLACE_BENCH_LINES 1000000
+#define REPLACE_BENCH_NAIVE 100 // replacements made by splicing, 1M would take hours
+
+// 100MB with 1M matches, the replacement is longer than the query so everything
+// after the first match moves
+static void bench_replace()
+{
+    String text = {0};
+    da_reserve(&text, FIND_BENCH_SIZE + 256);
+    size_t line_size = FIND_BENCH_SIZE / REPLACE_BENCH_LINES;
+    char line[256];
+    for(size_t i = 0; i < REPLACE_BENCH_LINES; i++) {
+        int size = snprintf(line, sizeof(line), "%zu %s ERROR %s", i,
+            find_words[hash_u64(i) % 16], find_words[hash_u64(i + 1) % 16]);
+        memset(line + size, '.', line_size - size - 1);
+        line[line_size - 1] = '\n';
+        da_append_many(&text, line, line_size);
+    }
+
+    TextFind find = {0};
+    text_find_set_query(&find, text.items, text.count, "ERROR", 5);
+    string_append_text(&find.replacement, "WARNING");
+
+    // what the widgets did before, a splice per match that moves the whole tail
+    String spliced = {0};
+    da_append_many(&spliced, text.items, text.count);
+    double start = now();
+    const char *at = spliced.items;
+    for(size_t i = 0; i < REPLACE_BENCH_NAIVE; i++) {
+        at = find_substring(at, spliced.items + spliced.count - at, "ERROR", 5);
+        size_t pos = at - spliced.items;
+        string_remove_slice(&spliced, pos, pos + 5);
+        string_insert_text(&spliced, "WARNING", pos);
+        at = spliced.items + pos + 7;
+    }
+    double elapsed = now() - start;
+    printf("%-40s %10.3f ms %10.2f s for 1M\n", "replace: splice 100", elapsed * 1e3,
+        elapsed / REPLACE_BENCH_NAIVE * REPLACE_BENCH_LINES);
+    string_free(&spliced);
+
+    String out = {0};
+    size_t pos = 0;
+    start = now();
+    size_t count = text_find_replace_all(&find, text.items, text.count, &out, &pos);
+    // the time includes searching the whole text
+    report("replace: all in a single pass", start, count);
+    assert(count == REPLACE_BENCH_LINES && "Every line has a match");
+    sink += out.count;
+
+    string_free(&out);
+    text_find_free(&find);
+    string_free(&text);
+}
+
+typedef struct {
+    const char *name;
+    void (*run)();
+} Bench;
+
+static Bench benches[] = {
+    {"llist", bench_llist},
+    {"hashmap", bench_hashmap},
+    {"ring_buffer", bench_ring_buffer},
+    {"glyph_lookup", bench_glyph_lookup},
+    {"autocomplete", bench_autocomplete},
+    {"fuzzy", bench_fuzzy},
+    {"find", bench_find},
+    {"replace", bench_replace},
+};
+
+int main(int argc, char **argv)
+{
+    size_t count = sizeof(benches)/sizeof(benches[0]);
+
+    for(size_t i = 0; i < count; i++) {
+        if(argc > 1 && strcmp(argv[1], benches[i].name) != 0) continue;
+        benches[i].run();
+    }
+
+    return 0;
+}
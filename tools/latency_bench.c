@@ -0,0 +1,716 @@
+// Keystroke to photon latency of the text widgets, measured headless.
+// Build with "./build.sh bench" and run "./build/latency_bench [--csv] [scenario]".
+//
+// Key events are injected through the raylib stub and timestamped at injection,
+// at the first text insertion of the frame (string_insert_chr/string_insert_text
+// are wrapped by the linker), at the first quad submitted and after EndDrawing.
+// The results are JSON, or CSV histograms with --csv, so they can be diffed
+// between commits. Times depend on the machine, compare runs from the same one.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cTooling.h"
+#include "console.h"
+#include "finder.h"
+#include "input.h"
+#include "list.h"
+#include "logview.h"
+#include "raylib_stub.h"
+#include "render.h"
+#include "textarea.h"
+
+#define LATENCY_BENCH_ITERATIONS 1000
+#define LONG_FIELD_CHARS 10000
+#define SELECTION_CHARS 1000
+#define PASTE_CHARS 10000
+#define TEXT_AREA_LINES 1000000
+#define WRAP_DOCUMENT_SIZE (5*1024*1024)
+#define WRAP_PARAGRAPH_SIZE 400
+#define LIST_SMALL_ROWS 100
+#define LIST_LARGE_ROWS 10000000
+#define FINDER_CANDIDATES 1000000
+#define LOG_TAIL_LINES 1000000
+#define LOG_TAIL_PATH "/tmp/cui_log_tail_bench.log"
+#define CONSOLE_FLOOD_CAPACITY 100000
+#define CONSOLE_FLOOD_LINES 1667 // lines written per frame, 100k lines/s at 60 FPS
+#define HIGHLIGHT_DOCUMENT_SIZE (1024*1024)
+#define HISTOGRAM_BUCKETS 24 // bucket i counts samples under 2^i microseconds
+
+typedef enum {
+    STAGE_INSERT,
+    STAGE_SUBMIT,
+    STAGE_PRESENT,
+    STAGE_COUNT,
+} Stage;
+
+static const char *stage_names[STAGE_COUNT] = {"insert", "submit", "present"};
+
+typedef struct {
+    double *items; // microseconds since the injection
+    size_t count;
+    size_t capacity;
+} Samples;
+
+typedef struct {
+    const char *name;
+    Samples stages[STAGE_COUNT];
+} Scenario;
+
+// widget that gets the events of a scenario
+typedef struct {
+    void *widget;
+    void (*handle)(void *widget);
+} BenchWidget;
+
+// time of the first text insertion of the current frame
+static double insert_time;
+
+void __real_string_insert_chr(String *str, char c, size_t pos);
+void __real_string_insert_text(String *str, const char *text, size_t pos);
+
+void __wrap_string_insert_chr(String *str, char c, size_t pos)
+{
+    if(insert_time == 0) insert_time = GetTime();
+    __real_string_insert_chr(str, c, pos);
+}
+
+void __wrap_string_insert_text(String *str, const char *text, size_t pos)
+{
+    if(insert_time == 0) insert_time = GetTime();
+    __real_string_insert_text(str, text, pos);
+}
+
+// injected events
+
+static void type_char(void)
+{
+    stub_push_char('x');
+}
+
+static void press_backspace(void)
+{
+    stub_press_key(KEY_BACKSPACE);
+}
+
+static void press_left(void)
+{
+    stub_press_key(KEY_LEFT);
+}
+
+static void paste(void)
+{
+    stub_hold_key(KEY_LEFT_CONTROL, true);
+    stub_press_key(KEY_V);
+}
+
+static void select_all(void)
+{
+    stub_hold_key(KEY_LEFT_CONTROL, true);
+    stub_press_key(KEY_A);
+}
+
+// runs a frame with the events of "inject", when "scenario" is not NULL the time
+// of every stage is recorded
+static void run_frame(BenchWidget target, void (*inject)(void), Scenario *scenario)
+{
+    insert_time = 0;
+    double injected = GetTime();
+    inject();
+
+    BeginDrawing();
+    render_begin_frame();
+    target.handle(target.widget);
+    render_end_frame(BLACK);
+    double submitted = stub_get_first_draw_time();
+    EndDrawing();
+    double presented = GetTime();
+
+    stub_hold_key(KEY_LEFT_CONTROL, false);
+
+    if(scenario == NULL) return;
+
+    double times[STAGE_COUNT] = {insert_time, submitted, presented};
+    for(int i = 0; i < STAGE_COUNT; i++) {
+        if(times[i] == 0) continue;
+        da_append(&scenario->stages[i], (times[i] - injected)*1e6);
+    }
+}
+
+static void set_clipboard_chars(size_t count)
+{
+    char *text = malloc(count + 1);
+    assert(text != NULL && "No enough ram");
+
+    for(size_t i = 0; i < count; i++) {
+        text[i] = i % 8 == 7 ? ' ' : 'a' + i % 26;
+    }
+    text[count] = '\0';
+
+    stub_set_clipboard(text);
+    free(text);
+}
+
+static void handle_bench_input(void *widget)
+{
+    handle_input(widget);
+}
+
+static void handle_bench_text_area(void *widget)
+{
+    handle_text_area(widget);
+}
+
+static InputProps get_bench_props(UIFont *font, Vector2 size)
+{
+    return (InputProps) {
+        .pos = {340, 60},
+        .size = size,
+        .placeholder = "",
+        .font = font,
+        .font_size = 20,
+        .font_color = WHITE,
+        .padding = {20, 20, 20, 20},
+        .bg_color = DARKGRAY,
+    };
+}
+
+// every scenario starts with a new focused widget
+static BenchWidget create_bench_input(UIFont *font)
+{
+    Input *input = create_input(get_bench_props(font, (Vector2) {600, 60}));
+    input->focused = true;
+    return (BenchWidget) {input, handle_bench_input};
+}
+
+static BenchWidget create_bench_text_area(UIFont *font)
+{
+    TextArea *area = create_text_area(get_bench_props(font, (Vector2) {600, 500}));
+    area->focused = true;
+    return (BenchWidget) {area, handle_bench_text_area};
+}
+
+static void scenario_empty(UIFont *font, Scenario *scenario)
+{
+    BenchWidget target = create_bench_input(font);
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, type_char, scenario);
+        run_frame(target, press_backspace, NULL);
+    }
+}
+
+// types in the middle of the text, so the edit invalidates half of the caches
+static void scenario_long_field(UIFont *font, Scenario *scenario)
+{
+    BenchWidget target = create_bench_input(font);
+    set_clipboard_chars(LONG_FIELD_CHARS);
+    run_frame(target, paste, NULL);
+    for(size_t i = 0; i < LONG_FIELD_CHARS / 2; i++) run_frame(target, press_left, NULL);
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, type_char, scenario);
+        run_frame(target, press_backspace, NULL);
+    }
+}
+
+// the typed char replaces the selected text
+static void scenario_selection(UIFont *font, Scenario *scenario)
+{
+    BenchWidget target = create_bench_input(font);
+    set_clipboard_chars(SELECTION_CHARS);
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, paste, NULL);
+        run_frame(target, select_all, NULL);
+        run_frame(target, type_char, scenario);
+    }
+}
+
+static void scenario_long_paste(UIFont *font, Scenario *scenario)
+{
+    BenchWidget target = create_bench_input(font);
+    set_clipboard_chars(PASTE_CHARS);
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, paste, scenario);
+        run_frame(target, select_all, NULL);
+        run_frame(target, press_backspace, NULL);
+    }
+}
+
+static void press_up(void)
+{
+    stub_press_key(KEY_UP);
+}
+
+static void press_enter(void)
+{
+    stub_press_key(KEY_ENTER);
+}
+
+// types, breaks lines and moves up in the middle of a text area with 1M lines
+static void scenario_text_area(UIFont *font, Scenario *scenario)
+{
+    BenchWidget target = create_bench_text_area(font);
+    TextArea *area = target.widget;
+
+    String text = {0};
+    for(size_t i = 0; i < TEXT_AREA_LINES; i++) {
+        string_append_text(&text, i % 4 == 3 ? "\n" : "the quick brown fox jumps\n");
+    }
+    text_area_set_text(area, text.items, text.count);
+    string_free(&text);
+
+    area->cursor.pos = text_area_line_start(area, TEXT_AREA_LINES / 2);
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, type_char, scenario);
+        run_frame(target, press_enter, scenario);
+        run_frame(target, press_up, NULL);
+    }
+}
+
+// text area with wrapping on and a 5 MB document of long paragraphs
+static BenchWidget create_wrapped_document(UIFont *font)
+{
+    BenchWidget target = create_bench_text_area(font);
+    TextArea *area = target.widget;
+
+    String text = {0};
+    const char *words[] = {"lorem ", "ipsum ", "dolor ", "sit ", "amet ", "consectetur "};
+    while(text.count < WRAP_DOCUMENT_SIZE) {
+        size_t paragraph_start = text.count;
+        for(size_t i = 0; text.count - paragraph_start < WRAP_PARAGRAPH_SIZE; i++) {
+            string_append_text(&text, words[(text.count + i) % 6]);
+        }
+        string_append_text(&text, "\n");
+    }
+    text_area_set_text(area, text.items, text.count);
+    string_free(&text);
+
+    text_area_set_wrap(area, true);
+    area->cursor.pos = text_area_line_start(area, text_area_line_count(area) / 2) + 10;
+
+    return target;
+}
+
+// only the paragraph with the cursor is rewrapped after every char
+static void scenario_wrap_typing(UIFont *font, Scenario *scenario)
+{
+    BenchWidget target = create_wrapped_document(font);
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, type_char, scenario);
+        run_frame(target, press_backspace, NULL);
+    }
+}
+
+static TextArea *resized_area;
+
+static void resize(void)
+{
+    resized_area->size.x = resized_area->size.x == 600 ? 500 : 600;
+}
+
+// every frame changes the width, only the visible rows and a budget of the hidden
+// ones are rewrapped before the next one
+static void scenario_wrap_resize(UIFont *font, Scenario *scenario)
+{
+    BenchWidget target = create_wrapped_document(font);
+    resized_area = target.widget;
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, resize, scenario);
+    }
+}
+
+static size_t get_bench_row_count(void *data)
+{
+    return *(size_t *)data;
+}
+
+static float get_bench_row_height(void *data, size_t row)
+{
+    (void)data;
+    return row % 5 == 0 ? 48 : 28;
+}
+
+static void get_bench_row_text(void *data, size_t row, String *text)
+{
+    (void)data;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "Result %zu", row);
+    string_append_text(text, buffer);
+}
+
+static void handle_bench_list(void *widget)
+{
+    handle_list(widget);
+}
+
+static void scroll_down(void)
+{
+    stub_set_mouse((Vector2) {400, 300});
+    stub_set_mouse_wheel(-1);
+}
+
+static void press_down(void)
+{
+    stub_press_key(KEY_DOWN);
+}
+
+// scrolls with the wheel and moves the selection, the cost of a frame should be
+// the same for any number of rows
+static void run_list_scenario(UIFont *font, Scenario *scenario, size_t *count)
+{
+    List *list = create_list((ListProps) {
+        .pos = {340, 60},
+        .size = {600, 600},
+        .source = {count, get_bench_row_count, get_bench_row_height, get_bench_row_text},
+        .font = font,
+        .font_size = 20,
+        .font_color = WHITE,
+        .padding = {10, 10, 10, 10},
+        .row_height = 28,
+        .bg_color = DARKGRAY,
+        .selection_color = GRAY,
+    });
+    list->focused = true;
+    BenchWidget target = {list, handle_bench_list};
+
+    // the first frame pulls the row count
+    run_frame(target, scroll_down, NULL);
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, i % 2 ? scroll_down : press_down, scenario);
+    }
+}
+
+static void scenario_list_small(UIFont *font, Scenario *scenario)
+{
+    static size_t count = LIST_SMALL_ROWS;
+    run_list_scenario(font, scenario, &count);
+}
+
+static void scenario_list_large(UIFont *font, Scenario *scenario)
+{
+    static size_t count = LIST_LARGE_ROWS;
+    run_list_scenario(font, scenario, &count);
+}
+
+static void handle_bench_finder(void *widget)
+{
+    handle_finder(widget);
+}
+
+// every keystroke cancels the query in flight and starts a new one, the frames
+// only take the results the workers published so far
+static void scenario_finder(UIFont *font, Scenario *scenario)
+{
+    static const char *names[] = {"index", "xml_parser", "render", "box", "util"};
+    const char **candidates = malloc(FINDER_CANDIDATES*sizeof(char *));
+    assert(candidates != NULL && "No enough ram");
+    for(size_t i = 0; i < FINDER_CANDIDATES; i++) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "src/mod%zu/%s_%zu.c", i % 1000, names[i % 5], i);
+        candidates[i] = strdup(buffer);
+    }
+
+    Finder *finder = create_finder((FinderProps) {
+        .pos = {340, 60},
+        .size = {600, 600},
+        .candidates = candidates,
+        .count = FINDER_CANDIDATES,
+        .font = font,
+        .font_size = 20,
+        .font_color = WHITE,
+        .bg_color = DARKGRAY,
+        .selection_color = GRAY,
+    });
+    finder->input->focused = true;
+    BenchWidget target = {finder, handle_bench_finder};
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS / 2; i++) {
+        run_frame(target, type_char, scenario);
+        run_frame(target, press_backspace, NULL);
+    }
+}
+
+static void handle_bench_log_view(void *widget)
+{
+    handle_log_view(widget);
+}
+
+// scrolls a followed log while lines are appended to it, the frames only read the
+// progress of the indexer
+static void scenario_log_tail(UIFont *font, Scenario *scenario)
+{
+    FILE *file = fopen(LOG_TAIL_PATH, "wb");
+    assert(file != NULL && "Couldn't write the log");
+    for(size_t i = 0; i < LOG_TAIL_LINES; i++) {
+        fprintf(file, "2024-01-01T00:00:00Z INFO worker=%zu request %zu handled\n", i % 64, i);
+    }
+    fflush(file);
+
+    LogView *view = create_log_view(get_bench_props(font, (Vector2) {600, 600}), LOG_TAIL_PATH);
+    assert(view != NULL && "Couldn't open the log");
+    view->focused = true;
+    BenchWidget target = {view, handle_bench_log_view};
+
+    // the frames start once the lines that were written are indexed
+    struct timespec wait = {0, 1000000};
+    while(log_view_line_count(view) < LOG_TAIL_LINES) {
+        run_frame(target, scroll_down, NULL);
+        nanosleep(&wait, NULL);
+    }
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        fprintf(file, "2024-01-01T00:00:01Z WARN appended line %zu\n", i);
+        fflush(file);
+        run_frame(target, i % 2 ? scroll_down : press_down, scenario);
+    }
+
+    fclose(file);
+    destroy_log_view(view);
+    remove(LOG_TAIL_PATH);
+}
+
+static void handle_bench_console(void *widget)
+{
+    handle_console(widget);
+}
+
+// every frame drains the lines written since the last one, the ring is full after
+// the first minute of lines so the old slots are reused
+static void scenario_console_flood(UIFont *font, Scenario *scenario)
+{
+    Console *console = create_console(
+        get_bench_props(font, (Vector2) {600, 600}),
+        CONSOLE_FLOOD_CAPACITY
+    );
+    BenchWidget target = {console, handle_bench_console};
+
+    ConsoleWriter writer = { .console = console };
+    char line[128];
+    size_t seq = 0;
+    size_t fill_frames = CONSOLE_FLOOD_CAPACITY / CONSOLE_FLOOD_LINES;
+    for(size_t i = 0; i < fill_frames + LATENCY_BENCH_ITERATIONS; i++) {
+        for(size_t j = 0; j < CONSOLE_FLOOD_LINES; j++, seq++) {
+            int size = snprintf(line, sizeof(line), "[%zu] worker %zu: processed item %zu\n",
+                seq, seq % 8, seq * 7919 % 1000003);
+            console_writer_write(&writer, line, size);
+        }
+        console_writer_flush(&writer);
+
+        // the frames that fill the ring aren't measured
+        run_frame(target, scroll_down, i >= fill_frames ? scenario : NULL);
+    }
+
+    console_writer_free(&writer);
+    destroy_console(console);
+}
+
+static void no_event(void)
+{
+}
+
+// text area with 1 MB of SQL highlighted, the cursor in the middle of it
+static BenchWidget create_highlighted_document(UIFont *font, Lexer *lexer)
+{
+    BenchWidget target = create_bench_text_area(font);
+    TextArea *area = target.widget;
+    text_area_attach_lexer(area, lexer);
+
+    String text = {0};
+    char line[256];
+    for(size_t i = 0; text.count < HIGHLIGHT_DOCUMENT_SIZE; i++) {
+        int size = snprintf(line, sizeof(line),
+            "SELECT id, name, 'item %zu' FROM orders WHERE total > %zu.5 AND name LIKE 'a%%'; "
+            "-- batch %zu\n/* checked */ UPDATE orders SET total = total * 2 WHERE id = %zu;\n",
+            i, i * 7 % 1000, i / 100, i);
+        da_append_many(&text, line, size);
+    }
+    text_area_set_text(area, text.items, text.count);
+    string_free(&text);
+
+    // after the "SELECT " of a line in the middle
+    size_t middle = text_area_line_count(area) / 2;
+    area->cursor.pos = text_area_line_start(area, middle - middle % 2) + 7;
+    // the whole text is lexed before measuring
+    while(!highlighter_is_done(area->highlighter, area->text.count)) {
+        run_frame(target, no_event, NULL);
+    }
+
+    return target;
+}
+
+// a char typed in an identifier only lexes the text up to the next saved state
+static void scenario_highlight_typing(UIFont *font, Scenario *scenario)
+{
+    Lexer *lexer = create_sql_lexer();
+    BenchWidget target = create_highlighted_document(font, lexer);
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS; i++) {
+        run_frame(target, type_char, scenario);
+        run_frame(target, press_backspace, NULL);
+    }
+
+    destroy_lexer(lexer);
+}
+
+static void type_quote(void)
+{
+    stub_push_char('\'');
+}
+
+// worst case, an opened quote swaps the strings and the code of the whole rest of
+// the text, that is lexed a budget of bytes per frame
+static void scenario_highlight_quote(UIFont *font, Scenario *scenario)
+{
+    Lexer *lexer = create_sql_lexer();
+    BenchWidget target = create_highlighted_document(font, lexer);
+    TextArea *area = target.widget;
+
+    for(size_t i = 0; i < LATENCY_BENCH_ITERATIONS / 10; i++) {
+        run_frame(target, type_quote, scenario);
+        while(!highlighter_is_done(area->highlighter, area->text.count)) {
+            run_frame(target, no_event, NULL);
+        }
+        run_frame(target, press_backspace, NULL);
+        while(!highlighter_is_done(area->highlighter, area->text.count)) {
+            run_frame(target, no_event, NULL);
+        }
+    }
+
+    destroy_lexer(lexer);
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return x < y ? -1 : x > y;
+}
+
+// the samples have to be sorted
+static double percentile(Samples *samples, double p)
+{
+    if(samples->count == 0) return 0;
+    return samples->items[(size_t)(p*(samples->count - 1))];
+}
+
+static void fill_histogram(Samples *samples, size_t histogram[HISTOGRAM_BUCKETS])
+{
+    memset(histogram, 0, HISTOGRAM_BUCKETS*sizeof(size_t));
+
+    for(size_t i = 0; i < samples->count; i++) {
+        int bucket = 0;
+        while(bucket < HISTOGRAM_BUCKETS - 1 && samples->items[i] >= (double)(1 << bucket)) bucket++;
+        histogram[bucket]++;
+    }
+}
+
+static void print_json(Scenario *scenarios, size_t count)
+{
+    printf("{\n  \"iterations\": %d,\n  \"scenarios\": [\n", LATENCY_BENCH_ITERATIONS);
+
+    for(size_t i = 0; i < count; i++) {
+        printf("    {\"name\": \"%s\", \"stages\": [\n", scenarios[i].name);
+
+        for(int s = 0; s < STAGE_COUNT; s++) {
+            Samples *samples = &scenarios[i].stages[s];
+            size_t histogram[HISTOGRAM_BUCKETS];
+            fill_histogram(samples, histogram);
+
+            printf("      {\"stage\": \"%s\", \"count\": %zu, \"p50_us\": %.2f, \"p90_us\": %.2f, "
+                "\"p99_us\": %.2f, \"max_us\": %.2f, \"histogram_us\": {",
+                stage_names[s], samples->count, percentile(samples, 0.5), percentile(samples, 0.9),
+                percentile(samples, 0.99), percentile(samples, 1));
+
+            bool first = true;
+            for(int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                if(histogram[b] == 0) continue;
+                printf("%s\"%d\": %zu", first ? "" : ", ", 1 << b, histogram[b]);
+                first = false;
+            }
+
+            printf("}}%s\n", s + 1 < STAGE_COUNT ? "," : "");
+        }
+
+        printf("    ]}%s\n", i + 1 < count ? "," : "");
+    }
+
+    printf("  ]\n}\n");
+}
+
+static void print_csv(Scenario *scenarios, size_t count)
+{
+    printf("scenario,stage,bucket_max_us,count\n");
+
+    for(size_t i = 0; i < count; i++) {
+        for(int s = 0; s < STAGE_COUNT; s++) {
+            size_t histogram[HISTOGRAM_BUCKETS];
+            fill_histogram(&scenarios[i].stages[s], histogram);
+
+            for(int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+                if(histogram[b] == 0) continue;
+                printf("%s,%s,%d,%zu\n", scenarios[i].name, stage_names[s], 1 << b, histogram[b]);
+            }
+        }
+    }
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(UIFont *font, Scenario *scenario);
+} ScenarioEntry;
+
+static ScenarioEntry scenario_entries[] = {
+    {"empty", scenario_empty},
+    {"long_field", scenario_long_field},
+    {"selection", scenario_selection},
+    {"long_paste", scenario_long_paste},
+    {"text_area", scenario_text_area},
+    {"wrap_typing", scenario_wrap_typing},
+    {"wrap_resize", scenario_wrap_resize},
+    {"list_small", scenario_list_small},
+    {"list_large", scenario_list_large},
+    {"finder", scenario_finder},
+    {"log_tail", scenario_log_tail},
+    {"console_flood", scenario_console_flood},
+    {"highlight_typing", scenario_highlight_typing},
+    {"highlight_quote", scenario_highlight_quote},
+};
+
+int main(int argc, char **argv)
+{
+    bool csv = false;
+    const char *only = NULL;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--csv") == 0) csv = true;
+        else only = argv[i];
+    }
+
+    UIFont *ui_font = create_ui_font(stub_load_font());
+
+    size_t entry_count = sizeof(scenario_entries)/sizeof(scenario_entries[0]);
+    Scenario *scenarios = calloc(entry_count, sizeof(Scenario));
+    size_t count = 0;
+
+    for(size_t i = 0; i < entry_count; i++) {
+        if(only != NULL && strcmp(only, scenario_entries[i].name) != 0) continue;
+
+        Scenario *scenario = &scenarios[count++];
+        scenario->name = scenario_entries[i].name;
+        scenario_entries[i].run(ui_font, scenario);
+
+        for(int s = 0; s < STAGE_COUNT; s++) {
+            Samples *samples = &scenario->stages[s];
+            qsort(samples->items, samples->count, sizeof(double), compare_samples);
+        }
+    }
+
+    if(csv) print_csv(scenarios, count);
+    else print_json(scenarios, count);
+
+    return 0;
+}
@@ -0,0 +1,383 @@
+#define _GNU_SOURCE
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "raylib_stub.h"
+#include "rlgl.h"
+
+#define STUB_KEY_COUNT 512
+#define STUB_MOUSE_BUTTON_COUNT 3
+#define STUB_CHAR_QUEUE_SIZE 4096
+
+static struct {
+    bool key_held[STUB_KEY_COUNT];
+    bool key_pressed[STUB_KEY_COUNT];
+    bool button_down[STUB_MOUSE_BUTTON_COUNT];
+    bool button_was_down[STUB_MOUSE_BUTTON_COUNT];
+    int chars[STUB_CHAR_QUEUE_SIZE];
+    size_t char_head;
+    size_t char_count;
+    Vector2 mouse;
+    float wheel;
+    char *clipboard;
+    size_t frame;
+    size_t quads;
+    double first_draw_time;
+    double start_time;
+} stub = {0};
+
+static void unsupported(const char *name)
+{
+    fprintf(stderr, "%s is not supported by the raylib stub\n", name);
+    abort();
+}
+
+static bool is_valid_key(int key)
+{
+    return key >= 0 && key < STUB_KEY_COUNT;
+}
+
+static bool is_valid_button(int button)
+{
+    return button >= 0 && button < STUB_MOUSE_BUTTON_COUNT;
+}
+
+// scripted input
+
+void stub_press_key(int key)
+{
+    if(is_valid_key(key)) stub.key_pressed[key] = true;
+}
+
+void stub_hold_key(int key, bool down)
+{
+    if(is_valid_key(key)) stub.key_held[key] = down;
+}
+
+void stub_push_char(int codepoint)
+{
+    if(stub.char_count == STUB_CHAR_QUEUE_SIZE) return;
+    stub.chars[(stub.char_head + stub.char_count++) % STUB_CHAR_QUEUE_SIZE] = codepoint;
+}
+
+void stub_set_mouse(Vector2 pos)
+{
+    stub.mouse = pos;
+}
+
+void stub_set_mouse_wheel(float move)
+{
+    stub.wheel = move;
+}
+
+void stub_set_mouse_button(int button, bool down)
+{
+    if(is_valid_button(button)) stub.button_down[button] = down;
+}
+
+void stub_set_clipboard(const char *text)
+{
+    free(stub.clipboard);
+    stub.clipboard = strdup(text);
+}
+
+size_t stub_get_frame(void)
+{
+    return stub.frame;
+}
+
+size_t stub_get_quad_count(void)
+{
+    return stub.quads;
+}
+
+double stub_get_first_draw_time(void)
+{
+    return stub.first_draw_time;
+}
+
+// window and timing
+
+double GetTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    double time = ts.tv_sec + ts.tv_nsec / 1e9;
+
+    if(stub.start_time == 0) stub.start_time = time;
+    return time - stub.start_time;
+}
+
+float GetFrameTime(void)
+{
+    return STUB_FRAME_TIME;
+}
+
+int GetScreenWidth(void)
+{
+    return STUB_SCREEN_WIDTH;
+}
+
+int GetScreenHeight(void)
+{
+    return STUB_SCREEN_HEIGHT;
+}
+
+void BeginDrawing(void)
+{
+    stub.quads = 0;
+    stub.first_draw_time = 0;
+}
+
+// the input of the frame is consumed, like raylib's PollInputEvents does
+void EndDrawing(void)
+{
+    memset(stub.key_pressed, 0, sizeof(stub.key_pressed));
+    memcpy(stub.button_was_down, stub.button_down, sizeof(stub.button_down));
+    stub.char_count = 0;
+    stub.wheel = 0;
+    stub.frame++;
+}
+
+// input
+
+bool IsKeyDown(int key)
+{
+    return is_valid_key(key) && (stub.key_held[key] || stub.key_pressed[key]);
+}
+
+bool IsKeyPressed(int key)
+{
+    return is_valid_key(key) && stub.key_pressed[key];
+}
+
+bool IsKeyPressedRepeat(int key)
+{
+    (void)key;
+    return false;
+}
+
+int GetCharPressed(void)
+{
+    if(stub.char_count == 0) return 0;
+
+    int codepoint = stub.chars[stub.char_head];
+    stub.char_head = (stub.char_head + 1) % STUB_CHAR_QUEUE_SIZE;
+    stub.char_count--;
+    return codepoint;
+}
+
+Vector2 GetMousePosition(void)
+{
+    return stub.mouse;
+}
+
+float GetMouseWheelMove(void)
+{
+    return stub.wheel;
+}
+
+bool IsMouseButtonDown(int button)
+{
+    return is_valid_button(button) && stub.button_down[button];
+}
+
+bool IsMouseButtonPressed(int button)
+{
+    return is_valid_button(button) && stub.button_down[button] && !stub.button_was_down[button];
+}
+
+bool IsMouseButtonReleased(int button)
+{
+    return is_valid_button(button) && !stub.button_down[button] && stub.button_was_down[button];
+}
+
+const char *GetClipboardText(void)
+{
+    return stub.clipboard != NULL ? stub.clipboard : "";
+}
+
+void SetClipboardText(const char *text)
+{
+    stub_set_clipboard(text);
+}
+
+// shapes and colors, same results as raylib
+
+bool CheckCollisionRecs(Rectangle rec1, Rectangle rec2)
+{
+    return rec1.x < rec2.x + rec2.width && rec1.x + rec1.width > rec2.x
+        && rec1.y < rec2.y + rec2.height && rec1.y + rec1.height > rec2.y;
+}
+
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec)
+{
+    return point.x >= rec.x && point.x < rec.x + rec.width
+        && point.y >= rec.y && point.y < rec.y + rec.height;
+}
+
+Rectangle GetCollisionRec(Rectangle rec1, Rectangle rec2)
+{
+    float left = rec1.x > rec2.x ? rec1.x : rec2.x;
+    float right = rec1.x + rec1.width < rec2.x + rec2.width ? rec1.x + rec1.width : rec2.x + rec2.width;
+    float top = rec1.y > rec2.y ? rec1.y : rec2.y;
+    float bottom = rec1.y + rec1.height < rec2.y + rec2.height ? rec1.y + rec1.height : rec2.y + rec2.height;
+
+    if(left < right && top < bottom) return (Rectangle) {left, top, right - left, bottom - top};
+    return (Rectangle) {0};
+}
+
+Color ColorAlpha(Color color, float alpha)
+{
+    if(alpha < 0) alpha = 0;
+    if(alpha > 1) alpha = 1;
+    color.a = (unsigned char)(255.0f*alpha);
+    return color;
+}
+
+// drawing, only the quads are counted
+
+static void count_quad(void)
+{
+    if(stub.quads++ == 0) stub.first_draw_time = GetTime();
+}
+
+void DrawTexturePro(Texture2D texture, Rectangle source, Rectangle dest, Vector2 origin, float rotation, Color tint)
+{
+    (void)texture; (void)source; (void)dest; (void)origin; (void)rotation; (void)tint;
+    count_quad();
+}
+
+void DrawTextureRec(Texture2D texture, Rectangle source, Vector2 position, Color tint)
+{
+    (void)texture; (void)source; (void)position; (void)tint;
+    count_quad();
+}
+
+void ClearBackground(Color color) { (void)color; }
+void BeginScissorMode(int x, int y, int width, int height) { (void)x; (void)y; (void)width; (void)height; }
+void EndScissorMode(void) {}
+void BeginShaderMode(Shader shader) { (void)shader; }
+void EndShaderMode(void) {}
+void BeginBlendMode(int mode) { (void)mode; }
+void EndBlendMode(void) {}
+void BeginTextureMode(RenderTexture2D target) { (void)target; }
+void EndTextureMode(void) {}
+void rlSetBlendFactors(int src, int dst, int equation) { (void)src; (void)dst; (void)equation; }
+
+// resources, textures only get an id so the renderer can sort by them
+
+static unsigned int next_texture_id = 1;
+
+Texture2D GetShapesTexture(void)
+{
+    static Texture2D texture = {0};
+    if(texture.id == 0) texture = (Texture2D) {next_texture_id++, 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return texture;
+}
+
+Rectangle GetShapesTextureRectangle(void)
+{
+    return (Rectangle) {0, 0, 1, 1};
+}
+
+Texture2D LoadTextureFromImage(Image image)
+{
+    return (Texture2D) {next_texture_id++, image.width, image.height, 1, image.format};
+}
+
+RenderTexture2D LoadRenderTexture(int width, int height)
+{
+    Texture2D texture = {next_texture_id++, width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    return (RenderTexture2D) {.id = texture.id, .texture = texture};
+}
+
+void UnloadTexture(Texture2D texture) { (void)texture; }
+void UnloadRenderTexture(RenderTexture2D target) { (void)target; }
+void UnloadShader(Shader shader) { (void)shader; }
+void SetTextureFilter(Texture2D texture, int filter) { (void)texture; (void)filter; }
+
+void UpdateTextureRec(Texture2D texture, Rectangle rec, const void *pixels)
+{
+    (void)texture; (void)rec; (void)pixels;
+}
+
+void UnloadImage(Image image)
+{
+    free(image.data);
+}
+
+void UnloadFileData(unsigned char *data)
+{
+    free(data);
+}
+
+void UnloadFontData(GlyphInfo *glyphs, int glyphCount)
+{
+    for(int i = 0; i < glyphCount; i++) free(glyphs[i].image.data);
+    free(glyphs);
+}
+
+Font stub_load_font(void)
+{
+    Font font = {0};
+    font.baseSize = 20;
+    font.glyphCount = 95;
+    font.glyphs = calloc(font.glyphCount, sizeof(GlyphInfo));
+    font.recs = calloc(font.glyphCount, sizeof(Rectangle));
+    font.texture = LoadTextureFromImage((Image) {NULL, 512, 512, 1, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA});
+    assert(font.glyphs != NULL && font.recs != NULL && "No enough ram");
+
+    for(int i = 0; i < font.glyphCount; i++) {
+        font.glyphs[i].value = 32 + i;
+        font.glyphs[i].advanceX = 10;
+        font.recs[i] = (Rectangle) {(i % 32)*12, (i / 32)*22, 10, 20};
+    }
+
+    return font;
+}
+
+// dynamic fonts rasterize with stb_truetype inside raylib, they need the real library
+
+unsigned char *LoadFileData(const char *fileName, int *dataSize)
+{
+    (void)fileName; (void)dataSize;
+    unsupported("LoadFileData");
+    return NULL;
+}
+
+GlyphInfo *LoadFontData(const unsigned char *fileData, int dataSize, int fontSize, int *codepoints, int codepointCount, int type)
+{
+    (void)fileData; (void)dataSize; (void)fontSize; (void)codepoints; (void)codepointCount; (void)type;
+    unsupported("LoadFontData");
+    return NULL;
+}
+
+Image GenImageColor(int width, int height, Color color)
+{
+    (void)width; (void)height; (void)color;
+    unsupported("GenImageColor");
+    return (Image) {0};
+}
+
+void ImageFormat(Image *image, int newFormat)
+{
+    (void)image; (void)newFormat;
+    unsupported("ImageFormat");
+}
+
+void ImageResizeCanvas(Image *image, int newWidth, int newHeight, int offsetX, int offsetY, Color fill)
+{
+    (void)image; (void)newWidth; (void)newHeight; (void)offsetX; (void)offsetY; (void)fill;
+    unsupported("ImageResizeCanvas");
+}
+
+Shader LoadShaderFromMemory(const char *vsCode, const char *fsCode)
+{
+    (void)vsCode; (void)fsCode;
+    unsupported("LoadShaderFromMemory");
+    return (Shader) {0};
+}
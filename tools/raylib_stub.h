@@ -0,0 +1,33 @@
+#ifndef RAYLIB_STUB_H
+#define RAYLIB_STUB_H
+
+// Headless replacement for the part of raylib used by the widgets. Tools link it
+// instead of libraylib.a to drive the widgets with scripted input and no window.
+// Drawing only counts the quads, only the bitmap font path is supported.
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "raylib.h"
+
+#define STUB_SCREEN_WIDTH 1280
+#define STUB_SCREEN_HEIGHT 720
+#define STUB_FRAME_TIME (1.0f/60)
+
+// the scripted input is seen by the frame that follows and cleared by EndDrawing,
+// keys set with stub_hold_key stay down until released
+void stub_press_key(int key);
+void stub_hold_key(int key, bool down);
+void stub_push_char(int codepoint);
+void stub_set_mouse(Vector2 pos);
+void stub_set_mouse_button(int button, bool down);
+void stub_set_mouse_wheel(float move);
+void stub_set_clipboard(const char *text);
+
+// ascii font with fixed advances, the stub can't rasterize
+Font stub_load_font(void);
+
+size_t stub_get_frame(void);
+size_t stub_get_quad_count(void);    // quads drawn in the current frame
+double stub_get_first_draw_time(void); // GetTime of the first quad of the frame, 0 if none
+
+#endif // RAYLIB_STUB_H
@@ -0,0 +1,119 @@
+// Replays an input log recorded with "./build/main --record <file>" with no window,
+// as fast as possible. Build with "./build.sh bench" and run
+// "./build/replay <file> [runs]", it's built with debug info to be profiled.
+//
+// The stub font has fixed advances, so the mouse can land on other chars than it
+// did with the recorded font, the keyboard edits are replayed exactly.
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "input.h"
+#include "input_source.h"
+#include "list.h"
+#include "raylib_stub.h"
+#include "render.h"
+#include "textarea.h"
+
+// same layout as main.c
+static InputProps get_replay_props(UIFont *font, Vector2 pos, Vector2 size)
+{
+    return (InputProps) {
+        .pos = pos,
+        .size = size,
+        .placeholder = "",
+        .font = font,
+        .font_size = 20,
+        .font_color = WHITE,
+        .padding = { 20, 20, 20, 20 },
+        .border_color = WHITE,
+        .bg_color = DARKGRAY,
+    };
+}
+
+// rows of the demo list of main.c
+static size_t get_result_count(void *data)
+{
+    (void)data;
+    return 10000000;
+}
+
+static float get_result_height(void *data, size_t row)
+{
+    (void)data;
+    return row % 5 == 0 ? 48 : 28;
+}
+
+static void get_result_text(void *data, size_t row, String *text)
+{
+    (void)data;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "Result %zu", row);
+    string_append_text(text, buffer);
+}
+
+int main(int argc, char **argv)
+{
+    if(argc < 2) {
+        fprintf(stderr, "Usage: %s <file> [runs]\n", argv[0]);
+        return 1;
+    }
+
+    int runs = argc > 2 ? atoi(argv[2]) : 1;
+    UIFont *font = create_ui_font(stub_load_font());
+
+    for(int run = 0; run < runs; run++) {
+        if(!input_source_replay(argv[1])) {
+            fprintf(stderr, "Couldn't replay %s\n", argv[1]);
+            return 1;
+        }
+
+        Vector2 input_pos = { GetScreenWidth() / 2 - 300, 60 };
+        Input *input = create_input(get_replay_props(font, input_pos, (Vector2) { 600, 60 }));
+        Vector2 text_area_pos = { input_pos.x, input_pos.y + 100 };
+        TextArea *text_area = create_text_area(
+            get_replay_props(font, text_area_pos, (Vector2) { 600, 500 })
+        );
+        text_area_set_wrap(text_area, true);
+        List *list = create_list((ListProps) {
+            .pos = { input_pos.x + 640, input_pos.y },
+            .size = { 260, 600 },
+            .source = { NULL, get_result_count, get_result_height, get_result_text },
+            .font = font,
+            .font_size = 20,
+            .font_color = WHITE,
+            .padding = { 10, 10, 10, 10 },
+            .row_height = 28,
+            .border_color = WHITE,
+            .bg_color = DARKGRAY,
+            .selection_color = GRAY,
+        });
+        size_t frames = 0;
+        double max_frame = 0;
+        double start = GetTime();
+
+        while(input_source_begin_frame()) {
+            double frame_start = GetTime();
+
+            BeginDrawing();
+            render_begin_frame();
+            handle_input(input);
+            handle_text_area(text_area);
+            handle_list(list);
+            render_end_frame(BLACK);
+            input_source_end_frame();
+            EndDrawing();
+
+            double elapsed = GetTime() - frame_start;
+            if(elapsed > max_frame) max_frame = elapsed;
+            frames++;
+        }
+
+        double total = GetTime() - start;
+        printf("run %d: %zu frames, %.3f ms, %.2f us/frame, max %.2f us, %zu + %zu chars\n",
+            run, frames, total*1e3, frames > 0 ? total*1e6/frames : 0, max_frame*1e6,
+            input->text.count, text_area->text.count);
+    }
+
+    input_source_close();
+    return 0;
+}
@@ -0,0 +1,706 @@
+// Regression tests of the widgets, driven headless with the raylib stub.
+// Build and run with "./build.sh test", the exit code is the number of failures.
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "autocomplete.h"
+#include "console.h"
+#include "input.h"
+#include "list.h"
+#include "logview.h"
+#include "raylib_stub.h"
+#include "render.h"
+#include "textarea.h"
+#include "wrap.h"
+
+#define CHECK(cond) check((cond), #cond, __FILE__, __LINE__)
+
+static size_t failures;
+
+static void check(bool passed, const char *cond, const char *file, int line)
+{
+    if(passed) return;
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, cond);
+    failures++;
+}
+
+// widget that gets the scripted input of a test
+typedef struct {
+    void *widget;
+    void (*handle)(void *widget);
+} TestWidget;
+
+static void run_frame(TestWidget target)
+{
+    BeginDrawing();
+    render_begin_frame();
+    target.handle(target.widget);
+    render_end_frame(BLACK);
+    EndDrawing();
+    stub_hold_key(KEY_LEFT_CONTROL, false);
+}
+
+static void type_text(TestWidget target, const char *text)
+{
+    for(size_t i = 0; text[i] != '\0'; i++) stub_push_char(text[i]);
+    run_frame(target);
+}
+
+static void press_key(TestWidget target, int key)
+{
+    stub_press_key(key);
+    run_frame(target);
+}
+
+static void press_ctrl_key(TestWidget target, int key)
+{
+    stub_hold_key(KEY_LEFT_CONTROL, true);
+    press_key(target, key);
+}
+
+static void click(TestWidget target, Vector2 pos)
+{
+    stub_set_mouse(pos);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, true);
+    run_frame(target);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, false);
+    run_frame(target);
+}
+
+static void handle_test_input(void *widget)
+{
+    handle_input(widget);
+}
+
+static void handle_test_text_area(void *widget)
+{
+    handle_text_area(widget);
+}
+
+static void handle_test_console(void *widget)
+{
+    handle_console(widget);
+}
+
+static void handle_test_log_view(void *widget)
+{
+    handle_log_view(widget);
+}
+
+static void handle_test_list(void *widget)
+{
+    handle_list(widget);
+}
+
+static InputProps get_test_props(UIFont *font, Vector2 size)
+{
+    return (InputProps) {
+        .pos = {340, 60},
+        .size = size,
+        .placeholder = "",
+        .font = font,
+        .font_size = 20,
+        .font_color = WHITE,
+        .padding = {20, 20, 20, 20},
+        .bg_color = DARKGRAY,
+    };
+}
+
+static TestWidget create_test_input(UIFont *font)
+{
+    Input *input = create_input(get_test_props(font, (Vector2) {600, 60}));
+    input->focused = true;
+    return (TestWidget) {input, handle_test_input};
+}
+
+static TestWidget create_test_text_area(UIFont *font)
+{
+    TextArea *area = create_text_area(get_test_props(font, (Vector2) {600, 500}));
+    area->focused = true;
+    return (TestWidget) {area, handle_test_text_area};
+}
+
+// a selection that was removed can't come back with Shift+Left at the start or
+// Shift+Right at the end, it would be out of the text
+static void test_input_shift_arrow_at_edges(UIFont *font)
+{
+    TestWidget target = create_test_input(font);
+    Input *input = target.widget;
+    type_text(target, "hello world");
+    press_ctrl_key(target, KEY_A);
+    press_key(target, KEY_BACKSPACE);
+    type_text(target, "ab");
+
+    press_key(target, KEY_LEFT);
+    press_key(target, KEY_LEFT);
+    stub_hold_key(KEY_LEFT_SHIFT, true);
+    press_key(target, KEY_LEFT);
+    stub_hold_key(KEY_LEFT_SHIFT, false);
+    CHECK(input->cursor.is_collapsed);
+    CHECK(input->cursor.pos == 0);
+
+    press_key(target, KEY_RIGHT);
+    press_key(target, KEY_RIGHT);
+    stub_hold_key(KEY_LEFT_SHIFT, true);
+    press_key(target, KEY_RIGHT);
+    stub_hold_key(KEY_LEFT_SHIFT, false);
+    CHECK(input->cursor.is_collapsed);
+    CHECK(input->cursor.pos == 2);
+
+    press_key(target, KEY_BACKSPACE);
+    CHECK(input->text.count == 1 && input->text.items[0] == 'a');
+}
+
+// the bytes of multibyte chars are word chars
+static void test_input_multibyte_words(UIFont *font)
+{
+    TestWidget target = create_test_input(font);
+    Input *input = target.widget;
+    type_text(target, "caf");
+    stub_push_char(0xE9);
+    type_text(target, " x");
+
+    Vector2 first_chr = {input->pos.x + input->padding.left + 5, input->pos.y + input->padding.top + 5};
+    click(target, first_chr);
+    click(target, first_chr);
+    InputSelection word = get_corrected_selection(input->cursor.selection);
+    CHECK(!input->cursor.is_collapsed);
+    CHECK(word.start == 0 && word.end == strlen("caf\u00e9"));
+
+    // removes the whole word, not only the last byte
+    press_key(target, KEY_RIGHT);
+    press_ctrl_key(target, KEY_BACKSPACE);
+    CHECK(input->text.count == 2 && memcmp(input->text.items, " x", 2) == 0);
+}
+
+// a keystroke at the start of a long text measures the chars up to the end of the
+// box, not the rest of the text
+static void test_input_width_index_is_lazy(UIFont *font)
+{
+    TestWidget target = create_test_input(font);
+    Input *input = target.widget;
+    char *text = malloc(20001);
+    assert(text != NULL && "No enough ram");
+    for(size_t i = 0; i < 20000; i++) text[i] = 'a' + i % 26;
+    text[20000] = '\0';
+    stub_set_clipboard(text);
+    free(text);
+    press_ctrl_key(target, KEY_V);
+    CHECK(input->width_index.count == input->text.count + 1);
+
+    // the selection collapses to its start
+    press_ctrl_key(target, KEY_A);
+    press_key(target, KEY_LEFT);
+    type_text(target, "x");
+    CHECK(input->text.count == 20001);
+    CHECK(input->width_index.count < 1000);
+
+    // the chars after the edit keep their x, the cursor goes to the end of the text
+    press_ctrl_key(target, KEY_A);
+    press_key(target, KEY_RIGHT);
+    CHECK(input->width_index.count == input->text.count + 1);
+    CHECK(input->width_index.items[input->text.count] == 20001 * (10 + FONT_SPACING));
+    Vector2 box_right = {input->pos.x + input->size.x - input->padding.right - 1, input->pos.y + 30};
+    click(target, box_right);
+    CHECK(input->cursor.pos == input->text.count);
+}
+
+// a drag selection that auto-scrolls and is released outside keeps the focus, so
+// the selected text can be typed over
+static void test_input_drag_out_keeps_focus(UIFont *font)
+{
+    TestWidget target = create_test_input(font);
+    Input *input = target.widget;
+    for(size_t i = 0; i < 200; i++) stub_push_char('a' + i % 26);
+    run_frame(target);
+    click(target, (Vector2) {GetScreenWidth() - 1, GetScreenHeight() - 1});
+    CHECK(!input->focused);
+
+    // the text is scrolled to its end, the selection goes from the end to the left
+    float scroll = input->scroll;
+    float y = input->pos.y + input->padding.top + 5;
+    stub_set_mouse((Vector2) {input->pos.x + input->size.x - input->padding.right - 5, y});
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, true);
+    run_frame(target);
+    CHECK(input->focused);
+
+    stub_set_mouse((Vector2) {input->pos.x - 100, y});
+    for(int i = 0; i < 30; i++) run_frame(target);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, false);
+    run_frame(target);
+    CHECK(input->focused);
+    CHECK(input->scroll < scroll);
+    CHECK(!input->cursor.is_collapsed);
+
+    InputSelection selection = get_corrected_selection(input->cursor.selection);
+    type_text(target, "z");
+    CHECK(input->text.count == 200 - (selection.end - selection.start) + 1);
+}
+
+// same as Input, the focus is kept when a drag selection is released outside
+static void test_text_area_drag_out_keeps_focus(UIFont *font)
+{
+    TestWidget target = create_test_text_area(font);
+    TextArea *area = target.widget;
+    for(size_t i = 0; i < 100; i++) type_text(target, "line\n");
+
+    // the cursor is on the last line, the selection goes from there to the top
+    float x = area->pos.x + area->padding.left + 5;
+    stub_set_mouse((Vector2) {x, area->pos.y + area->size.y - area->padding.bottom - 5});
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, true);
+    run_frame(target);
+    double scroll = area->scroll.y;
+
+    stub_set_mouse((Vector2) {x, area->pos.y - 100});
+    for(int i = 0; i < 30; i++) run_frame(target);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, false);
+    run_frame(target);
+    CHECK(area->focused);
+    CHECK(area->scroll.y < scroll);
+    CHECK(!area->cursor.is_collapsed);
+}
+
+// the rows of a document of millions of lines are scrolled to the pixel
+static void test_text_area_scroll_precision(UIFont *font)
+{
+    TestWidget target = create_test_text_area(font);
+    TextArea *area = target.widget;
+
+    size_t line_count = 8000000;
+    char *text = malloc(line_count * 2);
+    assert(text != NULL && "No enough ram");
+    for(size_t i = 0; i < line_count; i++) memcpy(text + i*2, "x\n", 2);
+    text_area_set_text(area, text, line_count * 2);
+    free(text);
+
+    double line_height = area->font_size + TEXT_AREA_LINE_SPACING;
+    double box_height = area->size.y - area->padding.top - area->padding.bottom;
+    Vector2 box_bottom = {
+        area->pos.x + area->padding.left + 5,
+        area->pos.y + area->size.y - area->padding.bottom - 5,
+    };
+
+    stub_set_mouse(box_bottom);
+    stub_set_mouse_wheel(-1e7);
+    run_frame(target);
+    stub_set_mouse_wheel(0);
+    size_t rows = text_area_line_count(area);
+    CHECK(area->scroll.y == rows * line_height - box_height);
+
+    click(target, box_bottom);
+    CHECK(text_area_line_at(area, area->cursor.pos) == rows - 1);
+
+    // the cursor goes out of the view and is scrolled back to its bottom
+    stub_set_mouse_wheel(100);
+    run_frame(target);
+    stub_set_mouse_wheel(0);
+    press_key(target, KEY_UP);
+    size_t row = text_area_line_at(area, area->cursor.pos);
+    CHECK(row == rows - 2);
+    CHECK(area->scroll.y == (row + 1) * line_height - box_height);
+}
+
+// log file of "line_count" lines in /tmp, "path" gets its name
+static void write_test_log(char path[32], size_t line_count)
+{
+    strcpy(path, "/tmp/widget_test_XXXXXX");
+    int fd = mkstemp(path);
+    assert(fd >= 0 && "Couldn't create the log");
+    FILE *file = fdopen(fd, "w");
+    for(size_t i = 0; i < line_count; i++) fprintf(file, "log line %zu\n", i);
+    fclose(file);
+}
+
+// runs frames until the indexer went through the whole file
+static void wait_log_indexed(TestWidget target, size_t line_count)
+{
+    LogView *view = target.widget;
+    for(size_t i = 0; i < 10000 && log_view_line_count(view) < line_count; i++) {
+        usleep(1000);
+        run_frame(target);
+    }
+    CHECK(log_view_line_count(view) == line_count);
+}
+
+// same as Input, the focus is kept when a drag selection is released outside so
+// the selection can be copied
+static void test_log_view_drag_out_keeps_focus(UIFont *font)
+{
+    char path[32];
+    write_test_log(path, 1000);
+    LogView *view = create_log_view(get_test_props(font, (Vector2) {600, 500}), path);
+    TestWidget target = {view, handle_test_log_view};
+    wait_log_indexed(target, 1000);
+    CHECK(!view->focused);
+
+    float x = view->pos.x + view->padding.left + 5;
+    stub_set_mouse((Vector2) {x, view->pos.y + view->size.y - view->padding.bottom - 5});
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, true);
+    run_frame(target);
+    CHECK(view->focused);
+    size_t top_line = view->top_line;
+
+    stub_set_mouse((Vector2) {x, view->pos.y - 100});
+    for(int i = 0; i < 30; i++) run_frame(target);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, false);
+    run_frame(target);
+    CHECK(view->focused);
+    CHECK(view->top_line < top_line);
+
+    stub_set_clipboard("");
+    press_ctrl_key(target, KEY_C);
+    CHECK(strlen(GetClipboardText()) > 0);
+
+    destroy_log_view(view);
+    unlink(path);
+}
+
+// a log truncated under the view reads as zeros instead of raising SIGBUS, before
+// and after the view notices it
+static void test_log_view_truncated(UIFont *font)
+{
+    char path[32];
+    size_t line_count = 100000;
+    write_test_log(path, line_count);
+    LogView *view = create_log_view(get_test_props(font, (Vector2) {600, 500}), path);
+    view->focused = true;
+    TestWidget target = {view, handle_test_log_view};
+    wait_log_indexed(target, line_count);
+
+    CHECK(truncate(path, 0) == 0);
+    press_key(target, KEY_HOME);
+    press_ctrl_key(target, KEY_A);
+    press_ctrl_key(target, KEY_C);
+    CHECK(!view->truncated);
+
+    usleep(LOG_VIEW_POLL_INTERVAL * 1e6 * 2);
+    run_frame(target);
+    CHECK(view->truncated);
+    press_key(target, KEY_END);
+
+    destroy_log_view(view);
+    unlink(path);
+}
+
+// writes the index with the uint32 at "offset" of the block replaced by "value",
+// returns it mapped back
+static AutocompleteIndex *map_corrupt_index(AutocompleteIndex *index, size_t offset, uint32_t value)
+{
+    char path[] = "/tmp/widget_test_XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0 && "Couldn't create the index");
+    close(fd);
+
+    uint32_t saved;
+    memcpy(&saved, index->block + offset, sizeof(saved));
+    memcpy(index->block + offset, &value, sizeof(value));
+    CHECK(autocomplete_index_write(index, path));
+    memcpy(index->block + offset, &saved, sizeof(saved));
+
+    AutocompleteIndex *mapped = autocomplete_index_map(path);
+    unlink(path);
+    return mapped;
+}
+
+// an index file whose tables point out of the block isn't mapped
+static void test_autocomplete_corrupt_index(void)
+{
+    const char *entries[] = {"select", "set", "from", "where", "group"};
+    uint32_t weights[] = {5, 4, 3, 2, 1};
+    AutocompleteIndex *index = autocomplete_index_build(entries, weights, 5);
+    size_t offsets = sizeof(AutocompleteHeader);
+    size_t best = offsets + (5 + 1 + 5)*sizeof(uint32_t);
+
+    AutocompleteIndex *mapped = map_corrupt_index(index, offsets, 0);
+    CHECK(mapped != NULL);
+    if(mapped != NULL) autocomplete_index_free(mapped);
+
+    CHECK(map_corrupt_index(index, offsets + 2*sizeof(uint32_t), 1000) == NULL);
+    CHECK(map_corrupt_index(index, offsets + 5*sizeof(uint32_t), 1000) == NULL);
+    CHECK(map_corrupt_index(index, best + 3*sizeof(uint32_t), 5) == NULL);
+
+    autocomplete_index_free(index);
+}
+
+// the focus of the widget changes when the button is pressed, a release outside
+// of it keeps the focus
+static void check_focus_on_press(TestWidget target, bool *focused, Vector2 inside)
+{
+    Vector2 outside = {1, 1};
+    click(target, outside);
+    CHECK(!*focused);
+
+    stub_set_mouse(inside);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, true);
+    run_frame(target);
+    CHECK(*focused);
+    stub_set_mouse(outside);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, false);
+    run_frame(target);
+    CHECK(*focused);
+
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, true);
+    run_frame(target);
+    CHECK(!*focused);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, false);
+    run_frame(target);
+}
+
+static void test_console_focus_on_press(UIFont *font)
+{
+    Console *console = create_console(get_test_props(font, (Vector2) {600, 500}), 64);
+    TestWidget target = {console, handle_test_console};
+    Vector2 inside = {console->pos.x + 20, console->pos.y + 20};
+    check_focus_on_press(target, &console->focused, inside);
+}
+
+// rows of the demo list of main.c
+static size_t get_test_row_count(void *data)
+{
+    (void)data;
+    return 10000000;
+}
+
+static float get_test_row_height(void *data, size_t row)
+{
+    (void)data;
+    return row % 5 == 0 ? 48 : 28;
+}
+
+static void get_test_row_text(void *data, size_t row, String *text)
+{
+    (void)data;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "Result %zu", row);
+    string_append_text(text, buffer);
+}
+
+// runs frames until the scroll reaches its target
+static void settle_list(TestWidget target)
+{
+    List *list = target.widget;
+    for(size_t i = 0; i < 1000 && list->scroll != list->scroll_target; i++) run_frame(target);
+    run_frame(target);
+}
+
+// the selected row is drawn whole inside the box
+static bool is_selected_row_visible(List *list)
+{
+    double y = fenwick_prefix(&list->heights, list->selected) - list->scroll;
+    double height = fenwick_prefix(&list->heights, list->selected + 1) - fenwick_prefix(&list->heights, list->selected);
+    double box_height = list->size.y - list->padding.top - list->padding.bottom;
+    return y >= 0 && y + height <= box_height;
+}
+
+static List *create_test_list(UIFont *font)
+{
+    return create_list((ListProps) {
+        .pos = {340, 60},
+        .size = {260, 600},
+        .source = {NULL, get_test_row_count, get_test_row_height, get_test_row_text},
+        .font = font,
+        .font_size = 20,
+        .font_color = WHITE,
+        .padding = {10, 10, 10, 10},
+        .row_height = 28,
+        .bg_color = DARKGRAY,
+    });
+}
+
+static void test_list_focus_on_press(UIFont *font)
+{
+    List *list = create_test_list(font);
+    TestWidget target = {list, handle_test_list};
+    check_focus_on_press(target, &list->focused, (Vector2) {list->pos.x + 20, list->pos.y + 20});
+}
+
+// the rows at the end of a list of millions are scrolled to the pixel
+static void test_list_scroll_precision(UIFont *font)
+{
+    List *list = create_test_list(font);
+    list->focused = true;
+    TestWidget target = {list, handle_test_list};
+    run_frame(target);
+
+    press_key(target, KEY_END);
+    settle_list(target);
+    CHECK(list->selected == list->count - 1);
+    CHECK(is_selected_row_visible(list));
+
+    for(size_t i = 0; i < 30; i++) press_key(target, KEY_UP);
+    settle_list(target);
+    CHECK(list->selected == list->count - 31);
+    CHECK(is_selected_row_visible(list));
+
+    // the wheel takes the selection out of the view, a key brings it back
+    stub_set_mouse((Vector2) {list->pos.x + 20, list->pos.y + 20});
+    stub_set_mouse_wheel(40);
+    run_frame(target);
+    stub_set_mouse_wheel(0);
+    settle_list(target);
+    CHECK(!is_selected_row_visible(list));
+    press_key(target, KEY_UP);
+    settle_list(target);
+    CHECK(list->selected == list->count - 32);
+    CHECK(is_selected_row_visible(list));
+}
+
+// byte of "text" that a click at "x" from its start lands on, with the fixed
+// advances of the stub font
+static size_t get_expected_click_pos(const char *text, size_t size, float x)
+{
+    float offset = 0;
+    size_t pos = 0;
+    while(pos < size && offset + 10 / 1.5 <= x) {
+        offset += 10 + FONT_SPACING;
+        pos += (unsigned char)text[pos] >= 0x80 ? 2 : 1;
+    }
+    return pos;
+}
+
+// a long line scrolled right is measured from the saved x of the line, they have
+// to give the same positions as measuring it from its start
+static void test_text_area_long_line_x(UIFont *font)
+{
+    TestWidget target = create_test_text_area(font);
+    TextArea *area = target.widget;
+
+    String line = {0};
+    for(size_t i = 0; i < 50000; i++) {
+        if(i % 7 == 0) {
+            string_append_text(&line, "\u00e9");
+        } else {
+            da_append(&line, 'a' + i % 26);
+        }
+    }
+    text_area_set_text(area, line.items, line.count);
+
+    // down on the last row goes to the end of the text
+    press_key(target, KEY_DOWN);
+    CHECK(area->cursor.pos == line.count);
+    CHECK(area->scroll.x > 0);
+
+    float box_x = area->pos.x + area->padding.left;
+    float y = area->pos.y + area->padding.top + 5;
+    for(int i = 0; i < 3; i++) {
+        float x = 100 + i * 37;
+        click(target, (Vector2) {box_x + x, y});
+        CHECK(area->cursor.pos == get_expected_click_pos(line.items, line.count, x + area->scroll.x));
+    }
+
+    // the saved x of the line are cleared by an edit before them, up on the first
+    // row goes to the start of the text
+    press_key(target, KEY_UP);
+    CHECK(area->cursor.pos == 0);
+    stub_push_char(0xE9);
+    run_frame(target);
+    press_key(target, KEY_DOWN);
+    click(target, (Vector2) {box_x + 300, y});
+    size_t pos = get_expected_click_pos(area->text.items, area->text.count, 300 + area->scroll.x);
+    CHECK(area->text.count == line.count + 2);
+    CHECK(area->cursor.pos == pos);
+
+    string_free(&line);
+}
+
+// small splices update the row counts of their blocks, the rows have to match the
+// ones counted over every paragraph
+static void check_wrap_rows(TextWrap *wrap)
+{
+    size_t row = 0;
+    bool matched = true;
+    for(size_t i = 0; i < wrap->paragraphs.count; i++) {
+        matched = matched && text_wrap_first_row(wrap, i) == row;
+        size_t rows = wrap->paragraphs.items[i].count + 1;
+        for(size_t j = 0; j < rows; j++) matched = matched && text_wrap_paragraph_at_row(wrap, row + j) == i;
+        row += rows;
+    }
+    CHECK(matched);
+    CHECK(text_wrap_row_count(wrap) == row);
+}
+
+static void test_wrap_splice_keeps_rows(UIFont *font)
+{
+    TextWrap wrap;
+    text_wrap_init(&wrap, font, 20, FONT_SPACING);
+    text_wrap_set_width(&wrap, 120);
+
+    char text[64];
+    memset(text, 'a', sizeof(text));
+    text_wrap_reset(&wrap, 1000);
+    for(size_t i = 0; i < wrap.paragraphs.count; i++) text_wrap_paragraph(&wrap, i, text, i % 40);
+    check_wrap_rows(&wrap);
+    CHECK(!wrap.rows_dirty);
+
+    // enter splits a paragraph, backspace joins two, a paste inserts a few
+    unsigned seed = 1;
+    for(size_t i = 0; i < 3000; i++) {
+        seed = seed * 1103515245 + 12345;
+        size_t at = (seed >> 8) % (wrap.paragraphs.count - 1);
+        size_t removed = i % 3 == 1 ? 2 : 1;
+        size_t inserted = i % 3 == 1 ? 1 : 1 + i % 5;
+        text_wrap_splice(&wrap, at, removed, inserted);
+        for(size_t j = at; j < at + inserted; j++) text_wrap_paragraph(&wrap, j, text, (seed >> 16) % 60);
+    }
+    CHECK(!wrap.rows_dirty);
+    CHECK(wrap.blocks.count > 1000 / WRAP_BLOCK_SIZE);
+    check_wrap_rows(&wrap);
+
+    text_wrap_free(&wrap);
+}
+
+// frames with no damage don't repaint, they only copy the framebuffer to the screen
+static void test_idle_frames_repaint_nothing(UIFont *font)
+{
+    TestWidget target = create_test_input(font);
+    Input *input = target.widget;
+    type_text(target, "idle");
+    input->focused = false;
+
+    float screen_area = GetScreenWidth() * GetScreenHeight();
+    run_frame(target);
+    CHECK(render_get_damage_area() > 0);
+    run_frame(target);
+    CHECK(render_get_damage_area() == 0);
+    CHECK(render_get_fill_area() == screen_area);
+
+    type_text(target, "x");
+    CHECK(render_get_damage_area() == 0);
+    stub_set_mouse((Vector2) {input->pos.x + 5, input->pos.y + 5});
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, true);
+    run_frame(target);
+    stub_set_mouse_button(MOUSE_BUTTON_LEFT, false);
+    CHECK(input->focused);
+    CHECK(render_get_damage_area() > 0);
+    CHECK(render_get_fill_area() == screen_area + render_get_damage_area());
+    run_frame(target);
+}
+
+int main(void)
+{
+    UIFont *font = create_ui_font(stub_load_font());
+
+    test_input_shift_arrow_at_edges(font);
+    test_input_multibyte_words(font);
+    test_input_width_index_is_lazy(font);
+    test_input_drag_out_keeps_focus(font);
+    test_text_area_drag_out_keeps_focus(font);
+    test_text_area_scroll_precision(font);
+    test_text_area_long_line_x(font);
+    test_wrap_splice_keeps_rows(font);
+    test_list_focus_on_press(font);
+    test_console_focus_on_press(font);
+    test_list_scroll_precision(font);
+    test_log_view_drag_out_keeps_focus(font);
+    test_log_view_truncated(font);
+    test_autocomplete_corrupt_index();
+    test_idle_frames_repaint_nothing(font);
+
+    if(failures > 0) {
+        fprintf(stderr, "%zu checks failed\n", failures);
+    } else {
+        printf("all checks passed\n");
+    }
+    return failures > 0;
+}